@@ -3,6 +3,8 @@
 //-----------------------------------------------------------------------------------------------
 #include "TheGame.hpp" // for now, we've got a huge ass monolithic header
 #include "Graphics.hpp"
+#include "ProfilingSection.hpp"
+#include <algorithm>
 
 
 //-----------------------------------------------------------------------------------------------
@@ -12,6 +14,8 @@ const float g_playerMaxMoveSpeedUnitsPerSecond = 100.f;
 const float g_secondsToDragToStop = 0.1f;
 const float g_fullMeanderMaxDegreesPerSecond = 360.f;
 const double g_numberOfSecondsToFall = 3.0;
+const unsigned int g_maxBoundedRelationshipsToScanDirectly = 16;
+const float g_areaQueryPaddingDistance = 1.f; // keeps the area broadphase conservative against rounding at the circle's edge
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -38,39 +42,74 @@ RelationshipToOtherActor::RelationshipToOtherActor()
 }
 
 
+//-----------------------------------------------------------------------------------------------
+// Returns true if this relationship still does something when the other actor is at or beyond
+//	the outer distance (closeness of zero).  Only relationships for which this returns false are
+//	"bounded", and can safely be skipped for actors outside of their outer distance.
+//
+bool RelationshipToOtherActor::HasEffectBeyondOuterDistance() const
+{
+	if( m_outerDistance < m_innerDistance )
+		return true; // inverted ranges are at full strength far away
+
+	return m_attractionRepulsionAtOuterDistance != Vector2::ZERO
+		|| m_mimicMotionAtOuterDistance != Vector2::ZERO
+		|| m_alphaScaleAtOuterDistance != 1.f
+		|| m_radiusScaleAtOuterDistance != 1.f;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// RelationshipRule
+
+//-----------------------------------------------------------------------------------------------
+RelationshipRule::RelationshipRule()
+	: m_subjectTags( ACTOR_TAGS_ALL )
+	, m_objectTags( ACTOR_TAGS_ALL )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static bool HasLowerStoreIndex( const Actor* first, const Actor* second )
+{
+	return first->GetStoreIndex() < second->GetStoreIndex();
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // Actor
 
 //-----------------------------------------------------------------------------------------------
-Actor::Actor()
-	: m_position( Vector2::ZERO )
-	, m_movementSpeed( 0.f )
-	, m_movementHeadingDegrees( 0.f )
+Actor::Actor( ActorStore& store, unsigned int storeIndex, MemoryArena& arena )
+	: m_velocity( Vector2::ZERO )
 	, m_viewHeadingDegrees( 0.f )
-	, m_isPlayer( false )
+	, m_relationships( RelationshipArray::allocator_type( arena ) )
 	, m_baseColor( DEFAULT_NPC_COLOR )
 	, m_baseAlpha( 1.f )
-	, m_alphaScaleFromRelationships( 1.f )
-	, m_baseRadius( DEFAULT_NPC_RADIUS )
-	, m_radiusScaleFromRelationships( 1.f )
 	, m_meanderFactor( 0.2f )
 	, m_confusionFactor( 0.0f )
-	, m_state( ACTOR_STATE_ACTIVE )
 	, m_timeEnteredState( 0.0 )
 
 	, m_responseIfTouchedByNPC( ACTOR_RESPONSE_NONE )
 	, m_responseIfTouchedByPlayer( ACTOR_RESPONSE_NONE )
 	, m_responseIfWithinRadiusOfNPC( ACTOR_RESPONSE_NONE )
 	, m_responseIfWithinRadiusOfPlayer( ACTOR_RESPONSE_NONE )
+	, m_unboundedRelationshipIndices( RelationshipIndexArray::allocator_type( arena ) )
+	, m_boundedRelationshipIndicesByActor( RelationshipIndexByActorArray::allocator_type( arena ) )
+	, m_largestBoundedRelationshipDistance( 0.f )
+	, m_numRelationshipsIndexed( 0 )
+	, m_store( store )
+	, m_storeIndex( storeIndex )
 {
-	m_timeEnteredState = Clock::GetAbsoluteTimeSeconds();
+	m_timeEnteredState = m_store.GetSimulationTimeSeconds();
 }
 
 
 //-----------------------------------------------------------------------------------------------
 double Actor::GetSecondsInCurrentState() const
 {
-	double timeNow = Clock::GetAbsoluteTimeSeconds();
+	double timeNow = m_store.GetSimulationTimeSeconds();
 	return timeNow - m_timeEnteredState;
 }
 
@@ -86,31 +125,31 @@ float Actor::GetFractionOfSecondsInCurrentState( double benchmarkSeconds ) const
 //-----------------------------------------------------------------------------------------------
 ActorState Actor::ChangeState( ActorState newState )
 {
-	ActorState previousState = m_state;
-	m_state = newState;
-	m_timeEnteredState = Clock::GetAbsoluteTimeSeconds();
+	ActorState previousState = GetState();
+	m_store.m_states[ m_storeIndex ] = newState;
+	m_timeEnteredState = m_store.GetSimulationTimeSeconds();
 	return previousState;
 }
 
 //-----------------------------------------------------------------------------------------------
-void Actor::Update( double deltaSeconds, Scenario& scenario )
+void Actor::Update( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch )
 {
-	if( m_isPlayer )
+	if( IsPlayer() )
 	{
 		// Do nothing; we update the player actor directly
 		return;
 	}
 
-	m_previousPosition = m_position;
-	RunEmotions( deltaSeconds );
+	m_store.m_previousPositions[ m_storeIndex ] = GetPosition();
+	RunEmotions( deltaSeconds, scenario, scratch );
 
-	if( DoesStateRunPhysics( m_state ) )
+	if( DoesStateRunPhysics( GetState() ) )
 	{
-		RunPhysics( deltaSeconds, scenario );
+		RunPhysics( deltaSeconds, scenario, scratch );
 	}
 	else
 	{
-		if( m_state == ACTOR_STATE_FALLING )
+		if( GetState() == ACTOR_STATE_FALLING )
 		{
 			ContinueFalling( deltaSeconds, scenario );
 		}
@@ -121,10 +160,10 @@ void Actor::Update( double deltaSeconds, Scenario& scenario )
 //-----------------------------------------------------------------------------------------------
 void Actor::ContinueFalling( double deltaSeconds, Scenario& scenario )
 {
-	double secondsInState = Clock::GetAbsoluteTimeSeconds() - m_timeEnteredState;
+	double secondsInState = m_store.GetSimulationTimeSeconds() - m_timeEnteredState;
 	float fractionFallen = (float)( secondsInState / g_numberOfSecondsToFall );
 	fractionFallen = ClampFloat( fractionFallen, 0.f, 1.f );
-	m_radiusScaleFromRelationships *= (1.f - fractionFallen);
+	m_store.m_radiusScales[ m_storeIndex ] *= (1.f - fractionFallen);
 	if( fractionFallen >= 1.f )
 	{
 		ChangeState( ACTOR_STATE_DEAD );
@@ -133,16 +172,16 @@ void Actor::ContinueFalling( double deltaSeconds, Scenario& scenario )
 
 
 //-----------------------------------------------------------------------------------------------
-void Actor::UpdateAsPlayer( double deltaSeconds, Scenario& scenario )
+void Actor::UpdateAsPlayer( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch )
 {
-	if( !m_isPlayer )
+	if( !IsPlayer() )
 	{
 		// Do nothing; this is for player-actors only
 		return;
 	}
 
-	m_previousPosition = m_position;
-	if( m_state == ACTOR_STATE_ACTIVE )
+	m_store.m_previousPositions[ m_storeIndex ] = GetPosition();
+	if( GetState() == ACTOR_STATE_ACTIVE )
 	{
 		Vector2 moveIntention = Vector2::ZERO;
 		bool isAccelerating = false;
@@ -168,36 +207,37 @@ void Actor::UpdateAsPlayer( double deltaSeconds, Scenario& scenario )
 		}
 
 		moveIntention.SetLength( deltaSeconds * g_playerAcceleration );
-		Vector2 currentVelocity;
-		currentVelocity.SetLengthAndYawDegrees( m_movementSpeed, m_movementHeadingDegrees );
-		currentVelocity += (deltaSeconds * moveIntention);
-		m_movementSpeed = currentVelocity.CalcLength();
-		m_movementHeadingDegrees = currentVelocity.CalcYawDegrees();
-		if( m_movementSpeed > g_playerMaxMoveSpeedUnitsPerSecond )
+		m_velocity += (deltaSeconds * moveIntention);
+		const float maxSpeed = g_playerMaxMoveSpeedUnitsPerSecond;
+		if( m_velocity.CalcLengthSquared() > maxSpeed * maxSpeed )
 		{
-			currentVelocity.SetLength( g_playerMaxMoveSpeedUnitsPerSecond );
-			m_movementSpeed = currentVelocity.CalcLength();
-			m_movementHeadingDegrees = currentVelocity.CalcYawDegrees();
+			m_velocity.SetLength( maxSpeed );
 		}
 
 		if( moveIntention == Vector2::ZERO )
 		{
+			// Drag slows us down along our current heading, stopping (rather than reversing) at zero
 			float fractionOfDragToStopTime = (float) deltaSeconds / g_secondsToDragToStop;
-			m_movementSpeed -= (fractionOfDragToStopTime * g_playerMaxMoveSpeedUnitsPerSecond);
-			if( m_movementSpeed < 0.f )
+			const float speed = m_velocity.CalcLength();
+			const float draggedSpeed = speed - (fractionOfDragToStopTime * g_playerMaxMoveSpeedUnitsPerSecond);
+			if( draggedSpeed > 0.f )
 			{
-				m_movementSpeed = 0.f;
+				m_velocity *= (draggedSpeed / speed);
+			}
+			else
+			{
+				m_velocity = Vector2::ZERO;
 			}
 		}
 	}
 
-	if( DoesStateRunPhysics( m_state ) )
+	if( DoesStateRunPhysics( GetState() ) )
 	{
-		RunPhysics( deltaSeconds, scenario );
+		RunPhysics( deltaSeconds, scenario, scratch );
 	}
 	else
 	{
-		if( m_state == ACTOR_STATE_FALLING )
+		if( GetState() == ACTOR_STATE_FALLING )
 		{
 			ContinueFalling( deltaSeconds, scenario );
 		}
@@ -221,23 +261,44 @@ bool Actor::DoesStateRunPhysics( ActorState state )
 
 
 //-----------------------------------------------------------------------------------------------
-void Actor::RunPhysics( double deltaSeconds, Scenario& scenario )
+// Only areas overlapping our bounding circle (found through the scenario's area index) can push us
+//	or contain us; any others would be no-ops, so skipping them leaves results unchanged.
+//
+void Actor::RunPhysics( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch )
 {
+	PROFILE_SECTION( "Actor::RunPhysics" );
+
 	// Update the actor's kinematics
-	Vector2 velocity;
-	velocity.SetLengthAndYawDegrees( m_movementSpeed, m_movementHeadingDegrees );
-	Vector2 movement = velocity * (float) deltaSeconds;
-	Vector2 proposedPosition = m_position + movement;
-	m_position = proposedPosition;
+	Vector2 movement = m_velocity * (float) deltaSeconds;
+	Vector2 proposedPosition = GetPosition() + movement;
+	SetPosition( proposedPosition );
 
+	const bool isPlayer = IsPlayer();
 	bool isInsideAtLeastOnePassableArea = false;
-	unsigned int areaIndex;
-	for( areaIndex = 0; areaIndex < scenario.m_areas.size(); ++ areaIndex )
+	const float queryHalfSize = CalcRadius() + g_areaQueryPaddingDistance;
+	AABB2 queryBounds;
+	queryBounds.SetFromPointPadding( GetPosition(), Vector2( queryHalfSize, queryHalfSize ) );
+	std::vector< unsigned int >& areaIndices = scratch.m_areaIndices;
+	scenario.m_areaIndex.FindAreasOverlappingBounds( queryBounds, areaIndices );
+
+	for( unsigned int candidateIndex = 0; candidateIndex < areaIndices.size(); ++ candidateIndex )
 	{
+		const unsigned int areaIndex = areaIndices[ candidateIndex ];
 		Area& area = *scenario.m_areas[ areaIndex ];
-		if( (m_isPlayer && area.m_impassableToPlayer) || ((!m_isPlayer) && area.m_impassableToNPC) )
+		if( (isPlayer && area.m_impassableToPlayer) || ((!isPlayer) && area.m_impassableToNPC) )
 		{
 			scenario.ForceActorOutsideOfArea( *this, area );
+
+			// If we were pushed out of the queried region, re-query for the areas after this one
+			const Vector2 radiusExtents( CalcRadius(), CalcRadius() );
+			if( !queryBounds.IsPointInsideBounds( GetPosition() - radiusExtents ) || !queryBounds.IsPointInsideBounds( GetPosition() + radiusExtents ) )
+			{
+				queryBounds.SetFromPointPadding( GetPosition(), Vector2( queryHalfSize, queryHalfSize ) );
+				scenario.m_areaIndex.FindAreasOverlappingBounds( queryBounds, areaIndices );
+				areaIndices.erase( areaIndices.begin(), std::upper_bound( areaIndices.begin(), areaIndices.end(), areaIndex ) );
+				areaIndices.insert( areaIndices.begin(), areaIndex ); // so the loop resumes just after this area
+				candidateIndex = 0;
+			}
 		}
 
 		if( scenario.IsActorAtAllInsideArea( *this, area ) )
@@ -254,40 +315,130 @@ void Actor::RunPhysics( double deltaSeconds, Scenario& scenario )
 
 
 //-----------------------------------------------------------------------------------------------
-void Actor::Draw( bool isShadowPass ) const
+void Actor::Draw( bool isShadowPass, float interpolationFraction ) const
 {
-	if( m_state == ACTOR_STATE_DEAD )
+	if( GetState() == ACTOR_STATE_DEAD )
 		return;
 
-	if( isShadowPass )
+	CaptureDrawState().Draw( isShadowPass, interpolationFraction );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ActorDrawState Actor::CaptureDrawState() const
+{
+	ActorDrawState drawState;
+	drawState.m_previousPosition = GetPreviousPosition();
+	drawState.m_position = GetPosition();
+	drawState.m_radius = CalcRadius();
+	drawState.m_alpha = CalcAlpha();
+	drawState.m_color = CalcColor();
+	drawState.m_isPlayer = IsPlayer();
+	return drawState;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Splits m_relationships into "unbounded" relationships (always run) and "bounded" ones, which
+//	are sorted by other actor so that a neighborhood query can find them quickly.
+//
+void Actor::RebuildRelationshipIndex()
+{
+	m_unboundedRelationshipIndices.clear();
+	m_boundedRelationshipIndicesByActor.clear();
+	m_largestBoundedRelationshipDistance = 0.f;
+
+	for( unsigned int relationshipIndex = 0; relationshipIndex < m_relationships.size(); ++ relationshipIndex )
 	{
-		const Vector2 actorShadowOffset( 3.f, 3.f );
-		DrawFilledCircle( m_position + actorShadowOffset, 1.2f * CalcRadius(), Rgba::BLACK, 0.1f * CalcAlpha() );
-		DrawFilledCircle( m_position + actorShadowOffset, 1.1f * CalcRadius(), Rgba::BLACK, 0.1f * CalcAlpha() );
-		DrawFilledCircle( m_position + actorShadowOffset, 1.0f * CalcRadius(), Rgba::BLACK, 0.1f * CalcAlpha() );
+		const RelationshipToOtherActor& relationship = m_relationships[ relationshipIndex ];
+		if( !relationship.m_otherActor )
+			continue;
+
+		if( relationship.HasEffectBeyondOuterDistance() )
+		{
+			m_unboundedRelationshipIndices.push_back( relationshipIndex );
+		}
+		else
+		{
+			m_boundedRelationshipIndicesByActor.push_back( std::make_pair( relationship.m_otherActor, relationshipIndex ) );
+			m_largestBoundedRelationshipDistance = MaxFloat( m_largestBoundedRelationshipDistance, relationship.m_outerDistance );
+		}
 	}
-	else
+
+	std::sort( m_boundedRelationshipIndicesByActor.begin(), m_boundedRelationshipIndicesByActor.end() );
+	m_numRelationshipsIndexed = (unsigned int) m_relationships.size();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Actor::RebuildRelationshipIndexIfNeeded()
+{
+	if( m_numRelationshipsIndexed != m_relationships.size() )
 	{
-		DrawFilledOutlinedCircle( m_position, CalcRadius(), CalcColor(), Rgba::BLACK, CalcAlpha() );
+		RebuildRelationshipIndex();
 	}
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Actor::RunEmotions( double deltaSeconds )
+void Actor::RunEmotions( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch )
 {
+	PROFILE_SECTION( "Actor::RunEmotions" );
+
 	// Run relationships
-	m_alphaScaleFromRelationships = 1.f;
-	m_radiusScaleFromRelationships = 1.f;
-	for( unsigned int relationshipIndex = 0; relationshipIndex < m_relationships.size(); ++ relationshipIndex )
+	m_store.m_alphaScales[ m_storeIndex ] = 1.f;
+	m_store.m_radiusScales[ m_storeIndex ] = 1.f;
+	RebuildRelationshipIndexIfNeeded();
+
+	if( m_boundedRelationshipIndicesByActor.size() <= g_maxBoundedRelationshipsToScanDirectly )
 	{
-		RelationshipToOtherActor& relationship = m_relationships[ relationshipIndex ];
-		if( relationship.m_otherActor )
+		// Few enough that a neighborhood query would cost more than it saves; just run them all
+		for( unsigned int relationshipIndex = 0; relationshipIndex < m_relationships.size(); ++ relationshipIndex )
+		{
+			RelationshipToOtherActor& relationship = m_relationships[ relationshipIndex ];
+			if( relationship.m_otherActor )
+			{
+				RunRelationship( relationship, *relationship.m_otherActor, deltaSeconds );
+				++ scratch.m_numRelationshipsRun;
+			}
+		}
+	}
+	else
+	{
+		// Bounded relationships can only matter for actors within (outer distance + both radii) of us
+		std::vector< unsigned int >& relationshipIndices = scratch.m_relationshipIndices;
+		std::vector< Actor* >& nearbyActors = scratch.m_nearbyActors;
+		relationshipIndices.assign( m_unboundedRelationshipIndices.begin(), m_unboundedRelationshipIndices.end() );
+		nearbyActors.clear();
+
+		const ActorSpatialHash& spatialHash = scenario.m_actorSpatialHash;
+		const float queryRadius = m_largestBoundedRelationshipDistance + CalcRadius() + spatialHash.GetLargestActorRadius() + scenario.m_spatialQueryMarginDistance;
+		spatialHash.FindActorsNearPoint( GetPosition(), queryRadius, nearbyActors );
+
+		for( unsigned int nearbyIndex = 0; nearbyIndex < nearbyActors.size(); ++ nearbyIndex )
+		{
+			Actor* nearbyActor = nearbyActors[ nearbyIndex ];
+			RelationshipIndexByActorArray::const_iterator iter;
+			iter = std::lower_bound( m_boundedRelationshipIndicesByActor.begin(), m_boundedRelationshipIndicesByActor.end(), std::make_pair( nearbyActor, 0u ) );
+			for( ; iter != m_boundedRelationshipIndicesByActor.end() && iter->first == nearbyActor; ++ iter )
+			{
+				relationshipIndices.push_back( iter->second );
+			}
+		}
+
+		// Run in the original order, so results match evaluating every relationship
+		std::sort( relationshipIndices.begin(), relationshipIndices.end() );
+		for( unsigned int i = 0; i < relationshipIndices.size(); ++ i )
 		{
+			RelationshipToOtherActor& relationship = m_relationships[ relationshipIndices[ i ] ];
 			RunRelationship( relationship, *relationship.m_otherActor, deltaSeconds );
 		}
+
+		scratch.m_numRelationshipsRun += (double) relationshipIndices.size();
 	}
 
+	RunRelationshipRules( deltaSeconds, scenario, scratch );
+
 	// Meandering
 	if( m_meanderFactor > 0.f )
 	{
@@ -301,12 +452,54 @@ void Actor::RunEmotions( double deltaSeconds )
 
 
 //-----------------------------------------------------------------------------------------------
-void Actor::RunRelationship( RelationshipToOtherActor& relationship, Actor& otherActor, double deltaSeconds )
+// Runs each of the scenario's rules that applies to us against every matching actor, in actor
+//	(store) order, as if each had been pushed onto m_relationships in that order.  Bounded rules
+//	only visit actors found by a neighborhood query; out of range they would have no effect.
+//
+void Actor::RunRelationshipRules( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch )
+{
+	const unsigned int myTags = GetTags();
+	const ActorSpatialHash& spatialHash = scenario.m_actorSpatialHash;
+	std::vector< Actor* >& nearbyActors = scratch.m_nearbyActors;
+
+	for( unsigned int ruleIndex = 0; ruleIndex < scenario.m_relationshipRules.size(); ++ ruleIndex )
+	{
+		const RelationshipRule& rule = scenario.m_relationshipRules[ ruleIndex ];
+		if( !rule.AppliesToSubject( myTags ) )
+			continue;
+
+		const std::vector< Actor* >* candidateActors = &scenario.m_actors.m_actors; // unbounded rules visit the whole store, uncopied
+		if( !rule.m_relationship.HasEffectBeyondOuterDistance() )
+		{
+			const float queryRadius = rule.m_relationship.m_outerDistance + CalcRadius() + spatialHash.GetLargestActorRadius() + scenario.m_spatialQueryMarginDistance;
+			nearbyActors.clear();
+			spatialHash.FindActorsNearPoint( GetPosition(), queryRadius, nearbyActors );
+			std::sort( nearbyActors.begin(), nearbyActors.end(), HasLowerStoreIndex );
+			candidateActors = &nearbyActors;
+		}
+
+		for( unsigned int candidateIndex = 0; candidateIndex < candidateActors->size(); ++ candidateIndex )
+		{
+			Actor* otherActor = (*candidateActors)[ candidateIndex ];
+			if( otherActor != this && rule.AppliesToObject( otherActor->GetTags() ) )
+			{
+				RunRelationship( rule.m_relationship, *otherActor, deltaSeconds );
+				++ scratch.m_numRelationshipsRun;
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Actor::RunRelationship( const RelationshipToOtherActor& relationship, Actor& otherActor, double deltaSeconds )
 {
 	// Compute raw distance and abstract closeness parameter (1 at/less than inner distance, 0 at/greater than outer distance)
-	Vector2 displacementToOther = otherActor.m_position - m_position;
+	Vector2 position = GetPosition();
+	const Vector2& otherPosition = otherActor.GetObservedPosition();
+	Vector2 displacementToOther = otherPosition - position;
 	float distanceToOtherCenterToCenter = displacementToOther.CalcLength();
-	float distanceToOtherEdgeToEdge = distanceToOtherCenterToCenter - (CalcRadius() + otherActor.CalcRadius());
+	float distanceToOtherEdgeToEdge = distanceToOtherCenterToCenter - (CalcRadius() + otherActor.CalcObservedRadius());
 	float closenessFactor = RangeMapFloat( relationship.m_innerDistance, relationship.m_outerDistance, distanceToOtherEdgeToEdge, 1.f, 0.f );
 	closenessFactor = ClampFloat( closenessFactor, 0.f, 1.f );
 
@@ -318,31 +511,32 @@ void Actor::RunRelationship( RelationshipToOtherActor& relationship, Actor& othe
 	float alphaScale		= Interpolate( relationship.m_alphaScaleAtOuterDistance, relationship.m_alphaScaleAtInnerDistance, closenessFactor );
 	float radiusScale		= Interpolate( relationship.m_radiusScaleAtOuterDistance, relationship.m_radiusScaleAtInnerDistance, closenessFactor );
 
-	m_alphaScaleFromRelationships *= alphaScale;
-	m_radiusScaleFromRelationships *= radiusScale;
+	m_store.m_alphaScales[ m_storeIndex ] *= alphaScale;
+	m_store.m_radiusScales[ m_storeIndex ] *= radiusScale;
 
-	Vector2 otherActorDisplacement = otherActor.m_position - otherActor.m_previousPosition;
+	Vector2 otherActorDisplacement = otherPosition - otherActor.GetObservedPreviousPosition();
 	Vector2 mimicDisplacement = otherActorDisplacement;
 	mimicDisplacement.x *= mimic2d.x;
 	mimicDisplacement.y *= mimic2d.y;
-	m_position += mimicDisplacement;
+	position += mimicDisplacement;
 
-	Vector2 distance = (otherActor.m_position - m_position);
-	m_position += Vector2(distance.x*attraction2d.x, distance.y*attraction2d.y)*deltaSeconds;
+	Vector2 distance = (otherPosition - position);
+	position += Vector2(distance.x*attraction2d.x, distance.y*attraction2d.y)*deltaSeconds;
+	SetPosition( position );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 float Actor::CalcRadius() const
 {
-	return m_baseRadius * m_radiusScaleFromRelationships;
+	return m_store.m_baseRadii[ m_storeIndex ] * m_store.m_radiusScales[ m_storeIndex ];
 }
 
 	
 //-----------------------------------------------------------------------------------------------
 float Actor::CalcAlpha() const
 {
-	return m_baseAlpha * m_alphaScaleFromRelationships;
+	return m_baseAlpha * m_store.m_alphaScales[ m_storeIndex ];
 }
 
 
@@ -0,0 +1,141 @@
+//-----------------------------------------------------------------------------------------------
+// ActorSpatialHash.cpp
+//-----------------------------------------------------------------------------------------------
+#include "TheGame.hpp"
+#include "ActorSpatialHash.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+const unsigned int g_minimumSpatialHashBuckets = 16;
+const float g_minimumSpatialHashCellSize = 1.f;
+
+
+//-----------------------------------------------------------------------------------------------
+ActorSpatialHash::ActorSpatialHash()
+	: m_cellSize( g_minimumSpatialHashCellSize )
+	, m_inverseCellSize( 1.f / g_minimumSpatialHashCellSize )
+	, m_largestActorRadius( 0.f )
+	, m_bucketMask( 0 )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Rebuilds the hash from scratch in O(N): one pass to count actors per bucket, a prefix sum,
+//	and one (reverse) pass to scatter actors into place.  Scattering in reverse while decrementing
+//	the bucket's end index leaves each bucket's actors in their original relative order, and leaves
+//	m_bucketStartIndices holding each bucket's start.
+//
+void ActorSpatialHash::Rebuild( const ActorStore& actors, float cellSize )
+{
+	const unsigned int numActors = actors.GetNumActors();
+	m_cellSize = MaxFloat( cellSize, g_minimumSpatialHashCellSize );
+	m_inverseCellSize = 1.f / m_cellSize;
+	m_largestActorRadius = 0.f;
+
+	unsigned int numBuckets = g_minimumSpatialHashBuckets;
+	while( numBuckets < 2 * numActors )
+	{
+		numBuckets <<= 1;
+	}
+
+	m_bucketMask = numBuckets - 1;
+	m_bucketStartIndices.assign( numBuckets + 1, 0 );
+	m_actorBucketIndices.resize( numActors );
+	m_sortedActors.resize( numActors );
+	m_sortedCellXs.resize( numActors );
+	m_sortedCellYs.resize( numActors );
+
+	unsigned int actorIndex;
+	for( actorIndex = 0; actorIndex < numActors; ++ actorIndex )
+	{
+		const Vector2& position = actors.m_positions[ actorIndex ];
+		const int cellX = CalcCellCoordinate( position.x );
+		const int cellY = CalcCellCoordinate( position.y );
+		const unsigned int bucketIndex = CalcBucketIndex( cellX, cellY );
+		m_actorBucketIndices[ actorIndex ] = bucketIndex;
+		++ m_bucketStartIndices[ bucketIndex ];
+
+		const float baseRadius = actors.m_baseRadii[ actorIndex ];
+		const float actorRadius = MaxFloat( baseRadius, baseRadius * actors.m_radiusScales[ actorIndex ] );
+		m_largestActorRadius = MaxFloat( m_largestActorRadius, actorRadius );
+	}
+
+	// Inclusive prefix sum; each entry now holds its bucket's end index
+	for( unsigned int bucketIndex = 1; bucketIndex < numBuckets; ++ bucketIndex )
+	{
+		m_bucketStartIndices[ bucketIndex ] += m_bucketStartIndices[ bucketIndex - 1 ];
+	}
+	m_bucketStartIndices[ numBuckets ] = numActors;
+
+	for( actorIndex = numActors; actorIndex > 0; -- actorIndex )
+	{
+		const Vector2& position = actors.m_positions[ actorIndex - 1 ];
+		const unsigned int bucketIndex = m_actorBucketIndices[ actorIndex - 1 ];
+		const unsigned int sortedIndex = -- m_bucketStartIndices[ bucketIndex ];
+		m_sortedActors[ sortedIndex ] = actors.m_actors[ actorIndex - 1 ];
+		m_sortedCellXs[ sortedIndex ] = CalcCellCoordinate( position.x );
+		m_sortedCellYs[ sortedIndex ] = CalcCellCoordinate( position.y );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ActorSpatialHash::Clear()
+{
+	m_bucketMask = 0;
+	m_largestActorRadius = 0.f;
+	m_bucketStartIndices.clear();
+	m_sortedActors.clear();
+	m_sortedCellXs.clear();
+	m_sortedCellYs.clear();
+	m_actorBucketIndices.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Appends every actor whose center lies in a cell touched by the square of half-size <radius>
+//	around <point>.  This is a broadphase; callers still do their own exact distance tests.
+//
+void ActorSpatialHash::FindActorsNearPoint( const Vector2& point, float radius, OUTPUT std::vector< Actor* >& nearbyActors ) const
+{
+	if( m_bucketStartIndices.empty() )
+		return;
+
+	const int minCellX = CalcCellCoordinate( point.x - radius );
+	const int maxCellX = CalcCellCoordinate( point.x + radius );
+	const int minCellY = CalcCellCoordinate( point.y - radius );
+	const int maxCellY = CalcCellCoordinate( point.y + radius );
+
+	for( int cellY = minCellY; cellY <= maxCellY; ++ cellY )
+	{
+		for( int cellX = minCellX; cellX <= maxCellX; ++ cellX )
+		{
+			const unsigned int bucketIndex = CalcBucketIndex( cellX, cellY );
+			const unsigned int bucketEnd = m_bucketStartIndices[ bucketIndex + 1 ];
+			for( unsigned int sortedIndex = m_bucketStartIndices[ bucketIndex ]; sortedIndex < bucketEnd; ++ sortedIndex )
+			{
+				if( m_sortedCellXs[ sortedIndex ] == cellX && m_sortedCellYs[ sortedIndex ] == cellY )
+				{
+					nearbyActors.push_back( m_sortedActors[ sortedIndex ] );
+				}
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int ActorSpatialHash::CalcCellCoordinate( float worldCoordinate ) const
+{
+	return (int) floor( worldCoordinate * m_inverseCellSize );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+unsigned int ActorSpatialHash::CalcBucketIndex( int cellX, int cellY ) const
+{
+	const unsigned int hash = ((unsigned int) cellX * 73856093u) ^ ((unsigned int) cellY * 19349663u);
+	return hash & m_bucketMask;
+}
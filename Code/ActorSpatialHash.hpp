@@ -0,0 +1,46 @@
+//-----------------------------------------------------------------------------------------------
+// ActorSpatialHash.hpp
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_ActorSpatialHash__
+#define __include_ActorSpatialHash__
+
+#include "Vector2.hpp"
+
+class Actor;
+class ActorStore;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Uniform-grid spatial hash over actor positions, rebuilt once per Scenario::Update.
+//
+// The grid is unbounded; cell coordinates are hashed into a power-of-two bucket table, and the
+//	actors are counting-sorted by bucket so that every bucket's occupants are contiguous.
+//
+class ActorSpatialHash
+{
+public:
+	ActorSpatialHash();
+	void Rebuild( const ActorStore& actors, float cellSize );
+	void Clear();
+	void FindActorsNearPoint( const Vector2& point, float radius, OUTPUT std::vector< Actor* >& nearbyActors ) const;
+	float GetCellSize() const { return m_cellSize; }
+	float GetLargestActorRadius() const { return m_largestActorRadius; }
+
+private:
+	int CalcCellCoordinate( float worldCoordinate ) const;
+	unsigned int CalcBucketIndex( int cellX, int cellY ) const;
+
+private:
+	float m_cellSize;
+	float m_inverseCellSize;
+	float m_largestActorRadius;
+	unsigned int m_bucketMask;
+	std::vector< unsigned int > m_bucketStartIndices; // one extra entry at the end, so bucket B spans [start[B], start[B+1])
+	std::vector< Actor* > m_sortedActors;
+	std::vector< int > m_sortedCellXs; // used to reject actors whose (different) cell collided into the same bucket
+	std::vector< int > m_sortedCellYs;
+	std::vector< unsigned int > m_actorBucketIndices; // scratch, parallel to the incoming actor list
+};
+
+
+#endif // __include_ActorSpatialHash__
@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------------------------------
+// ActorStore.cpp
+//-----------------------------------------------------------------------------------------------
+#include "TheGame.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+ActorStore::ActorStore( const Clock& simulationClock )
+	: m_isObservableStateFrozen( false )
+	, m_simulationClock( simulationClock )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ActorStore::~ActorStore()
+{
+	Clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Appends a new slot (with Actor defaults) to every array, and returns the handle for it.  The
+//	handle itself is placed in <arena>, which must outlive it (see Clear).
+//
+Actor* ActorStore::CreateActor( MemoryArena& arena )
+{
+	const unsigned int storeIndex = GetNumActors();
+	m_positions.push_back( Vector2::ZERO );
+	m_previousPositions.push_back( Vector2::ZERO );
+	m_baseRadii.push_back( DEFAULT_NPC_RADIUS );
+	m_radiusScales.push_back( 1.f );
+	m_alphaScales.push_back( 1.f );
+	m_states.push_back( ACTOR_STATE_ACTIVE );
+	m_isPlayerFlags.push_back( 0 );
+	m_tags.push_back( ACTOR_TAG_NPC );
+
+	Actor* newActor = new( arena.Allocate( sizeof( Actor ) ) ) Actor( *this, storeIndex, arena );
+	m_actors.push_back( newActor );
+	return newActor;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Forgets every actor; their memory (all in the arena given to CreateActor) is reclaimed when that
+//	arena is reset.  The arrays keep their capacity for the next scenario.
+//
+void ActorStore::Clear()
+{
+	m_actors.clear();
+	m_positions.clear();
+	m_previousPositions.clear();
+	m_baseRadii.clear();
+	m_radiusScales.clear();
+	m_alphaScales.clear();
+	m_states.clear();
+	m_isPlayerFlags.clear();
+	m_tags.clear();
+	m_frozenPositions.clear();
+	m_frozenPreviousPositions.clear();
+	m_frozenRadiusScales.clear();
+	m_isObservableStateFrozen = false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ActorStore::FreezeObservableState()
+{
+	m_frozenPositions = m_positions;
+	m_frozenPreviousPositions = m_previousPositions;
+	m_frozenRadiusScales = m_radiusScales;
+	m_isObservableStateFrozen = true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ActorStore::UnfreezeObservableState()
+{
+	m_isObservableStateFrozen = false;
+}
@@ -24,47 +24,17 @@ Area::Area()
 //-----------------------------------------------------------------------------------------------
 void Area::Draw( bool isShadowPass )
 {
-	if( isShadowPass )
-	{
-		if( m_deepShadow )
-		{
-			const Vector2 areaShadowOffset( 10.f, 10.f );
-			AABB2 shadow1Area( m_bounds );
-			AABB2 shadow2Area( m_bounds );
-			AABB2 shadow3Area( m_bounds );
-			shadow1Area.AddPadding( 0.f, 0.f );
-			shadow2Area.AddPadding( 4.f, 4.f );
-			shadow3Area.AddPadding( 8.f, 8.f );
-			shadow1Area.Translate( areaShadowOffset );
-			shadow2Area.Translate( areaShadowOffset );
-			shadow3Area.Translate( areaShadowOffset );
-
-			DrawFilledArea( shadow1Area, Rgba::BLACK, 0.1f * m_alpha );
-			DrawFilledArea( shadow2Area, Rgba::BLACK, 0.1f * m_alpha );
-			DrawFilledArea( shadow3Area, Rgba::BLACK, 0.1f * m_alpha );
-		}
-		else
-		{
-			const Vector2 areaShadowOffset( 3.f, 3.f );
-			AABB2 shadow1Area( m_bounds );
-			AABB2 shadow2Area( m_bounds );
-			AABB2 shadow3Area( m_bounds );
-			shadow1Area.AddPadding( 0.f, 0.f );
-			shadow2Area.AddPadding( 1.f, 1.f );
-			shadow3Area.AddPadding( 2.f, 2.f );
-			shadow1Area.Translate( areaShadowOffset );
-			shadow2Area.Translate( areaShadowOffset );
-			shadow3Area.Translate( areaShadowOffset );
-
-			DrawFilledArea( shadow1Area, Rgba::BLACK, 0.1f * m_alpha );
-			DrawFilledArea( shadow2Area, Rgba::BLACK, 0.1f * m_alpha );
-			DrawFilledArea( shadow3Area, Rgba::BLACK, 0.1f * m_alpha );
-		}
-	}
-	else
-	{
-		DrawFilledArea( m_bounds, m_color, m_alpha );
-	}
+	CaptureDrawState().Draw( isShadowPass );
 }
 
 
+//-----------------------------------------------------------------------------------------------
+AreaDrawState Area::CaptureDrawState() const
+{
+	AreaDrawState drawState;
+	drawState.m_bounds = m_bounds;
+	drawState.m_color = m_color;
+	drawState.m_alpha = m_alpha;
+	drawState.m_deepShadow = m_deepShadow;
+	return drawState;
+}
@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------------------------
+// AreaGridIndex.cpp
+//-----------------------------------------------------------------------------------------------
+#include "TheGame.hpp"
+#include "AreaGridIndex.hpp"
+#include <algorithm>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+const int g_maxAreaGridCellsPerAxis = 256;
+const float g_minimumAreaGridCellSize = 1.f;
+
+
+//-----------------------------------------------------------------------------------------------
+AreaGridIndex::AreaGridIndex()
+	: m_isDirty( true )
+	, m_inverseCellSize( 1.f )
+	, m_numCellsX( 0 )
+	, m_numCellsY( 0 )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Cells are sized so there are roughly as many cells as areas; each area is then listed in every
+//	cell its bounds overlap (two passes: count per cell, prefix sum, then fill).
+//
+void AreaGridIndex::Rebuild( const std::vector< Area* >& areas )
+{
+	Clear();
+	m_isDirty = false;
+	if( areas.empty() )
+		return;
+
+	unsigned int areaIndex;
+	m_gridBounds = areas[ 0 ]->m_bounds;
+	m_areaBounds.resize( areas.size() );
+	for( areaIndex = 0; areaIndex < areas.size(); ++ areaIndex )
+	{
+		m_areaBounds[ areaIndex ] = areas[ areaIndex ]->m_bounds;
+		m_gridBounds.StretchBoundsToIncludeBox( m_areaBounds[ areaIndex ] );
+	}
+
+	const Vector2 gridSize = m_gridBounds.CalcSize();
+	float cellSize = sqrtf( (gridSize.x * gridSize.y) / (float) areas.size() );
+	cellSize = MaxFloat( cellSize, MaxFloat( gridSize.x, gridSize.y ) / (float) g_maxAreaGridCellsPerAxis );
+	cellSize = MaxFloat( cellSize, g_minimumAreaGridCellSize );
+	m_inverseCellSize = 1.f / cellSize;
+	m_numCellsX = 1 + (int)( gridSize.x * m_inverseCellSize );
+	m_numCellsY = 1 + (int)( gridSize.y * m_inverseCellSize );
+
+	const unsigned int numCells = (unsigned int)( m_numCellsX * m_numCellsY );
+	m_cellStartIndices.assign( numCells + 1, 0 );
+
+	// Count, then prefix sum into each cell's end index, then fill in reverse (keeps ascending order)
+	for( areaIndex = 0; areaIndex < m_areaBounds.size(); ++ areaIndex )
+	{
+		const AABB2& bounds = m_areaBounds[ areaIndex ];
+		for( int cellY = CalcCellY( bounds.mins.y ); cellY <= CalcCellY( bounds.maxs.y ); ++ cellY )
+		{
+			for( int cellX = CalcCellX( bounds.mins.x ); cellX <= CalcCellX( bounds.maxs.x ); ++ cellX )
+			{
+				++ m_cellStartIndices[ (cellY * m_numCellsX) + cellX ];
+			}
+		}
+	}
+
+	for( unsigned int cellIndex = 1; cellIndex < numCells; ++ cellIndex )
+	{
+		m_cellStartIndices[ cellIndex ] += m_cellStartIndices[ cellIndex - 1 ];
+	}
+	m_cellStartIndices[ numCells ] = m_cellStartIndices[ numCells - 1 ];
+	m_cellAreaIndices.resize( m_cellStartIndices[ numCells ] );
+
+	for( areaIndex = (unsigned int) m_areaBounds.size(); areaIndex > 0; -- areaIndex )
+	{
+		const AABB2& bounds = m_areaBounds[ areaIndex - 1 ];
+		for( int cellY = CalcCellY( bounds.mins.y ); cellY <= CalcCellY( bounds.maxs.y ); ++ cellY )
+		{
+			for( int cellX = CalcCellX( bounds.mins.x ); cellX <= CalcCellX( bounds.maxs.x ); ++ cellX )
+			{
+				const unsigned int listIndex = -- m_cellStartIndices[ (cellY * m_numCellsX) + cellX ];
+				m_cellAreaIndices[ listIndex ] = areaIndex - 1;
+			}
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AreaGridIndex::Clear()
+{
+	m_isDirty = true;
+	m_numCellsX = 0;
+	m_numCellsY = 0;
+	m_areaBounds.clear();
+	m_cellStartIndices.clear();
+	m_cellAreaIndices.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Replaces the contents of <areaIndices> with the index of every area whose bounds overlap
+//	<queryBounds> (edges touching counts), in ascending order.
+//
+void AreaGridIndex::FindAreasOverlappingBounds( const AABB2& queryBounds, OUTPUT std::vector< unsigned int >& areaIndices ) const
+{
+	areaIndices.clear();
+	if( m_areaBounds.empty() || !m_gridBounds.IsOverlapping( queryBounds ) )
+		return;
+
+	const int minCellX = CalcCellX( queryBounds.mins.x );
+	const int maxCellX = CalcCellX( queryBounds.maxs.x );
+	const int minCellY = CalcCellY( queryBounds.mins.y );
+	const int maxCellY = CalcCellY( queryBounds.maxs.y );
+	for( int cellY = minCellY; cellY <= maxCellY; ++ cellY )
+	{
+		for( int cellX = minCellX; cellX <= maxCellX; ++ cellX )
+		{
+			const unsigned int cellIndex = (cellY * m_numCellsX) + cellX;
+			const unsigned int cellEnd = m_cellStartIndices[ cellIndex + 1 ];
+			for( unsigned int listIndex = m_cellStartIndices[ cellIndex ]; listIndex < cellEnd; ++ listIndex )
+			{
+				const unsigned int areaIndex = m_cellAreaIndices[ listIndex ];
+				if( m_areaBounds[ areaIndex ].IsOverlapping( queryBounds ) )
+				{
+					areaIndices.push_back( areaIndex );
+				}
+			}
+		}
+	}
+
+	// Areas spanning several of the queried cells were found once per cell
+	if( minCellX != maxCellX || minCellY != maxCellY )
+	{
+		std::sort( areaIndices.begin(), areaIndices.end() );
+		areaIndices.erase( std::unique( areaIndices.begin(), areaIndices.end() ), areaIndices.end() );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int AreaGridIndex::CalcCellX( float worldX ) const
+{
+	const int cellX = (int) floor( (worldX - m_gridBounds.mins.x) * m_inverseCellSize );
+	return ClampInt( cellX, 0, m_numCellsX - 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int AreaGridIndex::CalcCellY( float worldY ) const
+{
+	const int cellY = (int) floor( (worldY - m_gridBounds.mins.y) * m_inverseCellSize );
+	return ClampInt( cellY, 0, m_numCellsY - 1 );
+}
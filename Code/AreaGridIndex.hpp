@@ -0,0 +1,45 @@
+//-----------------------------------------------------------------------------------------------
+// AreaGridIndex.hpp
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_AreaGridIndex__
+#define __include_AreaGridIndex__
+
+#include "AABB2.hpp"
+
+class Area;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Static uniform-grid index over a scenario's Area bounds, for finding the (few) areas an actor
+//	can possibly touch.  Built in Scenario::Start, and rebuilt only when the areas change.
+//
+// The grid covers the union of all area bounds; each cell lists (in ascending order) the indices
+//	of the areas overlapping it, packed contiguously as in ActorSpatialHash.
+//
+class AreaGridIndex
+{
+public:
+	AreaGridIndex();
+	void Rebuild( const std::vector< Area* >& areas );
+	void Clear();
+	void MarkDirty() { m_isDirty = true; }
+	bool IsUpToDate( const std::vector< Area* >& areas ) const { return !m_isDirty && m_areaBounds.size() == areas.size(); }
+	void FindAreasOverlappingBounds( const AABB2& queryBounds, OUTPUT std::vector< unsigned int >& areaIndices ) const;
+
+private:
+	int CalcCellX( float worldX ) const;
+	int CalcCellY( float worldY ) const;
+
+private:
+	bool m_isDirty;
+	AABB2 m_gridBounds;
+	float m_inverseCellSize;
+	int m_numCellsX;
+	int m_numCellsY;
+	std::vector< AABB2 > m_areaBounds; // copied from the areas at build time, parallel to Scenario::m_areas
+	std::vector< unsigned int > m_cellStartIndices; // one extra entry at the end, so cell C spans [start[C], start[C+1])
+	std::vector< unsigned int > m_cellAreaIndices;
+};
+
+
+#endif // __include_AreaGridIndex__
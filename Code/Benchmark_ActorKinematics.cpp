@@ -0,0 +1,133 @@
+//-----------------------------------------------------------------------------------------------
+// Benchmark_ActorKinematics.cpp
+//
+// Microbenchmark for the actor integration step: the old polar form (speed + heading, rebuilt
+//	into a velocity with cos/sin every step, and converted back with sqrt/atan2 after player
+//	acceleration) against the Cartesian m_velocity the actors now keep.
+//
+// Usage: PH2011_KinematicsBenchmark [-actors N] [-steps N]
+//-----------------------------------------------------------------------------------------------
+#include "Vector2.hpp"
+#include "Clock.hpp"
+#include <stdio.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const int DEFAULT_BENCHMARK_ACTORS = 10000;
+const int DEFAULT_BENCHMARK_STEPS = 1000;
+const float BENCHMARK_DELTA_SECONDS = 1.f / 60.f;
+const float BENCHMARK_MAX_SPEED = 100.f;
+
+
+//-----------------------------------------------------------------------------------------------
+// One step of the pre-change kinematics: NPCs and players alike rebuilt their velocity from
+//	polar form, and accelerating actors converted the result back.
+//
+static void StepPolarKinematics( std::vector< Vector2 >& positions, std::vector< float >& speeds, std::vector< float >& headingsDegrees, const Vector2& acceleration )
+{
+	for( unsigned int actorIndex = 0; actorIndex < positions.size(); ++ actorIndex )
+	{
+		Vector2 velocity;
+		velocity.SetLengthAndYawDegrees( speeds[ actorIndex ], headingsDegrees[ actorIndex ] );
+		velocity += acceleration * BENCHMARK_DELTA_SECONDS;
+		speeds[ actorIndex ] = velocity.CalcLength();
+		headingsDegrees[ actorIndex ] = (float) velocity.CalcYawDegrees();
+		if( speeds[ actorIndex ] > BENCHMARK_MAX_SPEED )
+		{
+			velocity.SetLength( BENCHMARK_MAX_SPEED );
+			speeds[ actorIndex ] = velocity.CalcLength();
+			headingsDegrees[ actorIndex ] = (float) velocity.CalcYawDegrees();
+		}
+
+		velocity.SetLengthAndYawDegrees( speeds[ actorIndex ], headingsDegrees[ actorIndex ] );
+		positions[ actorIndex ] += velocity * BENCHMARK_DELTA_SECONDS;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The same step with a Cartesian velocity (as in Actor::UpdateAsPlayer / Actor::RunPhysics).
+//
+static void StepCartesianKinematics( std::vector< Vector2 >& positions, std::vector< Vector2 >& velocities, const Vector2& acceleration )
+{
+	for( unsigned int actorIndex = 0; actorIndex < positions.size(); ++ actorIndex )
+	{
+		Vector2& velocity = velocities[ actorIndex ];
+		velocity += acceleration * BENCHMARK_DELTA_SECONDS;
+		if( velocity.CalcLengthSquared() > BENCHMARK_MAX_SPEED * BENCHMARK_MAX_SPEED )
+		{
+			velocity.SetLength( BENCHMARK_MAX_SPEED );
+		}
+
+		positions[ actorIndex ] += velocity * BENCHMARK_DELTA_SECONDS;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static float CalcPositionChecksum( const std::vector< Vector2 >& positions )
+{
+	float checksum = 0.f;
+	for( unsigned int actorIndex = 0; actorIndex < positions.size(); ++ actorIndex )
+	{
+		checksum += positions[ actorIndex ].x + positions[ actorIndex ].y;
+	}
+
+	return checksum;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	int numActors = DEFAULT_BENCHMARK_ACTORS;
+	int numSteps = DEFAULT_BENCHMARK_STEPS;
+	for( int argIndex = 1; argIndex + 1 < argc; argIndex += 2 )
+	{
+		const std::string arg = argv[ argIndex ];
+		if( arg == "-actors" )
+			numActors = atoi( argv[ argIndex + 1 ] );
+		else if( arg == "-steps" )
+			numSteps = atoi( argv[ argIndex + 1 ] );
+	}
+
+	if( numActors <= 0 || numSteps <= 0 )
+	{
+		fprintf( stderr, "Usage: %s [-actors N] [-steps N]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	Clock::InitializeClockSystem();
+	const Vector2 acceleration( 30.f, -20.f );
+
+	std::vector< Vector2 > polarPositions( numActors, Vector2::ZERO );
+	std::vector< float > speeds( numActors, 0.f );
+	std::vector< float > headingsDegrees( numActors, 0.f );
+	double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	for( int stepIndex = 0; stepIndex < numSteps; ++ stepIndex )
+	{
+		StepPolarKinematics( polarPositions, speeds, headingsDegrees, acceleration );
+	}
+	const double polarSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+
+	std::vector< Vector2 > cartesianPositions( numActors, Vector2::ZERO );
+	std::vector< Vector2 > velocities( numActors, Vector2::ZERO );
+	timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	for( int stepIndex = 0; stepIndex < numSteps; ++ stepIndex )
+	{
+		StepCartesianKinematics( cartesianPositions, velocities, acceleration );
+	}
+	const double cartesianSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+
+	const double numActorSteps = (double) numActors * (double) numSteps;
+	const double polarNanosecondsPerActorStep = 1e9 * polarSeconds / numActorSteps;
+	const double cartesianNanosecondsPerActorStep = 1e9 * cartesianSeconds / numActorSteps;
+	printf( "actors=%d steps=%d polar_ns_per_actor_step=%.2f cartesian_ns_per_actor_step=%.2f speedup=%.2f checksums=%.1f,%.1f\n",
+		numActors, numSteps, polarNanosecondsPerActorStep, cartesianNanosecondsPerActorStep,
+		cartesianNanosecondsPerActorStep > 0.0 ? polarNanosecondsPerActorStep / cartesianNanosecondsPerActorStep : 0.0,
+		CalcPositionChecksum( polarPositions ), CalcPositionChecksum( cartesianPositions ) );
+
+	return 0;
+}
@@ -0,0 +1,544 @@
+//-----------------------------------------------------------------------------------------------
+// Benchmark_ScaledScenarios.cpp
+//
+// Builds Claustrophobia-, Popularity- and SelfSacrifice-style scenarios procedurally at crowd
+//	sizes the hand-made ones never reach, steps each headless for a fixed number of ticks, and
+//	prints one line of key=value pairs per configuration: ns per actor per tick, relationships
+//	run per second, and peak memory.  Each configuration runs in its own forked process, so its
+//	peak RSS is its own (rss_before_kb is what the process held before the scenario was built).
+//	State hashing stays on (and in the timings): state_hash covers every tick, so a change that
+//	was meant to be a pure optimization can be checked against the previous run's value.
+//
+//	Claustrophobia: a staggered grid of NPCs that all avoid bumping each other (a bounded rule),
+//		with the player pushing in from the left.
+//	Popularity: groups of 19 NPCs scattered around a player, each drawn toward it when near.
+//	SelfSacrifice: groups of 18 NPCs in a 3x6 block, each mimicking its player's motion (an
+//		unbounded relationship, so it runs every tick regardless of distance).
+//
+//	Every layout sits on a grid of floor areas (so NPCs stay alive) inside four walls, plus a goal;
+//	-areas sets the total.  Players walk a square, steered through TheGame's key states.
+//	Builds on Linux (see Makefile).
+//
+// Usage: PH2011_ScaledScenariosBenchmark [-scenario Claustrophobia|Popularity|SelfSacrifice] [-actors N] [-areas N]
+//	[-ticks N] [-warmup N] [-mode in-place|double-buffered|parallel] [-threads N]
+//-----------------------------------------------------------------------------------------------
+#include "TheGame.hpp"
+#include "SimulationStateHash.hpp"
+#include <stdio.h>
+#include <math.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const int DEFAULT_SCALED_BENCHMARK_TICKS = 100;
+const int DEFAULT_SCALED_BENCHMARK_WARMUP_TICKS = 10; // untimed, so relationship indices and the spatial hash are built first
+const double SCALED_BENCHMARK_DELTA_SECONDS = 1.0 / 60.0;
+const unsigned int SCALED_BENCHMARK_ACTOR_COUNTS[] = { 100, 1000, 10000, 100000 };
+const unsigned int SCALED_BENCHMARK_AREA_COUNTS[] = { 10, 100, 1000, 10000 };
+const unsigned int MIN_SCALED_SCENARIO_AREAS = 6; // four walls, a goal, and at least one floor tile
+const unsigned int PLAYER_WALK_TICKS_PER_SIDE = 60;
+const unsigned char PLAYER_WALK_KEYS[] = { VK_RIGHT, VK_DOWN, VK_LEFT, VK_UP };
+const float SCALED_SCENARIO_WALL_THICKNESS = 10.f;
+const unsigned int POPULARITY_GROUP_SIZE = 20; // one player and its followers, as in Popularity
+const float POPULARITY_GROUP_CELL_SIZE = 320.f;
+const int SELF_SACRIFICE_GROUP_COLUMNS = 3;
+const int SELF_SACRIFICE_GROUP_ROWS = 6;
+const float SELF_SACRIFICE_FOLLOWER_SPACING = 40.f;
+
+// Read by the start functions, which take only the scenario
+static unsigned int s_numActorsToCreate = 0;
+static unsigned int s_numAreasToCreate = 0;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class ScaledScenarioStyle
+{
+public:
+	const char* m_name;
+	const char* m_scenarioName; // distinct from the hand-made scenario's, which TheGame also has
+	ScenarioStartFunctionPointer m_startFunction;
+	ScenarioUpdateFunctionPointer m_updateFunction;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class ScaledBenchmarkOptions
+{
+public:
+	ScaledBenchmarkOptions();
+	bool ParseCommandLine( int argc, char** argv );
+
+	std::string m_styleName; // empty runs every style
+	unsigned int m_numActors; // zero runs every SCALED_BENCHMARK_ACTOR_COUNTS entry
+	unsigned int m_numAreas; // zero runs every SCALED_BENCHMARK_AREA_COUNTS entry
+	int m_numTicks;
+	int m_numWarmupTicks;
+	SimulationUpdateMode m_updateMode;
+	unsigned int m_numThreads;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Tiles <worldBounds> with s_numAreasToCreate - 5 floor areas in a near-square grid, whose last
+//	row holds what is left over (stretched to the full width), then walls it in and adds a goal
+//	on the right.
+//
+static void CreateScaledFloorAndWalls( Scenario& scenario, const AABB2& worldBounds )
+{
+	const unsigned int numFloorTiles = s_numAreasToCreate - (MIN_SCALED_SCENARIO_AREAS - 1);
+	const float worldWidth = worldBounds.maxs.x - worldBounds.mins.x;
+	const float worldHeight = worldBounds.maxs.y - worldBounds.mins.y;
+	const double idealNumColumns = sqrt( (double) numFloorTiles * worldWidth / worldHeight );
+	unsigned int numColumns = (unsigned int) floor( idealNumColumns + 0.5 );
+	if( numColumns < 1 )
+		numColumns = 1;
+	if( numColumns > numFloorTiles )
+		numColumns = numFloorTiles;
+
+	const unsigned int numRows = (numFloorTiles + numColumns - 1) / numColumns;
+	const float tileHeight = worldHeight / (float) numRows;
+	for( unsigned int row = 0; row < numRows; ++ row )
+	{
+		const unsigned int numTilesBeforeRow = row * numColumns;
+		const unsigned int numColumnsInRow = (numFloorTiles - numTilesBeforeRow < numColumns) ? (numFloorTiles - numTilesBeforeRow) : numColumns;
+		const float tileWidth = worldWidth / (float) numColumnsInRow;
+		for( unsigned int column = 0; column < numColumnsInRow; ++ column )
+		{
+			Area* tile = scenario.CreateArea();
+			const float tileLeft = worldBounds.mins.x + tileWidth * (float) column;
+			const float tileTop = worldBounds.mins.y + tileHeight * (float) row;
+			tile->m_bounds.SetFromMinXYMaxXY( tileLeft, tileTop, tileLeft + tileWidth, tileTop + tileHeight );
+			tile->m_deepShadow = false;
+		}
+	}
+
+	const float t = SCALED_SCENARIO_WALL_THICKNESS;
+	const AABB2 wallBounds[ 4 ] =
+	{
+		AABB2( worldBounds.mins.x, worldBounds.mins.y, worldBounds.mins.x + t, worldBounds.maxs.y ),
+		AABB2( worldBounds.maxs.x - t, worldBounds.mins.y, worldBounds.maxs.x, worldBounds.maxs.y ),
+		AABB2( worldBounds.mins.x, worldBounds.mins.y, worldBounds.maxs.x, worldBounds.mins.y + t ),
+		AABB2( worldBounds.mins.x, worldBounds.maxs.y - t, worldBounds.maxs.x, worldBounds.maxs.y ),
+	};
+
+	for( int wallIndex = 0; wallIndex < 4; ++ wallIndex )
+	{
+		Area* wall = scenario.CreateArea();
+		wall->m_bounds = wallBounds[ wallIndex ];
+		wall->m_color = Rgba::DARKGREY;
+		wall->m_alpha = 1.f;
+		wall->m_impassableToNPC = true;
+		wall->m_impassableToPlayer = true;
+		wall->m_deepShadow = false;
+	}
+
+	Area* goal = scenario.CreateArea();
+	const float worldCenterY = 0.5f * (worldBounds.mins.y + worldBounds.maxs.y);
+	goal->m_bounds.SetFromMinXYMaxXY( worldBounds.maxs.x - 96.f, worldCenterY - 64.f, worldBounds.maxs.x, worldCenterY + 64.f );
+	goal->m_color = Rgba::WHITE;
+	goal->m_alpha = 1.f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static Actor* CreatePlayer( Scenario& scenario, const Vector2& position )
+{
+	Actor* player = scenario.CreateActor();
+	player->SetPosition( position );
+	player->SetIsPlayer( true );
+	player->m_baseColor = Rgba::BLUE;
+	return player;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static Actor* CreateNPC( Scenario& scenario, const Vector2& position )
+{
+	Actor* npc = scenario.CreateActor();
+	npc->SetPosition( position );
+	npc->m_baseColor = Rgba::WHITE;
+	return npc;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Claustrophobia's 50x30 staggered grid, grown to a roughly 16:9 block of s_numActorsToCreate - 1.
+//
+static void ScenarioStartFunction_ScaledClaustrophobia( Scenario& scenario )
+{
+	const float columnSpacing = 50.f;
+	const float rowSpacing = 30.f;
+	const float stagger = 16.f;
+	const float margin = 200.f;
+	const unsigned int numNPCs = s_numActorsToCreate - 1;
+	const unsigned int numColumns = MaxInt( 1, (int) ceil( sqrt( (double) numNPCs * (16.0 * rowSpacing) / (9.0 * columnSpacing) ) ) );
+	const unsigned int numRows = (numNPCs + numColumns - 1) / numColumns;
+	const AABB2 worldBounds( 0.f, 0.f, (2.f * margin) + (columnSpacing * (float) numColumns), (2.f * margin) + stagger + (rowSpacing * (float) numRows) );
+
+	CreatePlayer( scenario, Vector2( 0.5f * margin, 0.5f * worldBounds.maxs.y ) );
+	for( unsigned int npcIndex = 0; npcIndex < numNPCs; ++ npcIndex )
+	{
+		const unsigned int column = npcIndex / numRows;
+		const unsigned int row = npcIndex % numRows;
+		CreateNPC( scenario, Vector2( margin + columnSpacing * ((float) column + 0.5f), margin + (rowSpacing * (float) row) + (float)( column % 2 ) * stagger ) );
+	}
+
+	RelationshipRule dontBump;
+	dontBump.m_relationship.m_innerDistance = 0;
+	dontBump.m_relationship.m_outerDistance = 20;
+	dontBump.m_relationship.m_attractionRepulsionAtOuterDistance = Vector2( 0, 0 );
+	dontBump.m_relationship.m_attractionRepulsionAtInnerDistance = Vector2( -5, -5 );
+	scenario.AddRelationshipRule( dontBump );
+
+	CreateScaledFloorAndWalls( scenario, worldBounds );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Popularity's followers, POPULARITY_GROUP_SIZE to a player, each group scattered over its own cell.
+//
+static void ScenarioStartFunction_ScaledPopularity( Scenario& scenario )
+{
+	const float margin = 64.f;
+	const unsigned int numGroups = (s_numActorsToCreate + POPULARITY_GROUP_SIZE - 1) / POPULARITY_GROUP_SIZE;
+	const unsigned int numColumns = MaxInt( 1, (int) ceil( sqrt( (double) numGroups * 16.0 / 9.0 ) ) );
+	const unsigned int numRows = (numGroups + numColumns - 1) / numColumns;
+	const AABB2 worldBounds( 0.f, 0.f, (2.f * margin) + (POPULARITY_GROUP_CELL_SIZE * (float) numColumns), (2.f * margin) + (POPULARITY_GROUP_CELL_SIZE * (float) numRows) );
+
+	srand( s_numActorsToCreate ); // the same layout every run
+	unsigned int numActorsCreated = 0;
+	for( unsigned int groupIndex = 0; groupIndex < numGroups; ++ groupIndex )
+	{
+		const Vector2 cellMins( margin + POPULARITY_GROUP_CELL_SIZE * (float)( groupIndex % numColumns ), margin + POPULARITY_GROUP_CELL_SIZE * (float)( groupIndex / numColumns ) );
+		const Vector2 cellCenter = cellMins + Vector2( 0.5f * POPULARITY_GROUP_CELL_SIZE, 0.5f * POPULARITY_GROUP_CELL_SIZE );
+		Actor* player = CreatePlayer( scenario, cellCenter );
+		++ numActorsCreated;
+
+		RelationshipToOtherActor followPlayer;
+		followPlayer.m_innerDistance = 75;
+		followPlayer.m_outerDistance = 125;
+		followPlayer.m_attractionRepulsionAtOuterDistance = Vector2( 0, 0 );
+		followPlayer.m_attractionRepulsionAtInnerDistance = Vector2( 1.5f, 1.5f );
+		followPlayer.m_otherActor = player;
+
+		for( unsigned int followerIndex = 1; followerIndex < POPULARITY_GROUP_SIZE && numActorsCreated < s_numActorsToCreate; ++ followerIndex )
+		{
+			const Vector2 position( cellMins.x + RandomFloatInRangeInclusive( 16.f, POPULARITY_GROUP_CELL_SIZE - 16.f ), cellMins.y + RandomFloatInRangeInclusive( 16.f, POPULARITY_GROUP_CELL_SIZE - 16.f ) );
+			Actor* follower = CreateNPC( scenario, position );
+			follower->m_relationships.push_back( followPlayer );
+			++ numActorsCreated;
+		}
+	}
+
+	RelationshipRule dontBump;
+	dontBump.m_relationship.m_innerDistance = 0;
+	dontBump.m_relationship.m_outerDistance = 32;
+	dontBump.m_relationship.m_attractionRepulsionAtOuterDistance = Vector2( 0, 0 );
+	dontBump.m_relationship.m_attractionRepulsionAtInnerDistance = Vector2( -2, -2 );
+	scenario.AddRelationshipRule( dontBump );
+
+	CreateScaledFloorAndWalls( scenario, worldBounds );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// SelfSacrifice's player with a 3x6 block of mimics beside it, repeated across a grid of cells.
+//
+static void ScenarioStartFunction_ScaledSelfSacrifice( Scenario& scenario )
+{
+	const float margin = 64.f;
+	const unsigned int groupSize = 1 + (SELF_SACRIFICE_GROUP_COLUMNS * SELF_SACRIFICE_GROUP_ROWS);
+	const float cellWidth = SELF_SACRIFICE_FOLLOWER_SPACING * (float)( SELF_SACRIFICE_GROUP_COLUMNS + 3 );
+	const float cellHeight = SELF_SACRIFICE_FOLLOWER_SPACING * (float)( SELF_SACRIFICE_GROUP_ROWS + 1 );
+	const unsigned int numGroups = (s_numActorsToCreate + groupSize - 1) / groupSize;
+	const unsigned int numColumns = MaxInt( 1, (int) ceil( sqrt( (double) numGroups * (16.0 * cellHeight) / (9.0 * cellWidth) ) ) );
+	const unsigned int numRows = (numGroups + numColumns - 1) / numColumns;
+	const AABB2 worldBounds( 0.f, 0.f, (2.f * margin) + (cellWidth * (float) numColumns), (2.f * margin) + (cellHeight * (float) numRows) );
+
+	unsigned int numActorsCreated = 0;
+	for( unsigned int groupIndex = 0; groupIndex < numGroups; ++ groupIndex )
+	{
+		const Vector2 cellMins( margin + cellWidth * (float)( groupIndex % numColumns ), margin + cellHeight * (float)( groupIndex / numColumns ) );
+		Actor* player = CreatePlayer( scenario, cellMins + Vector2( SELF_SACRIFICE_FOLLOWER_SPACING, 0.5f * cellHeight ) );
+		++ numActorsCreated;
+
+		RelationshipToOtherActor followPlayer;
+		followPlayer.m_mimicMotionAtOuterDistance = Vector2( 1, 1 );
+		followPlayer.m_otherActor = player;
+
+		for( int followerIndex = 0; followerIndex < SELF_SACRIFICE_GROUP_COLUMNS * SELF_SACRIFICE_GROUP_ROWS && numActorsCreated < s_numActorsToCreate; ++ followerIndex )
+		{
+			const float column = (float)( followerIndex % SELF_SACRIFICE_GROUP_COLUMNS );
+			const float row = (float)( followerIndex / SELF_SACRIFICE_GROUP_COLUMNS );
+			const Vector2 position = cellMins + Vector2( SELF_SACRIFICE_FOLLOWER_SPACING * (column + 2.5f), SELF_SACRIFICE_FOLLOWER_SPACING * (row + 1.f) );
+			Actor* follower = CreateNPC( scenario, position );
+			follower->m_relationships.push_back( followPlayer );
+			++ numActorsCreated;
+		}
+	}
+
+	CreateScaledFloorAndWalls( scenario, worldBounds );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Holds down one arrow key at a time, switching every PLAYER_WALK_TICKS_PER_SIDE ticks, so every
+//	player walks the same square.
+//
+static void ScenarioUpdateFunction_WalkPlayers( Scenario& scenario, double deltaSeconds )
+{
+	UNUSED( deltaSeconds );
+	const unsigned int tickIndex = scenario.m_numUpdates - 1;
+	if( tickIndex % PLAYER_WALK_TICKS_PER_SIDE != 0 )
+		return;
+
+	const unsigned int numSides = sizeof( PLAYER_WALK_KEYS ) / sizeof( PLAYER_WALK_KEYS[ 0 ] );
+	const unsigned int sideIndex = (tickIndex / PLAYER_WALK_TICKS_PER_SIDE) % numSides;
+	theGame->SetSimulationKeyDown( PLAYER_WALK_KEYS[ (sideIndex + numSides - 1) % numSides ], false );
+	theGame->SetSimulationKeyDown( PLAYER_WALK_KEYS[ sideIndex ], true );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The player pushes straight into the crowd, as in Claustrophobia.
+//
+static void ScenarioUpdateFunction_PushRight( Scenario& scenario, double deltaSeconds )
+{
+	UNUSED( deltaSeconds );
+	if( scenario.m_numUpdates == 1 )
+	{
+		theGame->SetSimulationKeyDown( VK_RIGHT, true );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+const ScaledScenarioStyle SCALED_SCENARIO_STYLES[] =
+{
+	{ "Claustrophobia", "ScaledClaustrophobia", ScenarioStartFunction_ScaledClaustrophobia, ScenarioUpdateFunction_PushRight },
+	{ "Popularity", "ScaledPopularity", ScenarioStartFunction_ScaledPopularity, ScenarioUpdateFunction_WalkPlayers },
+	{ "SelfSacrifice", "ScaledSelfSacrifice", ScenarioStartFunction_ScaledSelfSacrifice, ScenarioUpdateFunction_WalkPlayers },
+};
+
+
+//-----------------------------------------------------------------------------------------------
+ScaledBenchmarkOptions::ScaledBenchmarkOptions()
+	: m_numActors( 0 )
+	, m_numAreas( 0 )
+	, m_numTicks( DEFAULT_SCALED_BENCHMARK_TICKS )
+	, m_numWarmupTicks( DEFAULT_SCALED_BENCHMARK_WARMUP_TICKS )
+	, m_updateMode( SIMULATION_UPDATE_IN_PLACE )
+	, m_numThreads( SysGetNumberOfHardwareThreads() )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool ScaledBenchmarkOptions::ParseCommandLine( int argc, char** argv )
+{
+	for( int argIndex = 1; argIndex + 1 < argc; argIndex += 2 )
+	{
+		const std::string arg = argv[ argIndex ];
+		const char* value = argv[ argIndex + 1 ];
+		if( arg == "-scenario" )
+		{
+			m_styleName = value;
+		}
+		else if( arg == "-actors" )
+		{
+			m_numActors = (unsigned int) atoi( value );
+			if( m_numActors == 0 )
+				return false;
+		}
+		else if( arg == "-areas" )
+		{
+			m_numAreas = (unsigned int) atoi( value );
+			if( m_numAreas < MIN_SCALED_SCENARIO_AREAS )
+				return false;
+		}
+		else if( arg == "-ticks" )
+		{
+			m_numTicks = atoi( value );
+		}
+		else if( arg == "-warmup" )
+		{
+			m_numWarmupTicks = atoi( value );
+		}
+		else if( arg == "-mode" )
+		{
+			if( !FindSimulationUpdateModeByName( value, m_updateMode ) )
+				return false;
+		}
+		else if( arg == "-threads" )
+		{
+			m_numThreads = (unsigned int) MaxInt( 1, atoi( value ) );
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return (argc % 2) == 1 && m_numTicks > 0 && m_numWarmupTicks >= 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// A "<fieldName>:   N kB" line of /proc/self/status, such as VmRSS (resident set size now) or
+//	VmHWM (its peak); both come from the same kernel counters, so the peak is never below a
+//	current reading.  Zero if it can't be read.
+//
+static unsigned long ReadProcessStatusKilobytes( const char* fieldName )
+{
+	FILE* statusFile = fopen( "/proc/self/status", "r" );
+	if( !statusFile )
+		return 0;
+
+	const size_t fieldNameLength = strlen( fieldName );
+	unsigned long kilobytes = 0;
+	char line[ 256 ];
+	while( fgets( line, sizeof( line ), statusFile ) )
+	{
+		if( strncmp( line, fieldName, fieldNameLength ) == 0 && line[ fieldNameLength ] == ':' )
+		{
+			kilobytes = strtoul( line + fieldNameLength + 1, NULL, 10 );
+			break;
+		}
+	}
+
+	fclose( statusFile );
+	return kilobytes;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Builds and runs one configuration in this process, and prints its line.
+//
+static void RunScaledScenario( const ScaledScenarioStyle& style, unsigned int numActors, unsigned int numAreas, const ScaledBenchmarkOptions& options )
+{
+	theGame = new TheGame();
+	theGame->Startup( "" );
+	theGame->StartScenario( NULL ); // drop the default scenario, so it isn't counted below
+	theGame->CreateScenario( style.m_scenarioName, style.m_startFunction, style.m_updateFunction );
+	theGame->SetNumSimulationThreads( options.m_numThreads );
+	theGame->SetSimulationUpdateMode( options.m_updateMode );
+	const unsigned long residentKilobytesBefore = ReadProcessStatusKilobytes( "VmRSS" );
+
+	s_numActorsToCreate = numActors;
+	s_numAreasToCreate = numAreas;
+	const double timeAtBuildStart = Clock::GetAbsoluteTimeSeconds();
+	theGame->StartScenarioByName( style.m_scenarioName );
+	Scenario& scenario = *theGame->GetCurrentScenario();
+	const double buildSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtBuildStart;
+	SimulationStateHashLog stateHashLog;
+	scenario.m_stateHashLog = &stateHashLog;
+
+	for( int tickIndex = 0; tickIndex < options.m_numWarmupTicks; ++ tickIndex )
+	{
+		scenario.Update( SCALED_BENCHMARK_DELTA_SECONDS );
+	}
+
+	const double numRelationshipsRunBefore = scenario.CalcNumRelationshipsRun();
+	const double secondsHashingBefore = stateHashLog.GetSecondsHashing();
+	const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	for( int tickIndex = 0; tickIndex < options.m_numTicks; ++ tickIndex )
+	{
+		scenario.Update( SCALED_BENCHMARK_DELTA_SECONDS );
+	}
+
+	double elapsedSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+	if( elapsedSeconds <= 0.0 )
+	{
+		elapsedSeconds = 1e-9;
+	}
+
+	const double numRelationshipsRun = scenario.CalcNumRelationshipsRun() - numRelationshipsRunBefore;
+	const double secondsHashing = stateHashLog.GetSecondsHashing() - secondsHashingBefore;
+	const double numActorTicks = (double) scenario.m_actors.GetNumActors() * (double) options.m_numTicks;
+	unsigned int numActorsAlive = 0;
+	for( unsigned int actorIndex = 0; actorIndex < scenario.m_actors.GetNumActors(); ++ actorIndex )
+	{
+		if( scenario.m_actors.m_states[ actorIndex ] == ACTOR_STATE_ACTIVE )
+			++ numActorsAlive;
+	}
+
+	printf( "scenario=%s actors=%u areas=%u mode=%s threads=%u ticks=%d build_ms=%.3f seconds=%.6f ns_per_actor_tick=%.1f"
+		" relationships_per_tick=%.0f relationships_per_sec=%.1f actors_active_at_end=%u rss_before_kb=%lu peak_rss_kb=%lu state_hash=%016llx hash_overhead=%.2f%%\n",
+		style.m_name, scenario.m_actors.GetNumActors(), (unsigned int) scenario.m_areas.size(), SIMULATION_UPDATE_MODE_NAMES[ options.m_updateMode ],
+		options.m_updateMode == SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL ? options.m_numThreads : 1, options.m_numTicks, 1000.0 * buildSeconds, elapsedSeconds,
+		1e9 * elapsedSeconds / numActorTicks, numRelationshipsRun / (double) options.m_numTicks, numRelationshipsRun / elapsedSeconds, numActorsAlive,
+		residentKilobytesBefore, ReadProcessStatusKilobytes( "VmHWM" ), stateHashLog.GetCombinedHash(), 100.0 * secondsHashing / elapsedSeconds );
+
+	theGame->Shutdown();
+	delete theGame;
+	theGame = NULL;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Runs each configuration in a child process, so one configuration's memory high-water mark (or
+//	crash) doesn't carry over to the next.
+//
+int main( int argc, char** argv )
+{
+	ScaledBenchmarkOptions options;
+	if( !options.ParseCommandLine( argc, argv ) )
+	{
+		fprintf( stderr, "Usage: %s [-scenario Claustrophobia|Popularity|SelfSacrifice] [-actors N] [-areas N] [-ticks N] [-warmup N] [-mode in-place|double-buffered|parallel] [-threads N]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	const int numStyles = sizeof( SCALED_SCENARIO_STYLES ) / sizeof( SCALED_SCENARIO_STYLES[ 0 ] );
+	const int numActorCounts = sizeof( SCALED_BENCHMARK_ACTOR_COUNTS ) / sizeof( SCALED_BENCHMARK_ACTOR_COUNTS[ 0 ] );
+	const int numAreaCounts = sizeof( SCALED_BENCHMARK_AREA_COUNTS ) / sizeof( SCALED_BENCHMARK_AREA_COUNTS[ 0 ] );
+	int numConfigurationsRun = 0;
+	int numConfigurationsFailed = 0;
+	for( int styleIndex = 0; styleIndex < numStyles; ++ styleIndex )
+	{
+		const ScaledScenarioStyle& style = SCALED_SCENARIO_STYLES[ styleIndex ];
+		if( !options.m_styleName.empty() && Stricmp( options.m_styleName, style.m_name ) )
+			continue;
+
+		for( int actorCountIndex = 0; actorCountIndex < numActorCounts; ++ actorCountIndex )
+		{
+			const unsigned int numActors = options.m_numActors ? options.m_numActors : SCALED_BENCHMARK_ACTOR_COUNTS[ actorCountIndex ];
+			for( int areaCountIndex = 0; areaCountIndex < numAreaCounts; ++ areaCountIndex )
+			{
+				const unsigned int numAreas = options.m_numAreas ? options.m_numAreas : SCALED_BENCHMARK_AREA_COUNTS[ areaCountIndex ];
+				fflush( stdout );
+				const pid_t childProcess = fork();
+				if( childProcess == 0 )
+				{
+					RunScaledScenario( style, numActors, numAreas, options );
+					fflush( stdout );
+					_exit( 0 );
+				}
+
+				int childStatus = 0;
+				if( childProcess < 0 || waitpid( childProcess, &childStatus, 0 ) != childProcess || !WIFEXITED( childStatus ) || WEXITSTATUS( childStatus ) != 0 )
+				{
+					fprintf( stderr, "scenario=%s actors=%u areas=%u failed\n", style.m_name, numActors, numAreas );
+					++ numConfigurationsFailed;
+				}
+
+				++ numConfigurationsRun;
+				if( options.m_numAreas )
+					break;
+			}
+
+			if( options.m_numActors )
+				break;
+		}
+	}
+
+	if( numConfigurationsRun == 0 )
+	{
+		fprintf( stderr, "No scenario style named '%s'\n", options.m_styleName.c_str() );
+		return 1;
+	}
+
+	return numConfigurationsFailed > 0 ? 1 : 0;
+}
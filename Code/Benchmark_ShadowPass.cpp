@@ -0,0 +1,190 @@
+//-----------------------------------------------------------------------------------------------
+// Benchmark_ShadowPass.cpp
+//
+// Compares the shadow pass as it used to be drawn (three stacked 0.1-alpha circles or quads per
+//	object) with the single soft-edged primitive per object that Actor::Draw and Area::Draw now
+//	record.  For each scenario it reports commands, vertices produced by the OpenGL backend's
+//	tessellation, pixels blended by the software rasterizer, and the time of each.  The stacked
+//	circles get the radius-based LODs DrawFilledCircle gets today (not the old 40-sided
+//	polygons), so vertex_ratio is against that cheaper baseline: about 8-16x where actor shadows
+//	(one sprite quad each) dominate, under 3x where area shadows do (SelfDoubt), and about 11x
+//	in total.  Fill is about 2.8x fewer pixels; a soft shadow still covers the largest layer.
+//
+// Usage: PH2011_ShadowPassBenchmark [-frames N] [-steps N]
+//-----------------------------------------------------------------------------------------------
+#include "TheGame.hpp"
+#include "Graphics.hpp"
+#include "SoftwareRasterizer.hpp"
+#include <stdio.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const int DEFAULT_BENCHMARK_FRAMES = 200;
+const int DEFAULT_BENCHMARK_WARMUP_STEPS = 60; // so actors have moved apart from their start positions
+const char* BENCHMARK_SCENARIO_NAMES[] = { "Claustrophobia", "Popularity", "Responsibility", "SelfSacrifice", "SelfDoubt", "Schadenfreude" };
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class ShadowPassMeasurement
+{
+public:
+	ShadowPassMeasurement() : m_numCommands( 0 ), m_numVertices( 0.0 ), m_numPixelsBlended( 0.0 ), m_tessellateSeconds( 0.0 ), m_rasterizeSeconds( 0.0 ) {}
+
+	unsigned int m_numCommands;
+	double m_numVertices;
+	double m_numPixelsBlended;
+	double m_tessellateSeconds;
+	double m_rasterizeSeconds;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// The shadow pass exactly as Actor::Draw and Area::Draw drew it before the soft-shadow primitive.
+//
+static void RecordStackedShadowPass( const Scenario& scenario )
+{
+	for( unsigned int areaIndex = 0; areaIndex < scenario.m_areas.size(); ++ areaIndex )
+	{
+		const Area& area = *scenario.m_areas[ areaIndex ];
+		const float paddingStep = area.m_deepShadow ? 4.f : 1.f;
+		const Vector2 areaShadowOffset = area.m_deepShadow ? Vector2( 10.f, 10.f ) : Vector2( 3.f, 3.f );
+		for( int layerIndex = 0; layerIndex < 3; ++ layerIndex )
+		{
+			AABB2 shadowArea( area.m_bounds );
+			shadowArea.AddPadding( (float) layerIndex * paddingStep, (float) layerIndex * paddingStep );
+			shadowArea.Translate( areaShadowOffset );
+			DrawFilledArea( shadowArea, Rgba::BLACK, 0.1f * area.m_alpha );
+		}
+	}
+
+	for( unsigned int actorIndex = 0; actorIndex < scenario.m_actors.GetNumActors(); ++ actorIndex )
+	{
+		const Actor& actor = *scenario.m_actors.m_actors[ actorIndex ];
+		if( actor.GetState() == ACTOR_STATE_DEAD )
+			continue;
+
+		const Vector2 actorShadowOffset( 3.f, 3.f );
+		DrawFilledCircle( actor.GetPosition() + actorShadowOffset, 1.2f * actor.CalcRadius(), Rgba::BLACK, 0.1f * actor.CalcAlpha() );
+		DrawFilledCircle( actor.GetPosition() + actorShadowOffset, 1.1f * actor.CalcRadius(), Rgba::BLACK, 0.1f * actor.CalcAlpha() );
+		DrawFilledCircle( actor.GetPosition() + actorShadowOffset, 1.0f * actor.CalcRadius(), Rgba::BLACK, 0.1f * actor.CalcAlpha() );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void RecordSoftShadowPass( Scenario& scenario )
+{
+	for( unsigned int areaIndex = 0; areaIndex < scenario.m_areas.size(); ++ areaIndex )
+	{
+		scenario.m_areas[ areaIndex ]->Draw( true );
+	}
+
+	for( unsigned int actorIndex = 0; actorIndex < scenario.m_actors.GetNumActors(); ++ actorIndex )
+	{
+		scenario.m_actors.m_actors[ actorIndex ]->Draw( true, 1.f );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Replays the recorded pass <numFrames> times through each backend.
+//
+static ShadowPassMeasurement MeasureRecordedPass( int numFrames )
+{
+	ShadowPassMeasurement measurement;
+	measurement.m_numCommands = GetRenderCommands().GetNumCommands();
+
+	OpenGLRenderBackend tessellator;
+	SoftwareRenderBackend rasterizer( 1024, 576, AABB2( 0.f, 0.f, 1024.f, 576.f ) );
+	double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	for( int frameIndex = 0; frameIndex < numFrames; ++ frameIndex )
+	{
+		tessellator.Execute( GetRenderCommands() );
+	}
+	measurement.m_tessellateSeconds = (Clock::GetAbsoluteTimeSeconds() - timeAtStart) / (double) numFrames;
+
+	timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	for( int frameIndex = 0; frameIndex < numFrames; ++ frameIndex )
+	{
+		rasterizer.Execute( GetRenderCommands() );
+	}
+	measurement.m_rasterizeSeconds = (Clock::GetAbsoluteTimeSeconds() - timeAtStart) / (double) numFrames;
+
+	measurement.m_numVertices = tessellator.m_numVerticesGenerated / (double) numFrames;
+	measurement.m_numPixelsBlended = rasterizer.m_numPixelsBlended / (double) numFrames;
+	NullRenderBackend discardBackend;
+	SetRenderBackend( &discardBackend );
+	FlushGraphicsBatch();
+	SetRenderBackend( NULL );
+	return measurement;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static double CalcRatio( double before, double after )
+{
+	return after > 0.0 ? before / after : 0.0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	int numFrames = DEFAULT_BENCHMARK_FRAMES;
+	int numWarmupSteps = DEFAULT_BENCHMARK_WARMUP_STEPS;
+	for( int argIndex = 1; argIndex + 1 < argc; argIndex += 2 )
+	{
+		const std::string arg = argv[ argIndex ];
+		if( arg == "-frames" )
+			numFrames = atoi( argv[ argIndex + 1 ] );
+		else if( arg == "-steps" )
+			numWarmupSteps = atoi( argv[ argIndex + 1 ] );
+	}
+
+	if( numFrames <= 0 || numWarmupSteps < 0 )
+	{
+		fprintf( stderr, "Usage: %s [-frames N] [-steps N]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	theGame = new TheGame();
+	theGame->Startup( "" );
+
+	ShadowPassMeasurement totalStacked;
+	ShadowPassMeasurement totalSoft;
+	const int numScenarios = sizeof( BENCHMARK_SCENARIO_NAMES ) / sizeof( BENCHMARK_SCENARIO_NAMES[ 0 ] );
+	for( int scenarioIndex = 0; scenarioIndex < numScenarios; ++ scenarioIndex )
+	{
+		theGame->StartScenarioByName( BENCHMARK_SCENARIO_NAMES[ scenarioIndex ] );
+		Scenario& scenario = *theGame->GetCurrentScenario();
+		for( int stepIndex = 0; stepIndex < numWarmupSteps; ++ stepIndex )
+		{
+			scenario.Update( 1.0 / 60.0 );
+		}
+
+		RecordStackedShadowPass( scenario );
+		const ShadowPassMeasurement stacked = MeasureRecordedPass( numFrames );
+		RecordSoftShadowPass( scenario );
+		const ShadowPassMeasurement soft = MeasureRecordedPass( numFrames );
+
+		printf( "scenario=%s stacked_commands=%u soft_commands=%u stacked_vertices=%.0f soft_vertices=%.0f vertex_ratio=%.2f"
+			" stacked_pixels=%.0f soft_pixels=%.0f fill_ratio=%.2f stacked_raster_ms=%.3f soft_raster_ms=%.3f stacked_tessellate_us=%.1f soft_tessellate_us=%.1f\n",
+			scenario.m_name.c_str(), stacked.m_numCommands, soft.m_numCommands, stacked.m_numVertices, soft.m_numVertices, CalcRatio( stacked.m_numVertices, soft.m_numVertices ),
+			stacked.m_numPixelsBlended, soft.m_numPixelsBlended, CalcRatio( stacked.m_numPixelsBlended, soft.m_numPixelsBlended ),
+			1000.0 * stacked.m_rasterizeSeconds, 1000.0 * soft.m_rasterizeSeconds, 1e6 * stacked.m_tessellateSeconds, 1e6 * soft.m_tessellateSeconds );
+
+		totalStacked.m_numVertices += stacked.m_numVertices;
+		totalStacked.m_numPixelsBlended += stacked.m_numPixelsBlended;
+		totalSoft.m_numVertices += soft.m_numVertices;
+		totalSoft.m_numPixelsBlended += soft.m_numPixelsBlended;
+	}
+
+	printf( "total vertex_ratio=%.2f fill_ratio=%.2f\n", CalcRatio( totalStacked.m_numVertices, totalSoft.m_numVertices ),
+		CalcRatio( totalStacked.m_numPixelsBlended, totalSoft.m_numPixelsBlended ) );
+
+	theGame->Shutdown();
+	delete theGame;
+	return 0;
+}
@@ -6,25 +6,57 @@
 //-----------------------------------------------------------------------------------------------
 #include "Clock.hpp"
 
+#if !defined( JAZZ_PLATFORM_WIN32 )
+#include <time.h>
+#endif
+
 
 //-----------------------------------------------------------------------------------------------
 // Static member initialization
 //
 STATIC bool Clock::s_isInitialized = false;
 STATIC double Clock::s_queryPerformanceSecondsPerTick = 0.0;
-STATIC LARGE_INTEGER Clock::s_queryPerformanceStartupValue;
+STATIC long long Clock::s_queryPerformanceStartupValue = 0;
 STATIC Clock* Clock::s_masterClock;
 STATIC Clock* Clock::s_applicationClock;
 STATIC unsigned int Clock::s_frameNumber;
 
 
 //-----------------------------------------------------------------------------------------------
-STATIC void Clock::InitializeClockSystem()
+// Raw high-resolution counter (QueryPerformanceCounter on Win32, CLOCK_MONOTONIC nanoseconds elsewhere)
+//
+static long long GetPerformanceCounterTicks()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	LARGE_INTEGER queryPerformanceCounterTime;
+	QueryPerformanceCounter( &queryPerformanceCounterTime );
+	return queryPerformanceCounterTime.QuadPart;
+#else
+	timespec timeNow;
+	clock_gettime( CLOCK_MONOTONIC, &timeNow );
+	return ((long long) timeNow.tv_sec * 1000000000LL) + (long long) timeNow.tv_nsec;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static long long GetPerformanceCounterTicksPerSecond()
 {
+#if defined( JAZZ_PLATFORM_WIN32 )
 	LARGE_INTEGER queryPerformanceTicksPerSecond;
 	QueryPerformanceFrequency( &queryPerformanceTicksPerSecond );
-	s_queryPerformanceSecondsPerTick = 1.0 / (double) queryPerformanceTicksPerSecond.QuadPart;
-	QueryPerformanceCounter( &s_queryPerformanceStartupValue );
+	return queryPerformanceTicksPerSecond.QuadPart;
+#else
+	return 1000000000LL;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Clock::InitializeClockSystem()
+{
+	s_queryPerformanceSecondsPerTick = 1.0 / (double) GetPerformanceCounterTicksPerSecond();
+	s_queryPerformanceStartupValue = GetPerformanceCounterTicks();
 
 	const double timeNow = GetAbsoluteTimeSeconds();
 	s_masterClock = new Clock();
@@ -39,10 +71,8 @@ STATIC void Clock::InitializeClockSystem()
 //-----------------------------------------------------------------------------------------------
 STATIC double Clock::GetAbsoluteTimeSeconds()
 {
-	LARGE_INTEGER queryPerformanceCounterTime;
-	QueryPerformanceCounter( &queryPerformanceCounterTime );
-	queryPerformanceCounterTime.QuadPart -= s_queryPerformanceStartupValue.QuadPart;
-	double seconds = s_queryPerformanceSecondsPerTick * (double) queryPerformanceCounterTime.QuadPart;
+	const long long ticksSinceStartup = GetPerformanceCounterTicks() - s_queryPerformanceStartupValue;
+	double seconds = s_queryPerformanceSecondsPerTick * (double) ticksSinceStartup;
 	return seconds;
 }
 
@@ -30,7 +30,7 @@ private:
 private:
 	static bool s_isInitialized;
 	static double s_queryPerformanceSecondsPerTick;
-	static LARGE_INTEGER s_queryPerformanceStartupValue;
+	static long long s_queryPerformanceStartupValue;
 	static Clock* s_masterClock;
 	static Clock* s_applicationClock;
 	static unsigned int s_frameNumber;
@@ -39,7 +39,6 @@ private:
 	static void DestroyRecursive( Clock* clockTreeToDestroy );
 
 private:
-	Clock();
 	void AddChildClock( Clock* childClock );
 	void RemoveChildClock( Clock* childClockToRemove );
 
@@ -49,6 +48,7 @@ public:
 	static Clock& GetApplicationClock() { return *s_applicationClock; }
 
 public:
+	Clock(); // a new root clock; advances only through AdvanceTime (e.g. a simulation clock)
 	Clock( Clock& parentClock );
 	virtual ~Clock();
 	static void Update();
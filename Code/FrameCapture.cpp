@@ -0,0 +1,322 @@
+//-----------------------------------------------------------------------------------------------
+// FrameCapture.cpp
+//-----------------------------------------------------------------------------------------------
+#include "FrameCapture.hpp"
+#include "Clock.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const char* FRAME_IMAGE_FORMAT_EXTENSIONS[ NUM_FRAME_IMAGE_FORMATS ] = { "ppm", "png" };
+const unsigned int MAX_STORED_DEFLATE_BLOCK_BYTES = 65535;
+const unsigned int ADLER_BYTES_BETWEEN_MODULOS = 5552; // most bytes that can be summed before the sums could overflow 32 bits
+unsigned int g_pngCrcTable[ 256 ];
+bool g_isPngCrcTableInitialized = false;
+
+
+//-----------------------------------------------------------------------------------------------
+static void AppendBytes( std::vector< unsigned char >& buffer, const void* bytes, size_t numBytes )
+{
+	const unsigned char* firstByte = (const unsigned char*) bytes;
+	buffer.insert( buffer.end(), firstByte, firstByte + numBytes );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void AppendBigEndian32( std::vector< unsigned char >& buffer, unsigned int value )
+{
+	buffer.push_back( (unsigned char)( value >> 24 ) );
+	buffer.push_back( (unsigned char)( value >> 16 ) );
+	buffer.push_back( (unsigned char)( value >> 8 ) );
+	buffer.push_back( (unsigned char)( value ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Standard PNG/zlib CRC-32 (polynomial 0xEDB88320).
+//
+static unsigned int CalcPngCrc( const unsigned char* bytes, size_t numBytes )
+{
+	if( !g_isPngCrcTableInitialized )
+	{
+		for( unsigned int tableIndex = 0; tableIndex < 256; ++ tableIndex )
+		{
+			unsigned int value = tableIndex;
+			for( int bitIndex = 0; bitIndex < 8; ++ bitIndex )
+			{
+				value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+			}
+
+			g_pngCrcTable[ tableIndex ] = value;
+		}
+
+		g_isPngCrcTableInitialized = true;
+	}
+
+	unsigned int crc = 0xFFFFFFFFu;
+	for( size_t byteIndex = 0; byteIndex < numBytes; ++ byteIndex )
+	{
+		crc = g_pngCrcTable[ (crc ^ bytes[ byteIndex ]) & 0xFF ] ^ (crc >> 8);
+	}
+
+	return crc ^ 0xFFFFFFFFu;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Appends length, type, data and CRC.
+//
+static void AppendPngChunk( std::vector< unsigned char >& buffer, const char* chunkType, const std::vector< unsigned char >& chunkData )
+{
+	AppendBigEndian32( buffer, (unsigned int) chunkData.size() );
+	const size_t typeOffset = buffer.size();
+	AppendBytes( buffer, chunkType, 4 );
+	if( !chunkData.empty() )
+	{
+		AppendBytes( buffer, &chunkData[ 0 ], chunkData.size() );
+	}
+
+	AppendBigEndian32( buffer, CalcPngCrc( &buffer[ typeOffset ], buffer.size() - typeOffset ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+FrameSequenceWriter::FrameSequenceWriter( int width, int height, const AABB2& viewBounds, unsigned int maxPendingFrames )
+	: m_pendingCommands( maxPendingFrames )
+	, m_pendingFrameNumbers( maxPendingFrames )
+	, m_nextSlotToFill( 0 )
+	, m_nextSlotToRead( 0 )
+	, m_dropFramesWhenFull( false )
+	, m_isBatchingHandOffs( SysGetNumberOfHardwareThreads() == 1 )
+	, m_numFramesHeld( 0 )
+	, m_numFramesDropped( 0 )
+	, m_secondsBlockedInSubmit( 0.0 )
+	, m_freeSlots( maxPendingFrames )
+	, m_filledSlots( 0 )
+	, m_writerThread( NULL )
+	, m_rasterizer( width, height, viewBounds )
+	, m_format( FRAME_IMAGE_PPM )
+	, m_numFramesWritten( 0 )
+	, m_numWriteFailures( 0 )
+{
+	CalcPngCrc( NULL, 0 ); // builds the table here, not racily on the writer thread
+}
+
+
+//-----------------------------------------------------------------------------------------------
+FrameSequenceWriter::~FrameSequenceWriter()
+{
+	Finish();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameSequenceWriter::Start( const std::string& filePathPrefix, FrameImageFormat format )
+{
+	Finish();
+	m_filePathPrefix = filePathPrefix;
+	m_format = format;
+	m_numFramesWritten = 0;
+	m_numWriteFailures = 0;
+	m_numFramesDropped = 0;
+	m_secondsBlockedInSubmit = 0.0;
+	m_nextSlotToRead = m_nextSlotToFill;
+	m_writerThread = SysCreateThread( WriterThreadEntry, this );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Copies the commands (a few KB per frame), so the caller can clear and reuse its buffer at once.
+//	Layers are copied inline, since they may be re-recorded before the writer gets to this frame.
+//
+bool FrameSequenceWriter::SubmitFrame( const RenderCommandBuffer& commands, int frameNumber )
+{
+	if( !m_writerThread )
+		return false;
+
+	if( !m_freeSlots.TryWait() )
+	{
+		HandOffHeldFrames();
+		if( m_dropFramesWhenFull )
+		{
+			++ m_numFramesDropped;
+			return false;
+		}
+
+		const double timeAtWaitStart = Clock::GetAbsoluteTimeSeconds();
+		m_freeSlots.Wait();
+		m_secondsBlockedInSubmit += Clock::GetAbsoluteTimeSeconds() - timeAtWaitStart;
+	}
+
+	m_pendingCommands[ m_nextSlotToFill ].AssignFlattened( commands );
+	m_pendingFrameNumbers[ m_nextSlotToFill ] = frameNumber;
+	m_nextSlotToFill = (m_nextSlotToFill + 1) % GetMaxPendingFrames();
+	if( m_isBatchingHandOffs )
+		++ m_numFramesHeld;
+	else
+		m_filledSlots.Release();
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameSequenceWriter::HandOffHeldFrames()
+{
+	if( m_numFramesHeld == 0 )
+		return;
+
+	m_filledSlots.Release( m_numFramesHeld );
+	m_numFramesHeld = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameSequenceWriter::Finish()
+{
+	if( !m_writerThread )
+		return;
+
+	HandOffHeldFrames();
+	m_freeSlots.Wait();
+	m_pendingCommands[ m_nextSlotToFill ].Clear();
+	m_pendingFrameNumbers[ m_nextSlotToFill ] = -1;
+	m_nextSlotToFill = (m_nextSlotToFill + 1) % GetMaxPendingFrames();
+	m_filledSlots.Release();
+
+	SysJoinThread( m_writerThread );
+	m_writerThread = NULL;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void FrameSequenceWriter::WriterThreadEntry( void* frameSequenceWriter )
+{
+	( (FrameSequenceWriter*) frameSequenceWriter )->RunWriterLoop();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameSequenceWriter::RunWriterLoop()
+{
+	SysLowerCurrentThreadPriority();
+	for( ;; )
+	{
+		m_filledSlots.Wait();
+		const int frameNumber = m_pendingFrameNumbers[ m_nextSlotToRead ];
+		if( frameNumber < 0 )
+		{
+			m_nextSlotToRead = (m_nextSlotToRead + 1) % GetMaxPendingFrames();
+			m_freeSlots.Release();
+			return;
+		}
+
+		m_rasterizer.Execute( m_pendingCommands[ m_nextSlotToRead ] );
+		m_nextSlotToRead = (m_nextSlotToRead + 1) % GetMaxPendingFrames();
+		m_freeSlots.Release(); // the slot's commands are no longer needed once rasterized
+
+		EncodeFrame( m_rasterizer.GetPixels() );
+		const JazzPath filePath = Stringf( "%s%06d.%s", m_filePathPrefix.c_str(), frameNumber, FRAME_IMAGE_FORMAT_EXTENSIONS[ m_format ] );
+		const int numBytesWritten = WriteBufferToBinaryFile( filePath, &m_encodedFrame[ 0 ], (int) m_encodedFrame.size() );
+		if( numBytesWritten == (int) m_encodedFrame.size() )
+		{
+			AtomicIncrement( m_numFramesWritten );
+		}
+		else
+		{
+			AtomicIncrement( m_numWriteFailures );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Encodes the rasterizer's RGBA pixels as 8-bit RGB in m_format (alpha is dropped).
+//
+void FrameSequenceWriter::EncodeFrame( const unsigned char* rgbaPixels )
+{
+	const int width = m_rasterizer.GetWidth();
+	const int height = m_rasterizer.GetHeight();
+	m_encodedFrame.clear();
+
+	if( m_format == FRAME_IMAGE_PPM )
+	{
+		const std::string header = Stringf( "P6\n%d %d\n255\n", width, height );
+		AppendBytes( m_encodedFrame, header.data(), header.size() );
+		const size_t pixelsStart = m_encodedFrame.size();
+		m_encodedFrame.resize( pixelsStart + (3 * width * height) );
+		unsigned char* rgb = &m_encodedFrame[ pixelsStart ];
+		for( int pixelIndex = 0; pixelIndex < width * height; ++ pixelIndex, rgb += 3 )
+		{
+			memcpy( rgb, &rgbaPixels[ 4 * pixelIndex ], 3 );
+		}
+
+		return;
+	}
+
+	// PNG: each scanline is a filter-type byte (0 = none) followed by RGB
+	static const unsigned char PNG_SIGNATURE[ 8 ] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	AppendBytes( m_encodedFrame, PNG_SIGNATURE, sizeof( PNG_SIGNATURE ) );
+
+	std::vector< unsigned char > chunkData;
+	AppendBigEndian32( chunkData, (unsigned int) width );
+	AppendBigEndian32( chunkData, (unsigned int) height );
+	const unsigned char bitDepthColorTypeAndMethods[ 5 ] = { 8, 2, 0, 0, 0 };
+	AppendBytes( chunkData, bitDepthColorTypeAndMethods, sizeof( bitDepthColorTypeAndMethods ) );
+	AppendPngChunk( m_encodedFrame, "IHDR", chunkData );
+
+	std::vector< unsigned char > scanlines( height * (1 + (3 * width)) );
+	unsigned char* scanlineByte = &scanlines[ 0 ];
+	for( int pixelIndex = 0; pixelIndex < width * height; ++ pixelIndex, scanlineByte += 3 )
+	{
+		if( pixelIndex % width == 0 )
+		{
+			*scanlineByte = 0;
+			++ scanlineByte;
+		}
+
+		memcpy( scanlineByte, &rgbaPixels[ 4 * pixelIndex ], 3 );
+	}
+
+	// zlib stream: header, stored deflate blocks, Adler-32 of the uncompressed data
+	chunkData.clear();
+	chunkData.reserve( scanlines.size() + (5 * (scanlines.size() / MAX_STORED_DEFLATE_BLOCK_BYTES + 1)) + 6 );
+	chunkData.push_back( 0x78 );
+	chunkData.push_back( 0x01 );
+	size_t blockStart = 0;
+	do
+	{
+		const size_t blockSize = MinInt( (int) (scanlines.size() - blockStart), (int) MAX_STORED_DEFLATE_BLOCK_BYTES );
+		const bool isFinalBlock = blockStart + blockSize == scanlines.size();
+		chunkData.push_back( isFinalBlock ? 1 : 0 );
+		chunkData.push_back( (unsigned char)( blockSize & 0xFF ) );
+		chunkData.push_back( (unsigned char)( blockSize >> 8 ) );
+		chunkData.push_back( (unsigned char)( ~blockSize & 0xFF ) );
+		chunkData.push_back( (unsigned char)( (~blockSize >> 8) & 0xFF ) );
+		AppendBytes( chunkData, &scanlines[ blockStart ], blockSize );
+		blockStart += blockSize;
+	}
+	while( blockStart < scanlines.size() );
+
+	unsigned int adlerLow = 1;
+	unsigned int adlerHigh = 0;
+	for( size_t runStart = 0; runStart < scanlines.size(); runStart += ADLER_BYTES_BETWEEN_MODULOS )
+	{
+		const size_t runEnd = MinInt( (int) (runStart + ADLER_BYTES_BETWEEN_MODULOS), (int) scanlines.size() );
+		for( size_t byteIndex = runStart; byteIndex < runEnd; ++ byteIndex )
+		{
+			adlerLow += scanlines[ byteIndex ];
+			adlerHigh += adlerLow;
+		}
+
+		adlerLow %= 65521;
+		adlerHigh %= 65521;
+	}
+
+	AppendBigEndian32( chunkData, (adlerHigh << 16) | adlerLow );
+	AppendPngChunk( m_encodedFrame, "IDAT", chunkData );
+
+	chunkData.clear();
+	AppendPngChunk( m_encodedFrame, "IEND", chunkData );
+}
@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------------------------
+// FrameCapture.hpp
+//
+// Offline image-sequence capture: frames are handed over as render command buffers, and a
+//	writer thread rasterizes them with the software backend, encodes them and writes the files,
+//	so the simulation thread only pays for recording and copying the commands.  The writer runs
+//	at lowered priority, so on a busy machine it falls behind (and catches up in Finish) rather
+//	than slowing the simulation; the queue is deep enough to ride that out for typical runs.
+//	With a single hardware thread, the writer couldn't run alongside the submitter anyway, so
+//	frames are handed over in batches (when the queue fills, and in Finish) rather than waking
+//	it for each one.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_FrameCapture__
+#define __include_FrameCapture__
+#pragma once
+#include "SoftwareRasterizer.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const unsigned int DEFAULT_MAX_PENDING_CAPTURE_FRAMES = 256; // a few KB of commands each
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+enum FrameImageFormat
+{
+	FRAME_IMAGE_PPM,
+	FRAME_IMAGE_PNG, // uncompressed (stored) deflate blocks; no zlib needed
+	NUM_FRAME_IMAGE_FORMATS
+};
+
+extern const char* FRAME_IMAGE_FORMAT_EXTENSIONS[ NUM_FRAME_IMAGE_FORMATS ];
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Frames are written in submission order as <filePathPrefix><frameNumber, 6 digits>.<ext>.
+//	Only one thread may call SubmitFrame.  When <maxPendingFrames> are already queued,
+//	SubmitFrame either waits for the writer or, if dropping, skips the frame.
+//
+class FrameSequenceWriter
+{
+public:
+	FrameSequenceWriter( int width, int height, const AABB2& viewBounds, unsigned int maxPendingFrames = DEFAULT_MAX_PENDING_CAPTURE_FRAMES );
+	~FrameSequenceWriter();
+	void Start( const std::string& filePathPrefix, FrameImageFormat format );
+	void SetDropFramesWhenFull( bool dropFramesWhenFull ) { m_dropFramesWhenFull = dropFramesWhenFull; }
+	bool SubmitFrame( const RenderCommandBuffer& commands, int frameNumber ); // false if the frame was dropped
+	void Finish(); // writes everything still queued, then stops the writer thread
+	bool IsRunning() const { return m_writerThread != NULL; }
+	unsigned int GetMaxPendingFrames() const { return (unsigned int) m_pendingFrameNumbers.size(); }
+	unsigned int GetNumFramesWritten() const { return (unsigned int) m_numFramesWritten; }
+	unsigned int GetNumWriteFailures() const { return (unsigned int) m_numWriteFailures; }
+	unsigned int GetNumFramesDropped() const { return m_numFramesDropped; }
+	double GetSecondsBlockedInSubmit() const { return m_secondsBlockedInSubmit; } // time the submitting thread spent waiting for the writer
+
+private:
+	FrameSequenceWriter( const FrameSequenceWriter& ); // not copyable
+	void operator = ( const FrameSequenceWriter& );
+	static void WriterThreadEntry( void* frameSequenceWriter );
+	void RunWriterLoop();
+	void EncodeFrame( const unsigned char* rgbaPixels );
+	void HandOffHeldFrames();
+
+private:
+	// Queued frames; a slot with a negative frame number tells the writer thread to stop
+	std::vector< RenderCommandBuffer > m_pendingCommands;
+	std::vector< int > m_pendingFrameNumbers;
+	unsigned int m_nextSlotToFill;
+	unsigned int m_nextSlotToRead; // only touched by the writer thread once started
+	bool m_dropFramesWhenFull;
+	bool m_isBatchingHandOffs;
+	unsigned int m_numFramesHeld; // queued, but not yet handed over to the writer thread
+	unsigned int m_numFramesDropped;
+	double m_secondsBlockedInSubmit;
+	Semaphore m_freeSlots;
+	Semaphore m_filledSlots;
+	ThreadHandle m_writerThread;
+
+	// Owned by the writer thread while it runs
+	SoftwareRenderBackend m_rasterizer;
+	std::vector< unsigned char > m_encodedFrame;
+	std::string m_filePathPrefix;
+	FrameImageFormat m_format;
+	volatile long m_numFramesWritten;
+	volatile long m_numWriteFailures;
+};
+
+
+#endif // __include_FrameCapture__
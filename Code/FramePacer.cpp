@@ -0,0 +1,190 @@
+//-----------------------------------------------------------------------------------------------
+// FramePacer.cpp
+//-----------------------------------------------------------------------------------------------
+#include "FramePacer.hpp"
+#include "Clock.hpp"
+#include "Threading.hpp"
+#include <math.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const double FRAME_PACER_INITIAL_SLEEP_OVERSHOOT_SECONDS = 0.002; // assumed until a few sleeps have been measured
+const unsigned int FRAME_PACER_MIN_SLEEP_SAMPLES = 8;
+
+
+//-----------------------------------------------------------------------------------------------
+void RunningStatistics::AddSample( double sample )
+{
+	++ m_numSamples;
+	const double deviationFromOldMean = sample - m_mean;
+	m_mean += deviationFromOldMean / (double) m_numSamples;
+	m_sumOfSquaredDeviations += deviationFromOldMean * (sample - m_mean);
+	if( m_numSamples == 1 || sample > m_max )
+	{
+		m_max = sample;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+double RunningStatistics::GetStandardDeviation() const
+{
+	return sqrt( GetVariance() );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+FramePacer::FramePacer()
+	: m_targetFrameSeconds( 0.0 )
+	, m_isUncapped( true )
+	, m_nextPresentDeadlineSeconds( 0.0 )
+	, m_frameBeginSeconds( 0.0 )
+	, m_lastPresentSeconds( 0.0 )
+	, m_lastFrameSeconds( 0.0 )
+	, m_statisticsResetSeconds( 0.0 )
+	, m_numMissedDeadlines( 0 )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::SetTargetFrameRate( double framesPerSecond )
+{
+	m_targetFrameSeconds = framesPerSecond > 0.0 ? 1.0 / framesPerSecond : 0.0;
+	SetUncapped( framesPerSecond <= 0.0 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Uncapped, WaitForPresent returns immediately (statistics are still kept), for benchmarking.
+//
+void FramePacer::SetUncapped( bool isUncapped )
+{
+	m_isUncapped = isUncapped || m_targetFrameSeconds <= 0.0;
+	m_nextPresentDeadlineSeconds = 0.0;
+	ResetStatistics();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::BeginFrame()
+{
+	m_frameBeginSeconds = Clock::GetAbsoluteTimeSeconds();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::WaitForPresent()
+{
+	if( m_isUncapped )
+		return;
+
+	const double timeNow = Clock::GetAbsoluteTimeSeconds();
+	if( m_nextPresentDeadlineSeconds == 0.0 || timeNow > m_nextPresentDeadlineSeconds + m_targetFrameSeconds )
+	{
+		// First frame, or so far behind that keeping to the old schedule would mean a burst of short frames
+		if( m_nextPresentDeadlineSeconds != 0.0 )
+		{
+			++ m_numMissedDeadlines;
+		}
+
+		m_nextPresentDeadlineSeconds = timeNow + m_targetFrameSeconds;
+		return;
+	}
+
+	if( timeNow > m_nextPresentDeadlineSeconds )
+	{
+		++ m_numMissedDeadlines;
+	}
+	else
+	{
+		WaitUntil( m_nextPresentDeadlineSeconds );
+	}
+
+	m_nextPresentDeadlineSeconds += m_targetFrameSeconds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FramePacer::EndPresent()
+{
+	const double timeNow = Clock::GetAbsoluteTimeSeconds();
+	m_lastFrameSeconds = m_lastPresentSeconds > 0.0 ? timeNow - m_lastPresentSeconds : 0.0;
+	if( m_lastFrameSeconds > 0.0 )
+	{
+		m_frameSeconds.AddSample( m_lastFrameSeconds );
+	}
+
+	m_presentLatencySeconds.AddSample( timeNow - m_frameBeginSeconds );
+	m_lastPresentSeconds = timeNow;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+double FramePacer::GetSecondsSinceStatisticsReset() const
+{
+	return Clock::GetAbsoluteTimeSeconds() - m_statisticsResetSeconds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+std::string FramePacer::GetStatisticsAsString() const
+{
+	const double meanFrameSeconds = m_frameSeconds.GetMean();
+	const std::string targetText = m_isUncapped ? std::string( "uncapped" ) : Stringf( "target %.2fms", 1000.0 * m_targetFrameSeconds );
+	return Stringf( "%s, %u frames at %.1f fps: frame %.2fms (jitter %.3fms, max %.2fms), present latency %.2fms (max %.2fms), %u missed deadlines",
+		targetText.c_str(), m_frameSeconds.GetNumSamples(), meanFrameSeconds > 0.0 ? 1.0 / meanFrameSeconds : 0.0,
+		1000.0 * meanFrameSeconds, 1000.0 * m_frameSeconds.GetStandardDeviation(), 1000.0 * m_frameSeconds.GetMax(),
+		1000.0 * m_presentLatencySeconds.GetMean(), 1000.0 * m_presentLatencySeconds.GetMax(), m_numMissedDeadlines );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Keeps the last present time, so the frame spanning the reset is still counted.
+//
+void FramePacer::ResetStatistics()
+{
+	m_frameSeconds.Reset();
+	m_presentLatencySeconds.Reset();
+	m_numMissedDeadlines = 0;
+	m_statisticsResetSeconds = Clock::GetAbsoluteTimeSeconds();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// How long before the deadline to stop sleeping: the typical oversleep plus two standard
+//	deviations, as measured on this machine (a coarse OS timer makes this large, and the wait
+//	spins more).
+//
+double FramePacer::CalcSleepMarginSeconds() const
+{
+	if( m_sleepOvershootSeconds.GetNumSamples() < FRAME_PACER_MIN_SLEEP_SAMPLES )
+		return m_sleepOvershootSeconds.GetMax() > FRAME_PACER_INITIAL_SLEEP_OVERSHOOT_SECONDS ? m_sleepOvershootSeconds.GetMax() : FRAME_PACER_INITIAL_SLEEP_OVERSHOOT_SECONDS;
+
+	return m_sleepOvershootSeconds.GetMean() + (2.0 * m_sleepOvershootSeconds.GetStandardDeviation());
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// One sleep for all but the margin, rather than a run of short ones, since every sleep is
+//	another chance for the scheduler to hand the core elsewhere for a long while.
+//
+void FramePacer::WaitUntil( double deadlineSeconds )
+{
+	double timeNow = Clock::GetAbsoluteTimeSeconds();
+	const double secondsToSleep = deadlineSeconds - timeNow - CalcSleepMarginSeconds();
+	if( secondsToSleep > 0.0 )
+	{
+		SysSleepSeconds( secondsToSleep );
+		const double timeAfterSleep = Clock::GetAbsoluteTimeSeconds();
+		m_sleepOvershootSeconds.AddSample( (timeAfterSleep - timeNow) - secondsToSleep );
+		timeNow = timeAfterSleep;
+	}
+
+	while( timeNow < deadlineSeconds )
+	{
+		timeNow = Clock::GetAbsoluteTimeSeconds();
+	}
+}
@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------------------------------
+// FramePacer.hpp
+//
+// Holds each frame's present back to a target frame time, sleeping while the deadline is far
+//	off and spinning on Clock for the last stretch (the OS sleep is only as precise as its timer,
+//	which can be anywhere from a fraction of a millisecond to 15ms), and keeps frame-time, jitter
+//	and present-latency statistics for the profiling output.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_FramePacer__
+#define __include_FramePacer__
+#pragma once
+#include "Utilities.hpp"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Mean, variance and max of a stream of samples, without keeping them (Welford's method).
+//
+class RunningStatistics
+{
+public:
+	RunningStatistics() { Reset(); }
+	void Reset() { m_numSamples = 0; m_mean = 0.0; m_sumOfSquaredDeviations = 0.0; m_max = 0.0; }
+	void AddSample( double sample );
+	unsigned int GetNumSamples() const { return m_numSamples; }
+	double GetMean() const { return m_mean; }
+	double GetVariance() const { return m_numSamples > 1 ? m_sumOfSquaredDeviations / (double)( m_numSamples - 1 ) : 0.0; }
+	double GetStandardDeviation() const;
+	double GetMax() const { return m_max; }
+
+private:
+	unsigned int m_numSamples;
+	double m_mean;
+	double m_sumOfSquaredDeviations;
+	double m_max;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Call BeginFrame as the frame starts, WaitForPresent just before presenting it, and
+//	EndPresent once the present returns.  Deadlines advance by exactly one target frame time, so
+//	a frame that presents slightly late doesn't push every later frame back; one that's more
+//	than a whole frame late resynchronizes instead of rushing to catch up.
+//
+class FramePacer
+{
+public:
+	FramePacer();
+	void SetTargetFrameRate( double framesPerSecond ); // zero or less runs uncapped
+	void SetUncapped( bool isUncapped );
+	bool IsUncapped() const { return m_isUncapped; }
+	double GetTargetFrameSeconds() const { return m_targetFrameSeconds; }
+	double GetLastFrameSeconds() const { return m_lastFrameSeconds; } // present to present; zero before the second present
+
+	void BeginFrame();
+	void WaitForPresent();
+	void EndPresent();
+
+	// Since the last ResetStatistics
+	const RunningStatistics& GetFrameSeconds() const { return m_frameSeconds; } // present to present; its standard deviation is the jitter
+	const RunningStatistics& GetPresentLatencySeconds() const { return m_presentLatencySeconds; } // BeginFrame to the end of the present
+	unsigned int GetNumMissedDeadlines() const { return m_numMissedDeadlines; }
+	double GetSecondsSinceStatisticsReset() const;
+	std::string GetStatisticsAsString() const;
+	void ResetStatistics();
+
+private:
+	double CalcSleepMarginSeconds() const;
+	void WaitUntil( double deadlineSeconds );
+
+private:
+	double m_targetFrameSeconds;
+	bool m_isUncapped;
+	double m_nextPresentDeadlineSeconds; // zero when there's no deadline to keep to (first frame, or uncapped)
+	double m_frameBeginSeconds;
+	double m_lastPresentSeconds;
+	double m_lastFrameSeconds;
+	double m_statisticsResetSeconds;
+	RunningStatistics m_frameSeconds;
+	RunningStatistics m_presentLatencySeconds;
+	RunningStatistics m_sleepOvershootSeconds; // how much longer than asked the OS sleeps; never reset
+	unsigned int m_numMissedDeadlines;
+};
+
+
+#endif // __include_FramePacer__
@@ -0,0 +1,335 @@
+//-----------------------------------------------------------------------------------------------
+// FrameStatistics.cpp
+//-----------------------------------------------------------------------------------------------
+#include "FrameStatistics.hpp"
+#include "Graphics.hpp"
+#include <algorithm>
+#include <math.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const char* FRAME_TIME_CHANNEL_NAMES[ NUM_FRAME_TIME_CHANNELS ] = { "frame", "simulation", "render" };
+const int HDR_HISTOGRAM_SUB_BUCKET_BITS = 5; // log2( HDR_HISTOGRAM_SUB_BUCKETS )
+const int HDR_HISTOGRAM_NUM_BUCKETS = (2 * HDR_HISTOGRAM_SUB_BUCKETS) + ((HDR_HISTOGRAM_MAX_VALUE_BITS - HDR_HISTOGRAM_SUB_BUCKET_BITS - 1) * HDR_HISTOGRAM_SUB_BUCKETS);
+const double FRAME_STATISTICS_OVERLAY_BUDGETS_SHOWN = 2.0; // the graph is this many frame budgets tall, unless a recent frame needs more
+const float FRAME_STATISTICS_OVERLAY_LINE_THICKNESS = 1.f;
+
+
+//-----------------------------------------------------------------------------------------------
+HdrHistogram::HdrHistogram()
+	: m_bucketCounts( HDR_HISTOGRAM_NUM_BUCKETS, 0 )
+{
+	Reset();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void HdrHistogram::Reset()
+{
+	std::fill( m_bucketCounts.begin(), m_bucketCounts.end(), 0 );
+	m_numSamples = 0;
+	m_totalSeconds = 0.0;
+	m_maxSeconds = 0.0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void HdrHistogram::RecordSeconds( double seconds )
+{
+	if( seconds < 0.0 )
+	{
+		seconds = 0.0;
+	}
+
+	const double microseconds = (seconds * 1000000.0) + 0.5;
+	const unsigned int wholeMicroseconds = microseconds < 4294967295.0 ? (unsigned int) microseconds : 4294967295u;
+	++ m_bucketCounts[ CalcBucketIndex( wholeMicroseconds ) ];
+	++ m_numSamples;
+	m_totalSeconds += seconds;
+	if( seconds > m_maxSeconds )
+	{
+		m_maxSeconds = seconds;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The top of the bucket holding the <percentile>th-percentile sample (nearest rank), capped at
+//	the largest value actually recorded.
+//
+double HdrHistogram::GetSecondsAtPercentile( double percentile ) const
+{
+	if( m_numSamples == 0 )
+		return 0.0;
+
+	unsigned int rank = (unsigned int) ceil( 0.01 * percentile * (double) m_numSamples );
+	rank = rank < 1 ? 1 : (rank > m_numSamples ? m_numSamples : rank);
+	unsigned int numSamplesSoFar = 0;
+	for( int bucketIndex = 0; bucketIndex < HDR_HISTOGRAM_NUM_BUCKETS; ++ bucketIndex )
+	{
+		numSamplesSoFar += m_bucketCounts[ bucketIndex ];
+		if( numSamplesSoFar >= rank )
+		{
+			const double bucketHighestSeconds = 0.000001 * (double) GetBucketHighestMicroseconds( bucketIndex );
+			return bucketHighestSeconds < m_maxSeconds ? bucketHighestSeconds : m_maxSeconds;
+		}
+	}
+
+	return m_maxSeconds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC unsigned int HdrHistogram::GetBucketLowestMicroseconds( int bucketIndex )
+{
+	if( bucketIndex < 2 * HDR_HISTOGRAM_SUB_BUCKETS )
+		return (unsigned int) bucketIndex;
+
+	const int shift = ((bucketIndex - (2 * HDR_HISTOGRAM_SUB_BUCKETS)) / HDR_HISTOGRAM_SUB_BUCKETS) + 1;
+	const unsigned int subBucket = HDR_HISTOGRAM_SUB_BUCKETS + ((bucketIndex - (2 * HDR_HISTOGRAM_SUB_BUCKETS)) % HDR_HISTOGRAM_SUB_BUCKETS);
+	return subBucket << shift;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC unsigned int HdrHistogram::GetBucketHighestMicroseconds( int bucketIndex )
+{
+	if( bucketIndex < 2 * HDR_HISTOGRAM_SUB_BUCKETS )
+		return (unsigned int) bucketIndex;
+
+	const int shift = ((bucketIndex - (2 * HDR_HISTOGRAM_SUB_BUCKETS)) / HDR_HISTOGRAM_SUB_BUCKETS) + 1;
+	const unsigned int subBucket = HDR_HISTOGRAM_SUB_BUCKETS + ((bucketIndex - (2 * HDR_HISTOGRAM_SUB_BUCKETS)) % HDR_HISTOGRAM_SUB_BUCKETS);
+	return ((subBucket + 1) << shift) - 1; // wraps to the largest value for the last bucket
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Below 2 * HDR_HISTOGRAM_SUB_BUCKETS, one bucket per microsecond; above, each power of two is
+//	split into HDR_HISTOGRAM_SUB_BUCKETS equal buckets.
+//
+STATIC int HdrHistogram::CalcBucketIndex( unsigned int microseconds )
+{
+	if( microseconds < 2 * HDR_HISTOGRAM_SUB_BUCKETS )
+		return (int) microseconds;
+
+	int highestBit = 0;
+	for( unsigned int remainingBits = microseconds >> 1; remainingBits != 0; remainingBits >>= 1 )
+	{
+		++ highestBit;
+	}
+
+	const int shift = highestBit - HDR_HISTOGRAM_SUB_BUCKET_BITS;
+	const int subBucket = (int)( microseconds >> shift );
+	return (2 * HDR_HISTOGRAM_SUB_BUCKETS) + ((shift - 1) * HDR_HISTOGRAM_SUB_BUCKETS) + (subBucket - HDR_HISTOGRAM_SUB_BUCKETS);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+FrameStatistics::FrameStatistics()
+{
+	for( int channel = 0; channel < NUM_FRAME_TIME_CHANNELS; ++ channel )
+	{
+		m_recentSeconds[ channel ].resize( FRAME_STATISTICS_RECENT_FRAMES, 0.f );
+	}
+
+	Reset();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameStatistics::Reset()
+{
+	for( int channel = 0; channel < NUM_FRAME_TIME_CHANNELS; ++ channel )
+	{
+		m_histograms[ channel ].Reset();
+	}
+
+	m_nextRecentIndex = 0;
+	m_numRecentFrames = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void FrameStatistics::RecordFrame( double frameSeconds, double simulationSeconds, double renderSeconds )
+{
+	const double secondsPerChannel[ NUM_FRAME_TIME_CHANNELS ] = { frameSeconds, simulationSeconds, renderSeconds };
+	for( int channel = 0; channel < NUM_FRAME_TIME_CHANNELS; ++ channel )
+	{
+		m_recentSeconds[ channel ][ m_nextRecentIndex ] = (float) secondsPerChannel[ channel ];
+		m_histograms[ channel ].RecordSeconds( secondsPerChannel[ channel ] );
+	}
+
+	m_nextRecentIndex = (m_nextRecentIndex + 1) % FRAME_STATISTICS_RECENT_FRAMES;
+	if( m_numRecentFrames < FRAME_STATISTICS_RECENT_FRAMES )
+	{
+		++ m_numRecentFrames;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+double FrameStatistics::GetRecentSeconds( FrameTimeChannel channel, unsigned int framesAgo ) const
+{
+	if( framesAgo >= m_numRecentFrames )
+		return 0.0;
+
+	const unsigned int recentIndex = (m_nextRecentIndex + FRAME_STATISTICS_RECENT_FRAMES - 1 - framesAgo) % FRAME_STATISTICS_RECENT_FRAMES;
+	return (double) m_recentSeconds[ channel ][ recentIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Nearest-rank percentiles over a sorted copy of the recent frames.
+//
+FrameTimeSummary FrameStatistics::CalcRecentSummary( FrameTimeChannel channel ) const
+{
+	FrameTimeSummary summary;
+	summary.m_numSamples = m_numRecentFrames;
+	if( m_numRecentFrames == 0 )
+		return summary;
+
+	const std::vector< float >& recentSeconds = m_recentSeconds[ channel ];
+	m_sortedSeconds.assign( recentSeconds.begin(), recentSeconds.begin() + m_numRecentFrames );
+	std::sort( m_sortedSeconds.begin(), m_sortedSeconds.end() );
+	double totalSeconds = 0.0;
+	for( unsigned int frameIndex = 0; frameIndex < m_numRecentFrames; ++ frameIndex )
+	{
+		totalSeconds += (double) m_sortedSeconds[ frameIndex ];
+	}
+
+	const double numFrames = (double) m_numRecentFrames;
+	summary.m_meanSeconds = totalSeconds / numFrames;
+	summary.m_p50Seconds = m_sortedSeconds[ (unsigned int) ceil( 0.50 * numFrames ) - 1 ];
+	summary.m_p95Seconds = m_sortedSeconds[ (unsigned int) ceil( 0.95 * numFrames ) - 1 ];
+	summary.m_p99Seconds = m_sortedSeconds[ (unsigned int) ceil( 0.99 * numFrames ) - 1 ];
+	summary.m_maxSeconds = m_sortedSeconds.back();
+	return summary;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+FrameTimeSummary FrameStatistics::CalcTotalSummary( FrameTimeChannel channel ) const
+{
+	const HdrHistogram& histogram = m_histograms[ channel ];
+	FrameTimeSummary summary;
+	summary.m_numSamples = histogram.GetNumSamples();
+	summary.m_meanSeconds = histogram.GetMeanSeconds();
+	summary.m_p50Seconds = histogram.GetSecondsAtPercentile( 50.0 );
+	summary.m_p95Seconds = histogram.GetSecondsAtPercentile( 95.0 );
+	summary.m_p99Seconds = histogram.GetSecondsAtPercentile( 99.0 );
+	summary.m_maxSeconds = histogram.GetMaxSeconds();
+	return summary;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+std::string FrameStatistics::GetRecentSummaryAsString() const
+{
+	std::string summaryText = Stringf( "%u frames:", m_numRecentFrames );
+	for( int channel = 0; channel < NUM_FRAME_TIME_CHANNELS; ++ channel )
+	{
+		const FrameTimeSummary summary = CalcRecentSummary( (FrameTimeChannel) channel );
+		summaryText += Stringf( "%s %s p50 %.2fms p95 %.2fms p99 %.2fms max %.2fms", channel == 0 ? "" : ";", FRAME_TIME_CHANNEL_NAMES[ channel ],
+			1000.0 * summary.m_p50Seconds, 1000.0 * summary.m_p95Seconds, 1000.0 * summary.m_p99Seconds, 1000.0 * summary.m_maxSeconds );
+	}
+
+	return summaryText;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static std::string GetSummaryAsJson( const FrameTimeSummary& summary )
+{
+	return Stringf( "{ \"count\": %u, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f }",
+		summary.m_numSamples, 1000.0 * summary.m_meanSeconds, 1000.0 * summary.m_p50Seconds, 1000.0 * summary.m_p95Seconds,
+		1000.0 * summary.m_p99Seconds, 1000.0 * summary.m_maxSeconds );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Per channel: the whole-run summary, the recent-frames summary, and the histogram's non-empty
+//	buckets as [ lowest_us, highest_us, count ].
+//
+std::string FrameStatistics::GetAsJson() const
+{
+	std::string json = Stringf( "{\n\t\"frames\": %u,\n\t\"recent_frames\": %u,\n\t\"channels\": {\n", GetNumFramesRecorded(), m_numRecentFrames );
+	for( int channel = 0; channel < NUM_FRAME_TIME_CHANNELS; ++ channel )
+	{
+		json += Stringf( "\t\t\"%s\": {\n\t\t\t\"total\": %s,\n\t\t\t\"recent\": %s,\n\t\t\t\"histogram_us\": [", FRAME_TIME_CHANNEL_NAMES[ channel ],
+			GetSummaryAsJson( CalcTotalSummary( (FrameTimeChannel) channel ) ).c_str(), GetSummaryAsJson( CalcRecentSummary( (FrameTimeChannel) channel ) ).c_str() );
+
+		const HdrHistogram& histogram = m_histograms[ channel ];
+		bool isFirstBucket = true;
+		for( int bucketIndex = 0; bucketIndex < histogram.GetNumBuckets(); ++ bucketIndex )
+		{
+			if( histogram.GetBucketCount( bucketIndex ) == 0 )
+				continue;
+
+			json += Stringf( "%s[ %u, %u, %u ]", isFirstBucket ? " " : ", ", HdrHistogram::GetBucketLowestMicroseconds( bucketIndex ),
+				HdrHistogram::GetBucketHighestMicroseconds( bucketIndex ), histogram.GetBucketCount( bucketIndex ) );
+			isFirstBucket = false;
+		}
+
+		json += Stringf( " ]\n\t\t}%s\n", channel + 1 < NUM_FRAME_TIME_CHANNELS ? "," : "" );
+	}
+
+	json += "\t}\n}\n";
+	return json;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool FrameStatistics::WriteJsonFile( const JazzPath& filePath ) const
+{
+	const std::string json = GetAsJson();
+	return WriteBufferToBinaryFile( filePath, (const unsigned char*) json.data(), (int) json.size() ) == (int) json.size();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// One bar per recent frame, newest at the right: simulation (blue) under render (orange) under
+//	the rest of the frame (grey).  Lines mark the budget (green) and the recent p50 (white), p95
+//	(yellow) and p99 (red) frame times.
+//
+void FrameStatistics::DrawOverlay( const AABB2& bounds, double frameBudgetSeconds ) const
+{
+	DrawFilledArea( bounds, Rgba::BLACK, 0.5f );
+	if( m_numRecentFrames == 0 )
+		return;
+
+	const FrameTimeSummary summary = CalcRecentSummary( FRAME_TIME_FRAME );
+	double graphSeconds = FRAME_STATISTICS_OVERLAY_BUDGETS_SHOWN * frameBudgetSeconds;
+	if( summary.m_maxSeconds > graphSeconds )
+	{
+		graphSeconds = summary.m_maxSeconds;
+	}
+
+	if( graphSeconds <= 0.0 )
+		return;
+
+	const float graphHeight = bounds.maxs.y - bounds.mins.y;
+	const float unitsPerSecond = (float)( graphHeight / graphSeconds );
+	const unsigned int maxBars = (unsigned int)( bounds.maxs.x - bounds.mins.x );
+	const unsigned int numBars = m_numRecentFrames < maxBars ? m_numRecentFrames : maxBars;
+	for( unsigned int framesAgo = 0; framesAgo < numBars; ++ framesAgo )
+	{
+		// The view's y axis points down, so bars grow up from the bottom edge
+		const float barRight = bounds.maxs.x - (float) framesAgo;
+		const float simulationHeight = ClampFloat( unitsPerSecond * (float) GetRecentSeconds( FRAME_TIME_SIMULATION, framesAgo ), 0.f, graphHeight );
+		const float renderTop = ClampFloat( simulationHeight + (unitsPerSecond * (float) GetRecentSeconds( FRAME_TIME_RENDER, framesAgo )), 0.f, graphHeight );
+		const float frameTop = ClampFloat( unitsPerSecond * (float) GetRecentSeconds( FRAME_TIME_FRAME, framesAgo ), renderTop, graphHeight );
+		DrawFilledArea( AABB2( barRight - 1.f, bounds.maxs.y - simulationHeight, barRight, bounds.maxs.y ), Rgba::BLUE );
+		DrawFilledArea( AABB2( barRight - 1.f, bounds.maxs.y - renderTop, barRight, bounds.maxs.y - simulationHeight ), Rgba::ORANGE );
+		DrawFilledArea( AABB2( barRight - 1.f, bounds.maxs.y - frameTop, barRight, bounds.maxs.y - renderTop ), Rgba::GREY );
+	}
+
+	const double markedSeconds[] = { frameBudgetSeconds, summary.m_p50Seconds, summary.m_p95Seconds, summary.m_p99Seconds };
+	const Rgba* markColors[] = { &Rgba::GREEN, &Rgba::WHITE, &Rgba::YELLOW, &Rgba::RED };
+	for( int markIndex = 0; markIndex < 4; ++ markIndex )
+	{
+		const float markY = bounds.maxs.y - ClampFloat( unitsPerSecond * (float) markedSeconds[ markIndex ], 0.f, graphHeight );
+		DrawFilledArea( AABB2( bounds.mins.x, markY - FRAME_STATISTICS_OVERLAY_LINE_THICKNESS, bounds.maxs.x, markY ), *markColors[ markIndex ] );
+	}
+}
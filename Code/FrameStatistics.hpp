@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------------------------
+// FrameStatistics.hpp
+//
+// Frame, simulation and render times per frame: the most recent frames are kept as-is (for
+//	exact percentiles and the on-screen graph), and every frame since the last reset goes into an
+//	HDR-style histogram (for whole-run percentiles in constant memory), which can be written out
+//	as JSON so runs can be compared.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_FrameStatistics__
+#define __include_FrameStatistics__
+#pragma once
+#include "AABB2.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const unsigned int FRAME_STATISTICS_RECENT_FRAMES = 1024;
+const int HDR_HISTOGRAM_SUB_BUCKETS = 32; // linear buckets per power of two, so any value is within ~3% of its bucket's bounds
+const int HDR_HISTOGRAM_MAX_VALUE_BITS = 32; // in microseconds; anything longer (over an hour) lands in the last bucket
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+enum FrameTimeChannel
+{
+	FRAME_TIME_FRAME, // start of one frame to the start of the next
+	FRAME_TIME_SIMULATION, // stepping the scenario (on the simulation thread, when it has one)
+	FRAME_TIME_RENDER, // recording and flushing draw commands
+	NUM_FRAME_TIME_CHANNELS
+};
+
+extern const char* FRAME_TIME_CHANNEL_NAMES[ NUM_FRAME_TIME_CHANNELS ];
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class FrameTimeSummary
+{
+public:
+	FrameTimeSummary() : m_numSamples( 0 ), m_meanSeconds( 0.0 ), m_p50Seconds( 0.0 ), m_p95Seconds( 0.0 ), m_p99Seconds( 0.0 ), m_maxSeconds( 0.0 ) {}
+
+	unsigned int m_numSamples;
+	double m_meanSeconds;
+	double m_p50Seconds;
+	double m_p95Seconds;
+	double m_p99Seconds;
+	double m_maxSeconds;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Counts of microsecond values in buckets that are exact below 2 * HDR_HISTOGRAM_SUB_BUCKETS and
+//	then grow with the value, so relative precision is the same from microseconds to minutes.
+//	Percentiles report the top of the bucket they fall in; the max is exact.
+//
+class HdrHistogram
+{
+public:
+	HdrHistogram();
+	void Reset();
+	void RecordSeconds( double seconds );
+	unsigned int GetNumSamples() const { return m_numSamples; }
+	double GetMeanSeconds() const { return m_numSamples > 0 ? m_totalSeconds / (double) m_numSamples : 0.0; }
+	double GetMaxSeconds() const { return m_maxSeconds; }
+	double GetSecondsAtPercentile( double percentile ) const;
+	int GetNumBuckets() const { return (int) m_bucketCounts.size(); }
+	unsigned int GetBucketCount( int bucketIndex ) const { return m_bucketCounts[ bucketIndex ]; }
+	static unsigned int GetBucketLowestMicroseconds( int bucketIndex );
+	static unsigned int GetBucketHighestMicroseconds( int bucketIndex );
+
+private:
+	static int CalcBucketIndex( unsigned int microseconds );
+
+private:
+	std::vector< unsigned int > m_bucketCounts;
+	unsigned int m_numSamples;
+	double m_totalSeconds;
+	double m_maxSeconds;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class FrameStatistics
+{
+public:
+	FrameStatistics();
+	void Reset();
+	void RecordFrame( double frameSeconds, double simulationSeconds, double renderSeconds );
+	unsigned int GetNumFramesRecorded() const { return m_histograms[ FRAME_TIME_FRAME ].GetNumSamples(); } // since Reset
+	unsigned int GetNumRecentFrames() const { return m_numRecentFrames; }
+	double GetRecentSeconds( FrameTimeChannel channel, unsigned int framesAgo ) const; // 0 is the latest frame
+	FrameTimeSummary CalcRecentSummary( FrameTimeChannel channel ) const; // exact, over the recent frames
+	FrameTimeSummary CalcTotalSummary( FrameTimeChannel channel ) const; // from the histogram, since Reset
+	const HdrHistogram& GetHistogram( FrameTimeChannel channel ) const { return m_histograms[ channel ]; }
+	std::string GetRecentSummaryAsString() const;
+	std::string GetAsJson() const;
+	bool WriteJsonFile( const JazzPath& filePath ) const;
+	void DrawOverlay( const AABB2& bounds, double frameBudgetSeconds ) const;
+
+private:
+	std::vector< float > m_recentSeconds[ NUM_FRAME_TIME_CHANNELS ]; // rings of FRAME_STATISTICS_RECENT_FRAMES
+	unsigned int m_nextRecentIndex;
+	unsigned int m_numRecentFrames;
+	HdrHistogram m_histograms[ NUM_FRAME_TIME_CHANNELS ];
+	mutable std::vector< float > m_sortedSeconds; // kept to reuse its storage
+};
+
+
+#endif // __include_FrameStatistics__
@@ -2,125 +2,657 @@
 // Graphics.cpp
 //-----------------------------------------------------------------------------------------------
 #include "Graphics.hpp"
+#include "ProfilingSection.hpp"
 
 
 //-----------------------------------------------------------------------------------------------
 // Globals
 //
-const int NUM_CIRCLE_SIDES = 40;
-const float LINE_WIDTH = 3.f;
-Vector2 g_circlePoints[ NUM_CIRCLE_SIDES ];
+const int NUM_CIRCLE_LODS = 5;
+const int CIRCLE_LOD_NUM_SIDES[ NUM_CIRCLE_LODS ] = { 6, 10, 16, 24, 40 }; // coarsest first
+const int MAX_CIRCLE_SIDES = 40;
+const float CIRCLE_MAX_EDGE_ERROR = 0.25f; // how far (in view units, ~pixels) a polygon edge may cut inside the true circle
+const int SHADOW_CIRCLE_LOD_INDEX = 1; // shadows not drawn as sprites are soft-edged, so a fixed coarse polygon does at any radius
+const unsigned int MAX_BATCH_VERTICES = 3 * 16384; // the GL backend submits early if a frame draws more than this
+const int SHADOW_SPRITE_SIZE = 64; // texels per side
+const float SHADOW_SPRITE_INNER_FRACTION_OF_OUTER = 1.f / 1.2f; // Actor::Draw's falloff, 0.2 of the radius
+const float SHADOW_SPRITE_MAX_FRACTION_ERROR = 0.01f; // shadows this close to the sprite's profile use it
+const short UNTEXTURED_SPRITE_COORDINATE = 1; // the sprite's center, which is opaque white
+const short SPRITE_MAX_COORDINATE = 2;
+Vector2 g_circleLodPoints[ NUM_CIRCLE_LODS ][ MAX_CIRCLE_SIDES ]; // unit circle, per LOD
+float g_circleLodMaxRadiusPerEdgeError[ NUM_CIRCLE_LODS ]; // largest radius each LOD may draw, per unit of allowed error
+
+
+//-----------------------------------------------------------------------------------------------
+// More globals
+//
+RenderCommandBuffer g_renderCommands;
+RenderCommandBuffer* g_recordingRenderCommands = &g_renderCommands; // a layer's commands while one is being recorded
+OpenGLRenderBackend g_openGLRenderBackend;
+NullRenderBackend g_nullRenderBackend;
+RenderBackend* g_renderBackend = NULL;
+AABB2 g_viewBounds( 0.f, 0.f, 1024.f, 576.f ); // TheGame::SetUpView's glOrtho
+unsigned int g_shadowSpriteTexture = 0;
+
+
+//-----------------------------------------------------------------------------------------------
+// White, with alpha 1 out to SHADOW_SPRITE_INNER_FRACTION_OF_OUTER of the sprite's half-width and
+//	falling linearly to 0 at its edge, as the software rasterizer fades shadow circles.  Batch
+//	vertices carry 16-bit texture coordinates (keeping them 16 bytes), so the texture matrix
+//	halves them: 0 and 2 are the sprite's edges and 1 its center.
+//
+static void CreateShadowSprite()
+{
+#if defined( JAZZ_USE_OPENGL )
+	std::vector< unsigned char > texels( 4 * SHADOW_SPRITE_SIZE * SHADOW_SPRITE_SIZE, 255 );
+	for( int texelY = 0; texelY < SHADOW_SPRITE_SIZE; ++ texelY )
+	{
+		for( int texelX = 0; texelX < SHADOW_SPRITE_SIZE; ++ texelX )
+		{
+			const float offsetX = ((2.f * ((float) texelX + 0.5f)) / (float) SHADOW_SPRITE_SIZE) - 1.f;
+			const float offsetY = ((2.f * ((float) texelY + 0.5f)) / (float) SHADOW_SPRITE_SIZE) - 1.f;
+			const float distance = sqrtf( (offsetX * offsetX) + (offsetY * offsetY) );
+			const float alphaScale = ClampFloat( (1.f - distance) / (1.f - SHADOW_SPRITE_INNER_FRACTION_OF_OUTER), 0.f, 1.f );
+			texels[ (4 * ((texelY * SHADOW_SPRITE_SIZE) + texelX)) + 3 ] = (unsigned char)( (255.f * alphaScale) + 0.5f );
+		}
+	}
+
+	GLuint texture = 0;
+	glGenTextures( 1, &texture );
+	glBindTexture( GL_TEXTURE_2D, texture );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, SHADOW_SPRITE_SIZE, SHADOW_SPRITE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, &texels[ 0 ] );
+	g_shadowSpriteTexture = texture;
+
+	glMatrixMode( GL_TEXTURE );
+	glLoadIdentity();
+	glScalef( 1.f / (float) SPRITE_MAX_COORDINATE, 1.f / (float) SPRITE_MAX_COORDINATE, 1.f );
+	glMatrixMode( GL_MODELVIEW );
+#endif
+}
 
 
 //-----------------------------------------------------------------------------------------------
 void InitGraphics()
 {
 	ComputeCirclePoints();
+	SetRenderBackend( NULL );
 
+#if defined( JAZZ_USE_OPENGL )
 	glEnable( GL_BLEND );
 	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 	glShadeModel( GL_SMOOTH );
+#endif
+	CreateShadowSprite();
 }
 
 
 //-----------------------------------------------------------------------------------------------
 void ComputeCirclePoints()
 {
-	for( int i = 0; i < NUM_CIRCLE_SIDES; ++ i )
+	for( int lodIndex = 0; lodIndex < NUM_CIRCLE_LODS; ++ lodIndex )
 	{
-		float degrees = 360.f * ((float) i / (float) NUM_CIRCLE_SIDES);
-		g_circlePoints[ i ].SetUnitLengthAndYawDegrees( degrees );
+		const int numSides = CIRCLE_LOD_NUM_SIDES[ lodIndex ];
+		for( int i = 0; i < numSides; ++ i )
+		{
+			float degrees = 360.f * ((float) i / (float) numSides);
+			g_circleLodPoints[ lodIndex ][ i ].SetUnitLengthAndYawDegrees( degrees );
+		}
+
+		// An edge's midpoint is r * cos( 180/numSides ) from the center, so it cuts r * (1 - cos) inside
+		const float edgeErrorPerUnitRadius = 1.f - cosf( fPI / (float) numSides );
+		g_circleLodMaxRadiusPerEdgeError[ lodIndex ] = 1.f / edgeErrorPerUnitRadius;
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The coarsest LOD whose edges stay within <maxEdgeError> of a circle of <radius>.
+//
+int SelectCircleLod( float radius, float maxEdgeError )
+{
+	for( int lodIndex = 0; lodIndex < NUM_CIRCLE_LODS - 1; ++ lodIndex )
+	{
+		if( radius <= maxEdgeError * g_circleLodMaxRadiusPerEdgeError[ lodIndex ] )
+			return lodIndex;
 	}
+
+	return NUM_CIRCLE_LODS - 1;
 }
 
 
 //-----------------------------------------------------------------------------------------------
+// NULL selects the platform default: OpenGL where available, otherwise the null backend.
+//
+void SetRenderBackend( RenderBackend* backend )
+{
+	if( !backend )
+	{
+#if defined( JAZZ_USE_OPENGL )
+		backend = &g_openGLRenderBackend;
+#else
+		backend = &g_nullRenderBackend;
+#endif
+	}
+
+	g_renderBackend = backend;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+RenderBackend& GetRenderBackend()
+{
+	if( !g_renderBackend )
+	{
+		SetRenderBackend( NULL );
+	}
+
+	return *g_renderBackend;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Only records what the view shows, for SimulationSnapshotRenderer::Render to cull draws against
+//	before it issues them; SetUpView still sets up the projection itself.
+//
+void SetViewBounds( const AABB2& viewBounds )
+{
+	g_viewBounds = viewBounds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+const AABB2& GetViewBounds()
+{
+	return g_viewBounds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+const RenderCommandBuffer& GetRenderCommands()
+{
+	return g_renderCommands;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Still immediate (sets the GL current color); the Draw* functions below carry their own colors.
+//
 void SetColor( const Rgba& color, float alpha )
+{
+#if defined( JAZZ_USE_OPENGL )
+	const Rgba colorWithAlphaApplied = CalcColorWithAlpha( color, alpha );
+	glColor4ub( colorWithAlphaApplied.r, colorWithAlphaApplied.g, colorWithAlphaApplied.b, colorWithAlphaApplied.a );
+#else
+	UNUSED( color );
+	UNUSED( alpha );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Replays everything recorded since the last flush through the current backend, then clears it.
+//
+void FlushGraphicsBatch()
+{
+	PROFILE_SECTION( "FlushGraphicsBatch" );
+	GetRenderBackend().Execute( g_renderCommands );
+	g_renderCommands.Clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Rgba CalcColorWithAlpha( const Rgba& color, float alpha )
 {
 	Rgba colorWithAlphaApplied = color;
 	colorWithAlphaApplied.ScaleAlpha( alpha );
-	glColor4ub( colorWithAlphaApplied.r, colorWithAlphaApplied.g, colorWithAlphaApplied.b, colorWithAlphaApplied.a );
+	return colorWithAlphaApplied;
 }
 
 
 //-----------------------------------------------------------------------------------------------
 void DrawFilledCircle( const Vector2& center, float radius, const Rgba& color, float alpha )
 {
-	SetColor( color, alpha );
-	glBegin( GL_TRIANGLE_FAN );
+	g_recordingRenderCommands->AddCircle( RENDER_COMMAND_FILLED_CIRCLE, center, radius, CalcColorWithAlpha( color, alpha ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DrawOutlinedCircle( const Vector2& center, float radius, const Rgba& color, float alpha )
+{
+	g_recordingRenderCommands->AddCircle( RENDER_COMMAND_OUTLINED_CIRCLE, center, radius, CalcColorWithAlpha( color, alpha ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DrawFilledOutlinedCircle( const Vector2& center, float radius, const Rgba& fillColor, const Rgba& edgeColor, float alpha )
+{
+	DrawFilledCircle( center, radius, fillColor, alpha );
+	DrawOutlinedCircle( center, radius, edgeColor, alpha );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// A soft shadow in one primitive: <alpha> inside the radius, fading to zero at radius + falloffWidth.
+//
+void DrawShadowCircle( const Vector2& center, float radius, float falloffWidth, const Rgba& color, float alpha )
+{
+	g_recordingRenderCommands->AddShadowCircle( center, radius, falloffWidth, CalcColorWithAlpha( color, alpha ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DrawFilledArea( const AABB2& area, const Rgba& color, float alpha )
+{
+	g_recordingRenderCommands->AddQuad( RENDER_COMMAND_FILLED_QUAD, area, CalcColorWithAlpha( color, alpha ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DrawOutlinedArea( const AABB2& area, const Rgba& color, float alpha )
+{
+	g_recordingRenderCommands->AddQuad( RENDER_COMMAND_OUTLINED_QUAD, area, CalcColorWithAlpha( color, alpha ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DrawFilledOutlinedArea( const AABB2& area, const Rgba& fillColor, const Rgba& edgeColor, float alpha )
+{
+	DrawFilledArea( area, fillColor, alpha );
+	DrawOutlinedArea( area, edgeColor, alpha );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// As DrawShadowCircle, fading out over falloffWidth beyond each edge of <area>.
+//
+void DrawShadowArea( const AABB2& area, float falloffWidth, const Rgba& color, float alpha )
+{
+	g_recordingRenderCommands->AddShadowQuad( area, falloffWidth, CalcColorWithAlpha( color, alpha ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void BeginRecordingLayer( RenderLayer& layer )
+{
+	layer.m_commands.Clear();
+	g_recordingRenderCommands = &layer.m_commands;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void EndRecordingLayer( RenderLayer& layer )
+{
+	++ layer.m_version;
+	g_recordingRenderCommands = &g_renderCommands;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void DrawLayer( const RenderLayer& layer )
+{
+	g_renderCommands.AddLayer( layer );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The alpha of <numLayers> stacked draws of the same color at <layerAlpha> each.
+//
+float CalcAlphaOfStackedLayers( float layerAlpha, int numLayers )
+{
+	float transmittance = 1.f;
+	for( int layerIndex = 0; layerIndex < numLayers; ++ layerIndex )
+	{
+		transmittance *= 1.f - layerAlpha;
+	}
+
+	return 1.f - transmittance;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void OpenGLRenderBackend::Execute( const RenderCommandBuffer& commands )
+{
+	m_vertices.reserve( MAX_BATCH_VERTICES );
+	for( unsigned int commandIndex = 0; commandIndex < commands.GetNumCommands(); ++ commandIndex )
 	{
-		for( int i = 0; i < NUM_CIRCLE_SIDES; ++ i )
+		const RenderCommand& command = commands.GetCommand( commandIndex );
+		if( command.GetType() == RENDER_COMMAND_LAYER )
+		{
+			DrawLayer( commands.GetLayer( command ) );
+		}
+		else
 		{
-			Vector2 point = center + (radius * g_circlePoints[ i ]);
-			glVertex2f( point.x, point.y );
+			TessellateCommand( command );
 		}
 	}
-	glEnd();
+
+	SubmitBatch();
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void DrawOutlinedCircle( const Vector2& center, float radius, const Rgba& color, float alpha )
+void OpenGLRenderBackend::TessellateCommand( const RenderCommand& command )
 {
-	SetColor( color, alpha );
-	glLineWidth( LINE_WIDTH );
-	glBegin( GL_LINE_LOOP );
+	switch( command.GetType() )
 	{
-		for( int i = 0; i < NUM_CIRCLE_SIDES; ++ i )
+		case RENDER_COMMAND_FILLED_CIRCLE:		AddFilledCircle( command );		break;
+		case RENDER_COMMAND_OUTLINED_CIRCLE:	AddOutlinedCircle( command );	break;
+		case RENDER_COMMAND_FILLED_QUAD:		AddFilledQuad( command );		break;
+		case RENDER_COMMAND_OUTLINED_QUAD:		AddOutlinedQuad( command );		break;
+		case RENDER_COMMAND_SHADOW_CIRCLE:		AddShadowCircle( command );		break;
+		case RENDER_COMMAND_SHADOW_QUAD:		AddShadowQuad( command );		break;
+		default:								break; // layers don't nest
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Rebuilds the layer's triangles (and display list) only when its version has changed.
+//
+void OpenGLRenderBackend::DrawLayer( const RenderLayer& layer )
+{
+	SubmitBatch(); // everything drawn before the layer goes under it
+	RetainedRenderLayer& retainedLayer = FindOrAddRetainedLayer( layer.GetId() );
+	if( retainedLayer.m_layerVersion != layer.GetVersion() )
+	{
+		m_isRetainingLayer = true;
+		for( unsigned int commandIndex = 0; commandIndex < layer.m_commands.GetNumCommands(); ++ commandIndex )
+		{
+			TessellateCommand( layer.m_commands.GetCommand( commandIndex ) );
+		}
+
+		m_isRetainingLayer = false;
+		m_numVerticesGenerated += (double) m_vertices.size();
+		retainedLayer.m_vertices.swap( m_vertices );
+		m_vertices.clear();
+		m_vertices.reserve( MAX_BATCH_VERTICES );
+		retainedLayer.m_layerVersion = layer.GetVersion();
+
+#if defined( JAZZ_USE_OPENGL )
+		if( retainedLayer.m_displayList == 0 )
 		{
-			Vector2 point = center + (radius * g_circlePoints[ i ]);
-			glVertex2f( point.x, point.y );
+			retainedLayer.m_displayList = glGenLists( 1 );
 		}
+
+		glNewList( retainedLayer.m_displayList, GL_COMPILE ); // vertex arrays are copied into the list here
+		SubmitVertices( retainedLayer.m_vertices );
+		glEndList();
+#endif
 	}
-	glEnd();
-	glLineWidth( 1.f );
+
+#if defined( JAZZ_USE_OPENGL )
+	glCallList( retainedLayer.m_displayList );
+#endif
+	++ m_numDrawCalls;
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void DrawFilledOutlinedCircle( const Vector2& center, float radius, const Rgba& fillColor, const Rgba& edgeColor, float alpha )
+RetainedRenderLayer& OpenGLRenderBackend::FindOrAddRetainedLayer( unsigned int layerId )
 {
-	DrawFilledCircle( center, radius, fillColor, alpha );
-	DrawOutlinedCircle( center, radius, edgeColor, alpha );
+	for( unsigned int retainedIndex = 0; retainedIndex < m_retainedLayers.size(); ++ retainedIndex )
+	{
+		if( m_retainedLayers[ retainedIndex ].m_layerId == layerId )
+			return m_retainedLayers[ retainedIndex ];
+	}
+
+	m_retainedLayers.push_back( RetainedRenderLayer() );
+	m_retainedLayers.back().m_layerId = layerId;
+	return m_retainedLayers.back();
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void DrawFilledArea( const AABB2& area, const Rgba& color, float alpha )
+void OpenGLRenderBackend::SubmitBatch()
+{
+	if( m_vertices.empty() )
+		return;
+
+	SubmitVertices( m_vertices );
+	++ m_numDrawCalls;
+	m_numVerticesGenerated += (double) m_vertices.size();
+	m_vertices.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void OpenGLRenderBackend::SubmitVertices( const std::vector< BatchVertex >& vertices )
+{
+	if( vertices.empty() )
+		return;
+
+#if defined( JAZZ_USE_OPENGL )
+	const GLsizei stride = (GLsizei) sizeof( BatchVertex );
+	glEnable( GL_TEXTURE_2D ); // only around the batch; immediate-mode lines draw untextured
+	glBindTexture( GL_TEXTURE_2D, g_shadowSpriteTexture );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+	glVertexPointer( 2, GL_FLOAT, stride, &vertices[ 0 ].x );
+	glTexCoordPointer( 2, GL_SHORT, stride, &vertices[ 0 ].u );
+	glColorPointer( 4, GL_UNSIGNED_BYTE, stride, &vertices[ 0 ].r );
+	glDrawArrays( GL_TRIANGLES, 0, (GLsizei) vertices.size() );
+	glDisableClientState( GL_COLOR_ARRAY );
+	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	glDisableClientState( GL_VERTEX_ARRAY );
+	glDisable( GL_TEXTURE_2D );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Makes room for <numVerticesToAdd> more vertices, submitting first if the batch would overflow.
+//
+void OpenGLRenderBackend::ReserveVertices( unsigned int numVerticesToAdd )
 {
-	SetColor( color, alpha );
-	glBegin( GL_QUADS );
+	if( !m_isRetainingLayer && m_vertices.size() + numVerticesToAdd > MAX_BATCH_VERTICES )
 	{
-		glVertex2f( area.mins.x, area.mins.y );
-		glVertex2f( area.maxs.x, area.mins.y );
-		glVertex2f( area.maxs.x, area.maxs.y );
-		glVertex2f( area.mins.x, area.maxs.y );
+		SubmitBatch();
 	}
-	glEnd();
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void DrawOutlinedArea( const AABB2& area, const Rgba& color, float alpha )
+void OpenGLRenderBackend::AddVertex( const Vector2& position, const RenderCommand& command )
+{
+	AddVertex( position, command, command.m_a );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void OpenGLRenderBackend::AddVertex( const Vector2& position, const RenderCommand& command, unsigned char alpha )
+{
+	m_vertices.push_back( BatchVertex() ); // then filled in place; copying a filled one in stalls on store forwarding
+	BatchVertex& vertex = m_vertices.back();
+	vertex.x = position.x;
+	vertex.y = position.y;
+	vertex.u = UNTEXTURED_SPRITE_COORDINATE;
+	vertex.v = UNTEXTURED_SPRITE_COORDINATE;
+	vertex.r = command.m_r;
+	vertex.g = command.m_g;
+	vertex.b = command.m_b;
+	vertex.a = alpha;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void OpenGLRenderBackend::AddSpriteVertex( const Vector2& position, short u, short v, const RenderCommand& command )
+{
+	AddVertex( position, command );
+	m_vertices.back().u = u;
+	m_vertices.back().v = v;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void OpenGLRenderBackend::AddQuad( const Vector2& a, const Vector2& b, const Vector2& c, const Vector2& d, const RenderCommand& command )
 {
-	SetColor( color, alpha );
-	glLineWidth( LINE_WIDTH );
-	glBegin( GL_LINE_LOOP );
+	AddVertex( a, command );
+	AddVertex( b, command );
+	AddVertex( c, command );
+	AddVertex( a, command );
+	AddVertex( c, command );
+	AddVertex( d, command );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Same triangles as the old GL_TRIANGLE_FAN (fanned from the first rim point).
+//
+void OpenGLRenderBackend::AddFilledCircle( const RenderCommand& command )
+{
+	const Vector2 center = command.GetCircleCenter();
+	const float radius = command.GetCircleRadius();
+	if( radius <= 0.f )
+		return;
+
+	const int lodIndex = SelectCircleLod( radius, CIRCLE_MAX_EDGE_ERROR );
+	const int numSides = CIRCLE_LOD_NUM_SIDES[ lodIndex ];
+	const Vector2* unitCirclePoints = g_circleLodPoints[ lodIndex ];
+	ReserveVertices( 3 * (numSides - 2) );
+	const Vector2 firstPoint = center + (radius * unitCirclePoints[ 0 ]);
+	Vector2 previousPoint = center + (radius * unitCirclePoints[ 1 ]);
+	for( int i = 2; i < numSides; ++ i )
 	{
-		glVertex2f( area.mins.x, area.mins.y );
-		glVertex2f( area.maxs.x, area.mins.y );
-		glVertex2f( area.maxs.x, area.maxs.y );
-		glVertex2f( area.mins.x, area.maxs.y );
+		const Vector2 point = center + (radius * unitCirclePoints[ i ]);
+		AddVertex( firstPoint, command );
+		AddVertex( previousPoint, command );
+		AddVertex( point, command );
+		previousPoint = point;
 	}
-	glEnd();
-	glLineWidth( 1.f );
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void DrawFilledOutlinedArea( const AABB2& area, const Rgba& fillColor, const Rgba& edgeColor, float alpha )
+// A RENDER_OUTLINE_WIDTH-wide ring of quads centered on the circle (what glLineWidth + GL_LINE_LOOP drew).
+//
+void OpenGLRenderBackend::AddOutlinedCircle( const RenderCommand& command )
 {
-	DrawFilledArea( area, fillColor, alpha );
-	DrawOutlinedArea( area, edgeColor, alpha );
+	const Vector2 center = command.GetCircleCenter();
+	const float radius = command.GetCircleRadius();
+	const float innerRadius = MaxFloat( radius - (0.5f * RENDER_OUTLINE_WIDTH), 0.f );
+	const float outerRadius = radius + (0.5f * RENDER_OUTLINE_WIDTH);
+	const int lodIndex = SelectCircleLod( outerRadius, CIRCLE_MAX_EDGE_ERROR );
+	const int numSides = CIRCLE_LOD_NUM_SIDES[ lodIndex ];
+	const Vector2* unitCirclePoints = g_circleLodPoints[ lodIndex ];
+	ReserveVertices( 6 * numSides );
+	for( int i = 0; i < numSides; ++ i )
+	{
+		const Vector2& direction = unitCirclePoints[ i ];
+		const Vector2& nextDirection = unitCirclePoints[ (i + 1) % numSides ];
+		AddQuad( center + (innerRadius * direction), center + (outerRadius * direction), center + (outerRadius * nextDirection), center + (innerRadius * nextDirection), command );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void OpenGLRenderBackend::AddFilledQuad( const RenderCommand& command )
+{
+	const AABB2 area = command.GetQuadBounds();
+	ReserveVertices( 6 );
+	AddQuad( area.mins, Vector2( area.maxs.x, area.mins.y ), area.maxs, Vector2( area.mins.x, area.maxs.y ), command );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Four RENDER_OUTLINE_WIDTH-wide strips centered on the edges, mitered at the corners.
+//
+void OpenGLRenderBackend::AddOutlinedQuad( const RenderCommand& command )
+{
+	const AABB2 area = command.GetQuadBounds();
+	const Vector2 halfLineWidth( 0.5f * RENDER_OUTLINE_WIDTH, 0.5f * RENDER_OUTLINE_WIDTH );
+	const Vector2 outerMins = area.mins - halfLineWidth;
+	const Vector2 outerMaxs = area.maxs + halfLineWidth;
+	const Vector2 innerMins = area.mins + halfLineWidth;
+	const Vector2 innerMaxs = area.maxs - halfLineWidth;
+	ReserveVertices( 24 );
+	AddQuad( outerMins, Vector2( outerMaxs.x, outerMins.y ), Vector2( innerMaxs.x, innerMins.y ), innerMins, command );
+	AddQuad( Vector2( outerMaxs.x, outerMins.y ), outerMaxs, innerMaxs, Vector2( innerMaxs.x, innerMins.y ), command );
+	AddQuad( outerMaxs, Vector2( outerMins.x, outerMaxs.y ), Vector2( innerMins.x, innerMaxs.y ), innerMaxs, command );
+	AddQuad( Vector2( outerMins.x, outerMaxs.y ), outerMins, innerMins, Vector2( innerMins.x, innerMaxs.y ), command );
 }
 
+
+//-----------------------------------------------------------------------------------------------
+// One quad textured with the shadow sprite when the falloff matches the sprite's (as every actor
+//	shadow's does).  Otherwise a fan over the polygon at the radius, plus a ring out to radius +
+//	falloff whose outer vertices have zero alpha; GL's color interpolation does the fading.
+//
+void OpenGLRenderBackend::AddShadowCircle( const RenderCommand& command )
+{
+	const Vector2 center = command.GetCircleCenter();
+	const float innerRadius = command.GetCircleRadius();
+	const float outerRadius = innerRadius + command.GetShadowFalloffWidth();
+	if( outerRadius <= 0.f )
+		return;
+
+	if( fabsf( (innerRadius / outerRadius) - SHADOW_SPRITE_INNER_FRACTION_OF_OUTER ) <= SHADOW_SPRITE_MAX_FRACTION_ERROR )
+	{
+		const Vector2 mins = center - Vector2( outerRadius, outerRadius );
+		const Vector2 maxs = center + Vector2( outerRadius, outerRadius );
+		ReserveVertices( 6 );
+		AddSpriteVertex( mins, 0, 0, command );
+		AddSpriteVertex( Vector2( maxs.x, mins.y ), SPRITE_MAX_COORDINATE, 0, command );
+		AddSpriteVertex( maxs, SPRITE_MAX_COORDINATE, SPRITE_MAX_COORDINATE, command );
+		AddSpriteVertex( mins, 0, 0, command );
+		AddSpriteVertex( maxs, SPRITE_MAX_COORDINATE, SPRITE_MAX_COORDINATE, command );
+		AddSpriteVertex( Vector2( mins.x, maxs.y ), 0, SPRITE_MAX_COORDINATE, command );
+		return;
+	}
+
+	const int numSides = CIRCLE_LOD_NUM_SIDES[ SHADOW_CIRCLE_LOD_INDEX ];
+	const Vector2* unitCirclePoints = g_circleLodPoints[ SHADOW_CIRCLE_LOD_INDEX ];
+	ReserveVertices( (3 * (numSides - 2)) + (6 * numSides) );
+	const Vector2 firstPoint = center + (innerRadius * unitCirclePoints[ 0 ]);
+	for( int i = 2; i < numSides; ++ i )
+	{
+		AddVertex( firstPoint, command );
+		AddVertex( center + (innerRadius * unitCirclePoints[ i - 1 ]), command );
+		AddVertex( center + (innerRadius * unitCirclePoints[ i ]), command );
+	}
+
+	for( int i = 0; i < numSides; ++ i )
+	{
+		const Vector2& direction = unitCirclePoints[ i ];
+		const Vector2& nextDirection = unitCirclePoints[ (i + 1) % numSides ];
+		const Vector2 inner = center + (innerRadius * direction);
+		const Vector2 nextInner = center + (innerRadius * nextDirection);
+		const Vector2 outer = center + (outerRadius * direction);
+		const Vector2 nextOuter = center + (outerRadius * nextDirection);
+		AddVertex( inner, command );
+		AddVertex( outer, command, 0 );
+		AddVertex( nextOuter, command, 0 );
+		AddVertex( inner, command );
+		AddVertex( nextOuter, command, 0 );
+		AddVertex( nextInner, command );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The bounds as one quad, framed by four trapezoids out to the zero-alpha grown bounds.
+//
+void OpenGLRenderBackend::AddShadowQuad( const RenderCommand& command )
+{
+	const AABB2 area = command.GetQuadBounds();
+	const float falloffWidth = command.GetShadowFalloffWidth();
+	const Vector2 inner[ 4 ] = { area.mins, Vector2( area.maxs.x, area.mins.y ), area.maxs, Vector2( area.mins.x, area.maxs.y ) };
+	const Vector2 outer[ 4 ] = { area.mins - Vector2( falloffWidth, falloffWidth ), Vector2( area.maxs.x + falloffWidth, area.mins.y - falloffWidth ),
+		area.maxs + Vector2( falloffWidth, falloffWidth ), Vector2( area.mins.x - falloffWidth, area.maxs.y + falloffWidth ) };
+	ReserveVertices( 30 );
+	AddQuad( inner[ 0 ], inner[ 1 ], inner[ 2 ], inner[ 3 ], command );
+	for( int i = 0; i < 4; ++ i )
+	{
+		const int next = (i + 1) % 4;
+		AddVertex( inner[ i ], command );
+		AddVertex( outer[ i ], command, 0 );
+		AddVertex( outer[ next ], command, 0 );
+		AddVertex( inner[ i ], command );
+		AddVertex( outer[ next ], command, 0 );
+		AddVertex( inner[ next ], command );
+	}
+}
@@ -8,11 +8,87 @@
 #include "Vector2.hpp"
 #include "Rgba.hpp"
 #include "Clock.hpp"
+#include "RenderCommandBuffer.hpp"
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class BatchVertex
+{
+public:
+	float x;
+	float y;
+	short u; // shadow sprite coordinates, in half-sprites (see CreateShadowSprite)
+	short v;
+	unsigned char r;
+	unsigned char g;
+	unsigned char b;
+	unsigned char a;
+};
 
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// A layer's triangles as of one version, and (with OpenGL) the display list drawing them.
+//
+class RetainedRenderLayer
+{
+public:
+	RetainedRenderLayer() : m_layerId( 0 ), m_layerVersion( 0 ), m_displayList( 0 ) {}
+
+	unsigned int m_layerId;
+	unsigned int m_layerVersion;
+	unsigned int m_displayList; // 0 if none
+	std::vector< BatchVertex > m_vertices;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Tessellates every command into one triangle list (lines become thin quads, so draw order is
+//	kept with a single primitive type), submitted with one glDrawArrays call per batch.  Without
+//	OpenGL the triangles are still built but not submitted.  Layers are tessellated once per
+//	version into a display list, and after that cost one glCallList per frame.  Soft shadow
+//	circles are a single quad textured with the shadow sprite, which stays bound for the whole
+//	batch; every other vertex samples the sprite's opaque white center.
+//
+class OpenGLRenderBackend : public RenderBackend
+{
+public:
+	OpenGLRenderBackend() : m_numVerticesGenerated( 0 ), m_numDrawCalls( 0 ), m_isRetainingLayer( false ) {}
+	virtual void Execute( const RenderCommandBuffer& commands );
+	virtual const char* GetName() const { return "opengl"; }
+
+private:
+	void TessellateCommand( const RenderCommand& command );
+	void DrawLayer( const RenderLayer& layer );
+	RetainedRenderLayer& FindOrAddRetainedLayer( unsigned int layerId );
+	void SubmitBatch();
+	void SubmitVertices( const std::vector< BatchVertex >& vertices );
+	void ReserveVertices( unsigned int numVerticesToAdd );
+	void AddVertex( const Vector2& position, const RenderCommand& command );
+	void AddVertex( const Vector2& position, const RenderCommand& command, unsigned char alpha );
+	void AddSpriteVertex( const Vector2& position, short u, short v, const RenderCommand& command );
+	void AddQuad( const Vector2& a, const Vector2& b, const Vector2& c, const Vector2& d, const RenderCommand& command );
+	void AddFilledCircle( const RenderCommand& command );
+	void AddOutlinedCircle( const RenderCommand& command );
+	void AddFilledQuad( const RenderCommand& command );
+	void AddOutlinedQuad( const RenderCommand& command );
+	void AddShadowCircle( const RenderCommand& command );
+	void AddShadowQuad( const RenderCommand& command );
+
+public:
+	double m_numVerticesGenerated; // including vertices never submitted (no OpenGL); a retained layer's only count when it's rebuilt
+	double m_numDrawCalls; // glDrawArrays and glCallList calls (counted without OpenGL too)
+
+private:
+	std::vector< BatchVertex > m_vertices;
+	std::vector< RetainedRenderLayer > m_retainedLayers;
+	bool m_isRetainingLayer; // while tessellating a layer, m_vertices may grow past MAX_BATCH_VERTICES
+};
+
+
+//-----------------------------------------------------------------------------------------------
 void InitGraphics();
 void ComputeCirclePoints();
+int SelectCircleLod( float radius, float maxEdgeError );
 void SetColor( const Rgba& color, float alpha=1.f );
 void DrawFilledCircle( const Vector2& center, float radius, const Rgba& color, float alpha=1.f );
 void DrawOutlinedCircle( const Vector2& center, float radius, const Rgba& color, float alpha=1.f );
@@ -20,6 +96,19 @@ void DrawFilledOutlinedCircle( const Vector2& center, float radius, const Rgba&
 void DrawFilledArea( const AABB2& area, const Rgba& color, float alpha=1.f );
 void DrawOutlinedArea( const AABB2& area, const Rgba& color, float alpha=1.f );
 void DrawFilledOutlinedArea( const AABB2& area, const Rgba& fillColor, const Rgba& edgeColor, float alpha=1.f );
+void DrawShadowCircle( const Vector2& center, float radius, float falloffWidth, const Rgba& color, float alpha=1.f );
+void DrawShadowArea( const AABB2& area, float falloffWidth, const Rgba& color, float alpha=1.f );
+void BeginRecordingLayer( RenderLayer& layer ); // until EndRecordingLayer, the Draw* functions record into <layer> instead of the frame
+void EndRecordingLayer( RenderLayer& layer );
+void DrawLayer( const RenderLayer& layer ); // <layer> must stay alive and unchanged until the next FlushGraphicsBatch
+float CalcAlphaOfStackedLayers( float layerAlpha, int numLayers );
+void FlushGraphicsBatch(); // the Draw* functions above only record commands; call once per frame before presenting
+Rgba CalcColorWithAlpha( const Rgba& color, float alpha );
+void SetRenderBackend( RenderBackend* backend );
+RenderBackend& GetRenderBackend();
+const RenderCommandBuffer& GetRenderCommands();
+void SetViewBounds( const AABB2& viewBounds ); // in world units; the Draw* functions record regardless, SimulationSnapshotRenderer culls against it
+const AABB2& GetViewBounds();
 
 
 
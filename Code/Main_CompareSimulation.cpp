@@ -0,0 +1,292 @@
+//-----------------------------------------------------------------------------------------------
+// Main_CompareSimulation.cpp
+//
+// Windowless entry point that runs one scenario under two simulation configurations side by
+//	side, stepping both in lockstep with a state hash after every tick, and reports the first tick
+//	on which they differ, along with the first actor (or area) and field that differs and both
+//	values.  Meant for proving that a faster update path (parallel, reordered, vectorized) gives
+//	the same results as the reference, bit for bit.  A configuration is an update mode, plus a
+//	thread count for the parallel mode: in-place, double-buffered, or parallel:N.  Note that
+//	in-place and double-buffered updates are expected to differ; in-place NPCs see neighbors that
+//	have already moved this tick.
+//	Builds on Linux (see Makefile).  Exits with 0 if the runs match and 2 if they diverge.
+//
+// Usage: PH2011_CompareSimulation <scenarioName> [-steps N] [-dt seconds] [-a config] [-b config]
+//-----------------------------------------------------------------------------------------------
+#include "TheGame.hpp"
+#include "SimulationStateHash.hpp"
+#include <stdio.h>
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const int DEFAULT_COMPARE_STEPS = 3600;
+const double DEFAULT_COMPARE_DELTA_SECONDS = 1.0 / 60.0;
+const unsigned int MIN_COMPARE_PARALLEL_THREADS = 2; // so the parallel path really splits the work, even on one core
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class SimulationConfiguration
+{
+public:
+	SimulationConfiguration() : m_updateMode( SIMULATION_UPDATE_IN_PLACE ), m_numThreads( 1 ) {}
+	SimulationConfiguration( SimulationUpdateMode updateMode, unsigned int numThreads ) : m_updateMode( updateMode ), m_numThreads( numThreads ) {}
+	bool ParseFromString( const std::string& configString );
+	std::string GetAsString() const;
+
+	SimulationUpdateMode m_updateMode;
+	unsigned int m_numThreads;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class CompareOptions
+{
+public:
+	CompareOptions();
+	bool ParseCommandLine( int argc, char** argv );
+
+	std::string m_scenarioName;
+	int m_numSteps;
+	double m_deltaSeconds;
+	SimulationConfiguration m_configurations[ 2 ];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// "mode" or "mode:threads"; the thread count only matters for the parallel mode.
+//
+bool SimulationConfiguration::ParseFromString( const std::string& configString )
+{
+	const size_t colonIndex = configString.find( ':' );
+	if( !FindSimulationUpdateModeByName( configString.substr( 0, colonIndex ), m_updateMode ) )
+		return false;
+
+	if( colonIndex != std::string::npos )
+	{
+		const int numThreads = atoi( configString.c_str() + colonIndex + 1 );
+		if( numThreads <= 0 )
+			return false;
+
+		m_numThreads = (unsigned int) numThreads;
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+std::string SimulationConfiguration::GetAsString() const
+{
+	if( m_updateMode == SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL )
+		return Stringf( "%s:%u", SIMULATION_UPDATE_MODE_NAMES[ m_updateMode ], m_numThreads );
+
+	return SIMULATION_UPDATE_MODE_NAMES[ m_updateMode ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+CompareOptions::CompareOptions()
+	: m_numSteps( DEFAULT_COMPARE_STEPS )
+	, m_deltaSeconds( DEFAULT_COMPARE_DELTA_SECONDS )
+{
+	// By default, check the parallel path against the serial double-buffered one it must match
+	const unsigned int numParallelThreads = (unsigned int) MaxInt( (int) MIN_COMPARE_PARALLEL_THREADS, (int) SysGetNumberOfHardwareThreads() );
+	m_configurations[ 0 ] = SimulationConfiguration( SIMULATION_UPDATE_DOUBLE_BUFFERED, 1 );
+	m_configurations[ 1 ] = SimulationConfiguration( SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL, numParallelThreads );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool CompareOptions::ParseCommandLine( int argc, char** argv )
+{
+	for( int argIndex = 1; argIndex < argc; ++ argIndex )
+	{
+		const std::string arg = argv[ argIndex ];
+		const bool hasValue = argIndex + 1 < argc;
+		if( arg == "-steps" && hasValue )
+		{
+			m_numSteps = atoi( argv[ ++ argIndex ] );
+		}
+		else if( arg == "-dt" && hasValue )
+		{
+			m_deltaSeconds = atof( argv[ ++ argIndex ] );
+		}
+		else if( arg == "-a" && hasValue )
+		{
+			if( !m_configurations[ 0 ].ParseFromString( argv[ ++ argIndex ] ) )
+				return false;
+		}
+		else if( arg == "-b" && hasValue )
+		{
+			if( !m_configurations[ 1 ].ParseFromString( argv[ ++ argIndex ] ) )
+				return false;
+		}
+		else if( arg[ 0 ] != '-' && m_scenarioName.empty() )
+		{
+			m_scenarioName = arg;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return !m_scenarioName.empty() && m_numSteps > 0 && m_deltaSeconds > 0.0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static bool AreBitsEqual( float a, float b )
+{
+	return memcmp( &a, &b, sizeof( float ) ) == 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Prints the first field of actor <actorIndex> that differs; false if they all match.
+//
+static bool PrintActorDifference( const ActorStore& actorsA, const ActorStore& actorsB, unsigned int actorIndex )
+{
+	const Vector2& positionA = actorsA.m_positions[ actorIndex ];
+	const Vector2& positionB = actorsB.m_positions[ actorIndex ];
+	if( !AreBitsEqual( positionA.x, positionB.x ) || !AreBitsEqual( positionA.y, positionB.y ) )
+	{
+		printf( "actor=%u field=position a=(%.9g,%.9g) b=(%.9g,%.9g)\n", actorIndex, positionA.x, positionA.y, positionB.x, positionB.y );
+		return true;
+	}
+
+	if( actorsA.m_states[ actorIndex ] != actorsB.m_states[ actorIndex ] )
+	{
+		printf( "actor=%u field=state a=%d b=%d\n", actorIndex, (int) actorsA.m_states[ actorIndex ], (int) actorsB.m_states[ actorIndex ] );
+		return true;
+	}
+
+	if( !AreBitsEqual( actorsA.m_radiusScales[ actorIndex ], actorsB.m_radiusScales[ actorIndex ] ) )
+	{
+		printf( "actor=%u field=radius_scale a=%.9g b=%.9g\n", actorIndex, actorsA.m_radiusScales[ actorIndex ], actorsB.m_radiusScales[ actorIndex ] );
+		return true;
+	}
+
+	if( !AreBitsEqual( actorsA.m_alphaScales[ actorIndex ], actorsB.m_alphaScales[ actorIndex ] ) )
+	{
+		printf( "actor=%u field=alpha_scale a=%.9g b=%.9g\n", actorIndex, actorsA.m_alphaScales[ actorIndex ], actorsB.m_alphaScales[ actorIndex ] );
+		return true;
+	}
+
+	return false;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Narrows a tick whose hashes differ down to the first actor (or area) that differs.
+//
+static void PrintFirstDifference( const Scenario& scenarioA, const Scenario& scenarioB )
+{
+	const unsigned int numActors = scenarioA.m_actors.GetNumActors();
+	const unsigned int numAreas = (unsigned int) scenarioA.m_areas.size();
+	if( numActors != scenarioB.m_actors.GetNumActors() || numAreas != scenarioB.m_areas.size() )
+	{
+		printf( "field=counts a_actors=%u b_actors=%u a_areas=%u b_areas=%u\n", numActors, scenarioB.m_actors.GetNumActors(), numAreas, (unsigned int) scenarioB.m_areas.size() );
+		return;
+	}
+
+	for( unsigned int actorIndex = 0; actorIndex < numActors; ++ actorIndex )
+	{
+		if( PrintActorDifference( scenarioA.m_actors, scenarioB.m_actors, actorIndex ) )
+			return;
+	}
+
+	for( unsigned int areaIndex = 0; areaIndex < numAreas; ++ areaIndex )
+	{
+		const Area& areaA = *scenarioA.m_areas[ areaIndex ];
+		const Area& areaB = *scenarioB.m_areas[ areaIndex ];
+		if( HashAreaState( areaA, SIMULATION_STATE_HASH_SEED ) != HashAreaState( areaB, SIMULATION_STATE_HASH_SEED ) )
+		{
+			printf( "area=%u a_bounds=(%.9g,%.9g,%.9g,%.9g) b_bounds=(%.9g,%.9g,%.9g,%.9g) a_alpha=%.9g b_alpha=%.9g\n", areaIndex,
+				areaA.m_bounds.mins.x, areaA.m_bounds.mins.y, areaA.m_bounds.maxs.x, areaA.m_bounds.maxs.y,
+				areaB.m_bounds.mins.x, areaB.m_bounds.mins.y, areaB.m_bounds.maxs.x, areaB.m_bounds.maxs.y, areaA.m_alpha, areaB.m_alpha );
+			return;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Each configuration gets its own TheGame (and so its own scenario and thread pool); the first
+//	is also theGame, whose key states both scenarios' players read.
+//
+int main( int argc, char** argv )
+{
+	CompareOptions options;
+	if( !options.ParseCommandLine( argc, argv ) )
+	{
+		fprintf( stderr, "Usage: %s <scenarioName> [-steps N] [-dt seconds] [-a in-place|double-buffered|parallel[:threads]] [-b ...]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	TheGame* games[ 2 ];
+	Scenario* scenarios[ 2 ];
+	SimulationStateHashLog hashLogs[ 2 ];
+	games[ 0 ] = theGame = new TheGame();
+	theGame->Startup( "" );
+	games[ 1 ] = new TheGame();
+	games[ 1 ]->CreateScenarios();
+	for( int gameIndex = 0; gameIndex < 2; ++ gameIndex )
+	{
+		const SimulationConfiguration& configuration = options.m_configurations[ gameIndex ];
+		games[ gameIndex ]->SetNumSimulationThreads( configuration.m_numThreads );
+		games[ gameIndex ]->SetSimulationUpdateMode( configuration.m_updateMode );
+		games[ gameIndex ]->StartScenarioByName( options.m_scenarioName );
+		scenarios[ gameIndex ] = games[ gameIndex ]->GetCurrentScenario();
+		if( scenarios[ gameIndex ] )
+		{
+			scenarios[ gameIndex ]->m_stateHashLog = &hashLogs[ gameIndex ];
+		}
+	}
+
+	int exitCode = 0;
+	if( !scenarios[ 0 ] || !scenarios[ 1 ] )
+	{
+		fprintf( stderr, "Unknown scenario '%s'\n", options.m_scenarioName.c_str() );
+		exitCode = 1;
+	}
+	else
+	{
+		Scenario& scenarioA = *scenarios[ 0 ];
+		Scenario& scenarioB = *scenarios[ 1 ];
+		int stepIndex;
+		for( stepIndex = 0; stepIndex < options.m_numSteps; ++ stepIndex )
+		{
+			scenarioA.Update( options.m_deltaSeconds );
+			scenarioB.Update( options.m_deltaSeconds );
+			if( hashLogs[ 0 ].GetLatestHash() != hashLogs[ 1 ].GetLatestHash() )
+				break;
+		}
+
+		const bool isMatch = (stepIndex == options.m_numSteps);
+		const double hashMicrosecondsPerTick = 1e6 * hashLogs[ 0 ].GetSecondsHashing() / (double) hashLogs[ 0 ].GetNumTicks();
+		printf( "scenario=%s a=%s b=%s actors=%u steps=%d result=%s", scenarioA.m_name.c_str(), options.m_configurations[ 0 ].GetAsString().c_str(),
+			options.m_configurations[ 1 ].GetAsString().c_str(), scenarioA.m_actors.GetNumActors(), options.m_numSteps, isMatch ? "match" : "diverged" );
+		if( isMatch )
+		{
+			printf( " state_hash=%016llx hash_us_per_tick=%.2f\n", hashLogs[ 0 ].GetCombinedHash(), hashMicrosecondsPerTick );
+		}
+		else
+		{
+			printf( " tick=%u a_hash=%016llx b_hash=%016llx\n", scenarioA.m_numUpdates, hashLogs[ 0 ].GetLatestHash(), hashLogs[ 1 ].GetLatestHash() );
+			PrintFirstDifference( scenarioA, scenarioB );
+			exitCode = 2;
+		}
+	}
+
+	for( int gameIndex = 1; gameIndex >= 0; -- gameIndex )
+	{
+		games[ gameIndex ]->Shutdown();
+		delete games[ gameIndex ];
+	}
+
+	return exitCode;
+}
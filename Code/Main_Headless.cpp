@@ -0,0 +1,650 @@
+//-----------------------------------------------------------------------------------------------
+// Main_Headless.cpp
+//
+// Windowless entry point: loads one scenario by name and steps it at a fixed delta as fast as
+//	possible, then reports simulation throughput.  With -render, each step also records the
+//	scenario's draw commands and replays them through the null backend (command generation cost
+//	only), the serializing backend (-renderFile receives the last frame, for golden-file diffs) or
+//	the software rasterizer (1024x576, tiled across -threads threads).  With -capture, every Nth
+//	step is also written as <prefix><step>.ppm/.png by a background writer thread, queueing up to
+//	-captureQueue frames (or dropping them, with -captureDrop) when it falls behind; the run is
+//	also timed without capture, before and after, and the overhead is reported against that.  With
+//	-pipeline, the simulation runs on its own thread and publishes a snapshot per step, while this
+//	thread renders the latest one as often as it can (as the windowed game does with F3).  With
+//	-profile, each step (or rendered frame, when pipelined) is a profiler frame, and the
+//	per-frame average of every profiled section is printed at the end; -trace also writes the last
+//	-traceWindow seconds of them (default 2) as a Chrome trace.  With -frameStats, each step's
+//	total, simulation and render times are summarized (p50/p95/p99/max) and written as JSON, in
+//	the same format the windowed game leaves behind on shutdown.  With -threadSweep, the scenario
+//	is instead run once serially double-buffered and then once in parallel at each thread count
+//	from 1 up to N (doubling), printing each run's time, speedup over the serial run, and final
+//	state hash (which must match the serial one).
+//	Builds on Linux (see Makefile).
+//
+// Usage: PH2011_Headless <scenarioName> [-steps N] [-dt seconds] [-threads N] [-mode in-place|double-buffered|parallel]
+//	[-render none|null|serialize|software] [-renderFile path] [-capture prefix] [-captureEvery N] [-captureFormat ppm|png]
+//	[-captureQueue N] [-captureDrop] [-pipeline] [-profile] [-trace path] [-traceWindow seconds] [-frameStats path] [-threadSweep N]
+//-----------------------------------------------------------------------------------------------
+#include "TheGame.hpp"
+#include "Graphics.hpp"
+#include "FrameCapture.hpp"
+#include "ProfilingSection.hpp"
+#include "FrameStatistics.hpp"
+#include "SimulationStateHash.hpp"
+#include <stdio.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const int DEFAULT_HEADLESS_STEPS = 10000;
+const double DEFAULT_HEADLESS_DELTA_SECONDS = 1.0 / 60.0;
+const int DEFAULT_HEADLESS_CAPTURE_EVERY_N_STEPS = 60;
+const double DEFAULT_HEADLESS_TRACE_WINDOW_SECONDS = 2.0;
+
+
+//-----------------------------------------------------------------------------------------------
+class HeadlessOptions
+{
+public:
+	HeadlessOptions();
+	bool ParseCommandLine( int argc, char** argv );
+
+	std::string m_scenarioName;
+	int m_numSteps;
+	double m_deltaSeconds;
+	unsigned int m_numThreads;
+	SimulationUpdateMode m_updateMode;
+	std::string m_renderBackendName;
+	std::string m_renderFilePath;
+	std::string m_capturePathPrefix;
+	int m_captureEveryNSteps;
+	FrameImageFormat m_captureFormat;
+	unsigned int m_maxPendingCaptureFrames;
+	bool m_isDroppingCaptureFramesWhenFull;
+	bool m_isPipelined;
+	bool m_isProfiling;
+	std::string m_traceFilePath;
+	double m_traceWindowSeconds;
+	std::string m_frameStatisticsFilePath;
+	unsigned int m_maxSweepThreads; // zero for a single run
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Shared by the two threads of a -pipeline run.
+//
+class HeadlessPipeline
+{
+public:
+	HeadlessPipeline() : m_scenario( NULL ), m_numSteps( 0 ), m_deltaSeconds( 0.0 ), m_isSimulationFinished( 0 ), m_simulationSeconds( 0.0 ), m_numActorUpdates( 0.0 ) {}
+
+	Scenario* m_scenario;
+	int m_numSteps;
+	double m_deltaSeconds;
+	SimulationSnapshotTripleBuffer m_snapshots;
+	volatile long m_isSimulationFinished;
+	double m_simulationSeconds; // written by the simulation thread, read once it has been joined
+	double m_numActorUpdates;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+HeadlessOptions::HeadlessOptions()
+	: m_numSteps( DEFAULT_HEADLESS_STEPS )
+	, m_deltaSeconds( DEFAULT_HEADLESS_DELTA_SECONDS )
+	, m_numThreads( SysGetNumberOfHardwareThreads() )
+	, m_updateMode( SIMULATION_UPDATE_IN_PLACE )
+	, m_renderBackendName( "none" )
+	, m_captureEveryNSteps( DEFAULT_HEADLESS_CAPTURE_EVERY_N_STEPS )
+	, m_captureFormat( FRAME_IMAGE_PPM )
+	, m_maxPendingCaptureFrames( DEFAULT_MAX_PENDING_CAPTURE_FRAMES )
+	, m_isDroppingCaptureFramesWhenFull( false )
+	, m_isPipelined( false )
+	, m_isProfiling( false )
+	, m_traceWindowSeconds( DEFAULT_HEADLESS_TRACE_WINDOW_SECONDS )
+	, m_maxSweepThreads( 0 )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool HeadlessOptions::ParseCommandLine( int argc, char** argv )
+{
+	for( int argIndex = 1; argIndex < argc; ++ argIndex )
+	{
+		const std::string arg = argv[ argIndex ];
+		const bool hasValue = argIndex + 1 < argc;
+		if( arg == "-steps" && hasValue )
+		{
+			m_numSteps = atoi( argv[ ++ argIndex ] );
+		}
+		else if( arg == "-dt" && hasValue )
+		{
+			m_deltaSeconds = atof( argv[ ++ argIndex ] );
+		}
+		else if( arg == "-threads" && hasValue )
+		{
+			m_numThreads = (unsigned int) atoi( argv[ ++ argIndex ] );
+		}
+		else if( arg == "-mode" && hasValue )
+		{
+			if( !FindSimulationUpdateModeByName( argv[ ++ argIndex ], m_updateMode ) )
+				return false;
+		}
+		else if( arg == "-render" && hasValue )
+		{
+			m_renderBackendName = argv[ ++ argIndex ];
+			if( m_renderBackendName != "none" && m_renderBackendName != "null" && m_renderBackendName != "serialize" && m_renderBackendName != "software" )
+				return false;
+		}
+		else if( arg == "-renderFile" && hasValue )
+		{
+			m_renderFilePath = argv[ ++ argIndex ];
+		}
+		else if( arg == "-capture" && hasValue )
+		{
+			m_capturePathPrefix = argv[ ++ argIndex ];
+		}
+		else if( arg == "-captureEvery" && hasValue )
+		{
+			m_captureEveryNSteps = atoi( argv[ ++ argIndex ] );
+		}
+		else if( arg == "-captureFormat" && hasValue )
+		{
+			const std::string formatName = argv[ ++ argIndex ];
+			int formatIndex;
+			for( formatIndex = 0; formatIndex < NUM_FRAME_IMAGE_FORMATS; ++ formatIndex )
+			{
+				if( !Stricmp( formatName, FRAME_IMAGE_FORMAT_EXTENSIONS[ formatIndex ] ) )
+					break;
+			}
+
+			if( formatIndex == NUM_FRAME_IMAGE_FORMATS )
+				return false;
+
+			m_captureFormat = (FrameImageFormat) formatIndex;
+		}
+		else if( arg == "-captureQueue" && hasValue )
+		{
+			const int maxPendingFrames = atoi( argv[ ++ argIndex ] );
+			if( maxPendingFrames <= 0 )
+				return false;
+
+			m_maxPendingCaptureFrames = (unsigned int) maxPendingFrames;
+		}
+		else if( arg == "-captureDrop" )
+		{
+			m_isDroppingCaptureFramesWhenFull = true;
+		}
+		else if( arg == "-pipeline" )
+		{
+			m_isPipelined = true;
+		}
+		else if( arg == "-profile" )
+		{
+			m_isProfiling = true;
+		}
+		else if( arg == "-trace" && hasValue )
+		{
+			m_traceFilePath = argv[ ++ argIndex ];
+			m_isProfiling = true;
+		}
+		else if( arg == "-traceWindow" && hasValue )
+		{
+			m_traceWindowSeconds = atof( argv[ ++ argIndex ] );
+		}
+		else if( arg == "-frameStats" && hasValue )
+		{
+			m_frameStatisticsFilePath = argv[ ++ argIndex ];
+		}
+		else if( arg == "-threadSweep" && hasValue )
+		{
+			const int maxSweepThreads = atoi( argv[ ++ argIndex ] );
+			if( maxSweepThreads <= 0 )
+				return false;
+
+			m_maxSweepThreads = (unsigned int) maxSweepThreads;
+		}
+		else if( arg[ 0 ] != '-' && m_scenarioName.empty() )
+		{
+			m_scenarioName = arg;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	if( m_isPipelined && (m_renderBackendName == "none" || !m_capturePathPrefix.empty()) )
+		return false; // nothing to overlap with, or capture (which wants every Nth step) can't be kept up
+
+	if( m_isPipelined && !m_frameStatisticsFilePath.empty() )
+		return false; // steps and rendered frames don't line up, so there's no per-frame split to record
+
+	if( !m_capturePathPrefix.empty() && m_isProfiling )
+		return false; // capture overhead is measured against unprofiled baseline runs
+
+	if( m_maxSweepThreads > 0 && (m_renderBackendName != "none" || m_isPipelined || !m_capturePathPrefix.empty() || !m_frameStatisticsFilePath.empty()) )
+		return false; // a sweep times the simulation alone
+
+	return !m_scenarioName.empty() && m_numSteps > 0 && m_deltaSeconds > 0.0 && m_captureEveryNSteps > 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Steps as fast as possible, publishing a snapshot after every step.
+//
+static void RunPipelinedSimulation( void* headlessPipeline )
+{
+	HeadlessPipeline& pipeline = *(HeadlessPipeline*) headlessPipeline;
+	const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	for( int stepIndex = 0; stepIndex < pipeline.m_numSteps; ++ stepIndex )
+	{
+		pipeline.m_scenario->Update( pipeline.m_deltaSeconds );
+		pipeline.m_numActorUpdates += (double) pipeline.m_scenario->m_actors.GetNumActors();
+		SimulationSnapshot& snapshot = pipeline.m_snapshots.GetWriteSnapshot();
+		pipeline.m_scenario->CaptureSnapshot( snapshot );
+		snapshot.m_tickRealTimeSeconds = Clock::GetAbsoluteTimeSeconds();
+		pipeline.m_snapshots.PublishWriteSnapshot();
+	}
+
+	pipeline.m_simulationSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+	Profiler::ReleaseThread();
+	AtomicExchange( pipeline.m_isSimulationFinished, 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Renders each new snapshot once, until the simulation has finished and its last one is drawn.
+//	Returns seconds spent rendering.
+//
+static double RenderPipelinedSnapshots( HeadlessPipeline& pipeline, OUTPUT int& numFramesRendered, OUTPUT double& numRenderCommands )
+{
+	SimulationSnapshotRenderer renderer;
+	double renderSeconds = 0.0;
+	unsigned int lastTickRendered = 0;
+	for( ;; )
+	{
+		const bool wasSimulationFinished = pipeline.m_isSimulationFinished != 0;
+		const SimulationSnapshot* snapshot = pipeline.m_snapshots.AcquireLatestSnapshot();
+		if( snapshot && snapshot->m_tickNumber != lastTickRendered )
+		{
+			const double timeAtRenderStart = Clock::GetAbsoluteTimeSeconds();
+			renderer.Render( *snapshot, 1.f );
+			numRenderCommands += (double) GetRenderCommands().GetNumCommands();
+			FlushGraphicsBatch();
+			renderSeconds += Clock::GetAbsoluteTimeSeconds() - timeAtRenderStart;
+			lastTickRendered = snapshot->m_tickNumber;
+			++ numFramesRendered;
+			if( Profiler::IsEnabled() )
+			{
+				Profiler::EndFrame();
+			}
+		}
+		else if( wasSimulationFinished )
+		{
+			return renderSeconds;
+		}
+		else
+		{
+			SysSleepSeconds( 0.0 ); // give the simulation thread the core, if it shares one
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Gathers whatever the last frame left behind, then prints the per-frame averages and writes
+//	the trace, if one was asked for.  Export time is what the frame thread pays to hand the
+//	window over; write time is the writer thread's.
+//
+static void PrintProfile( const HeadlessOptions& options )
+{
+	Profiler::EndFrame();
+	std::vector< ProfilingReportRow > rows;
+	Profiler::GetAverageReport( rows );
+	printf( "profile frames=%u events_dropped=%u\n%s", Profiler::GetNumFramesAveraged(), Profiler::GetNumEventsDropped(), Profiler::FormatReport( rows ).c_str() );
+	if( options.m_traceFilePath.empty() )
+		return;
+
+	const double timeAtExportStart = Clock::GetAbsoluteTimeSeconds();
+	Profiler::ExportTrace( options.m_traceFilePath );
+	const double timeAtWriteStart = Clock::GetAbsoluteTimeSeconds();
+	Profiler::FinishTraceExport();
+	const double timeNow = Clock::GetAbsoluteTimeSeconds();
+	printf( "trace=%s window_seconds=%.2f export_us=%.1f write_ms=%.3f\n", options.m_traceFilePath.c_str(), options.m_traceWindowSeconds,
+		1e6 * (timeAtWriteStart - timeAtExportStart), 1000.0 * (timeNow - timeAtWriteStart) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Restarts the current scenario and steps it <numSteps> times; returns seconds spent stepping.
+//
+static double RunTimedSteps( const HeadlessOptions& options, SimulationStateHashLog& stateHashLog )
+{
+	theGame->StartScenarioByName( options.m_scenarioName );
+	Scenario& scenario = *theGame->GetCurrentScenario();
+	scenario.m_stateHashLog = &stateHashLog;
+	stateHashLog.Clear();
+	const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	for( int stepIndex = 0; stepIndex < options.m_numSteps; ++ stepIndex )
+	{
+		scenario.Update( options.m_deltaSeconds );
+	}
+
+	const double elapsedSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+	scenario.m_stateHashLog = NULL;
+	return elapsedSeconds > 0.0 ? elapsedSeconds : 1e-9;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Doubles, but stops at <maxThreads> rather than stepping over it.
+//
+static unsigned int GetNextSweepThreadCount( unsigned int numThreads, unsigned int maxThreads )
+{
+	if( numThreads < maxThreads && numThreads * 2 > maxThreads )
+		return maxThreads;
+
+	return numThreads * 2;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Times the serial double-buffered step, then the parallel one at 1, 2, 4... threads (and at
+//	m_maxSweepThreads itself), one line each.  Speedup is against the serial run; a parallel run
+//	whose combined state hash differs from the serial one is reported as a mismatch.  Returns
+//	the number of mismatches.
+//
+static int RunThreadSweep( const HeadlessOptions& options )
+{
+	SimulationStateHashLog stateHashLog;
+	theGame->SetSimulationUpdateMode( SIMULATION_UPDATE_DOUBLE_BUFFERED );
+	const double serialSeconds = RunTimedSteps( options, stateHashLog );
+	const SimulationStateHash serialHash = stateHashLog.GetCombinedHash();
+	const unsigned int numActors = theGame->GetCurrentScenario()->m_actors.GetNumActors();
+	printf( "thread_sweep scenario=%s mode=%s threads=1 actors=%u steps=%d seconds=%.6f steps_per_sec=%.1f speedup=1.00x state_hash=%016llx\n",
+		options.m_scenarioName.c_str(), SIMULATION_UPDATE_MODE_NAMES[ SIMULATION_UPDATE_DOUBLE_BUFFERED ], numActors, options.m_numSteps, serialSeconds,
+		(double) options.m_numSteps / serialSeconds, serialHash );
+
+	int numMismatches = 0;
+	theGame->SetSimulationUpdateMode( SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL );
+	for( unsigned int numThreads = 1; numThreads <= options.m_maxSweepThreads; numThreads = GetNextSweepThreadCount( numThreads, options.m_maxSweepThreads ) )
+	{
+		theGame->SetNumSimulationThreads( numThreads );
+		const double parallelSeconds = RunTimedSteps( options, stateHashLog );
+		const SimulationStateHash parallelHash = stateHashLog.GetCombinedHash();
+		if( parallelHash != serialHash )
+			++ numMismatches;
+
+		printf( "thread_sweep scenario=%s mode=%s threads=%u actors=%u steps=%d seconds=%.6f steps_per_sec=%.1f speedup=%.2fx state_hash=%016llx%s\n",
+			options.m_scenarioName.c_str(), SIMULATION_UPDATE_MODE_NAMES[ SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL ], numThreads, numActors, options.m_numSteps,
+			parallelSeconds, (double) options.m_numSteps / parallelSeconds, serialSeconds / parallelSeconds, parallelHash, parallelHash == serialHash ? "" : " MISMATCH" );
+	}
+
+	return numMismatches;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Restarts the scenario and steps (and renders, if asked to) it exactly as a capture run would,
+//	minus the capture.  Returns the loop's wall-clock seconds.
+//
+static double TimeUncapturedBaseline( const HeadlessOptions& options, bool isRendering )
+{
+	theGame->StartScenarioByName( options.m_scenarioName );
+	Scenario& scenario = *theGame->GetCurrentScenario();
+	const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	for( int stepIndex = 0; stepIndex < options.m_numSteps; ++ stepIndex )
+	{
+		scenario.Update( options.m_deltaSeconds );
+		if( isRendering )
+		{
+			scenario.Render( 1.f );
+			FlushGraphicsBatch();
+		}
+	}
+
+	const double baselineSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+	return baselineSeconds > 0.0 ? baselineSeconds : 1e-9;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	HeadlessOptions options;
+	if( !options.ParseCommandLine( argc, argv ) )
+	{
+		fprintf( stderr, "Usage: %s <scenarioName> [-steps N] [-dt seconds] [-threads N] [-mode in-place|double-buffered|parallel] [-render none|null|serialize|software] [-renderFile path] [-capture prefix] [-captureEvery N] [-captureFormat ppm|png] [-captureQueue N] [-captureDrop] [-pipeline] [-profile] [-trace path] [-traceWindow seconds] [-frameStats path] [-threadSweep N]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	theGame = new TheGame();
+	theGame->Startup( "" );
+	theGame->SetNumSimulationThreads( options.m_numThreads );
+	theGame->SetSimulationUpdateMode( options.m_updateMode );
+	theGame->StartScenarioByName( options.m_scenarioName );
+
+	Scenario* scenario = theGame->GetCurrentScenario();
+	if( !scenario )
+	{
+		fprintf( stderr, "Unknown scenario '%s'\n", options.m_scenarioName.c_str() );
+		theGame->Shutdown();
+		delete theGame;
+		return 1;
+	}
+
+	if( options.m_maxSweepThreads > 0 )
+	{
+		const int numMismatches = RunThreadSweep( options );
+		theGame->Shutdown();
+		delete theGame;
+		return numMismatches > 0 ? 2 : 0;
+	}
+
+	NullRenderBackend nullRenderBackend;
+	SerializingRenderBackend serializingRenderBackend;
+	SoftwareRenderBackend softwareRenderBackend( 1024, 576, GetViewBounds() );
+	ThreadPool rasterThreadPool;
+	FrameSequenceWriter frameWriter( 1024, 576, GetViewBounds(), options.m_maxPendingCaptureFrames );
+	const bool isCapturing = !options.m_capturePathPrefix.empty();
+	const bool isRendering = options.m_renderBackendName != "none";
+	if( options.m_renderBackendName == "null" )
+		SetRenderBackend( &nullRenderBackend );
+	else if( options.m_renderBackendName == "serialize" )
+		SetRenderBackend( &serializingRenderBackend );
+	else if( options.m_renderBackendName == "software" )
+	{
+		rasterThreadPool.Startup( options.m_numThreads > 1 ? options.m_numThreads - 1 : 0 );
+		softwareRenderBackend.SetThreadPool( &rasterThreadPool );
+		SetRenderBackend( &softwareRenderBackend );
+	}
+
+	double captureBaselineSeconds = 0.0;
+	if( isCapturing )
+	{
+		captureBaselineSeconds = TimeUncapturedBaseline( options, isRendering );
+		theGame->StartScenarioByName( options.m_scenarioName );
+		frameWriter.SetDropFramesWhenFull( options.m_isDroppingCaptureFramesWhenFull );
+		frameWriter.Start( options.m_capturePathPrefix, options.m_captureFormat );
+	}
+
+	if( options.m_isProfiling )
+	{
+		Profiler::SetEnabled( true );
+		Profiler::ResetAverages();
+		Profiler::SetTraceWindowSeconds( options.m_traceFilePath.empty() ? 0.0 : options.m_traceWindowSeconds );
+	}
+
+	if( options.m_isPipelined )
+	{
+		HeadlessPipeline pipeline;
+		pipeline.m_scenario = scenario;
+		pipeline.m_numSteps = options.m_numSteps;
+		pipeline.m_deltaSeconds = options.m_deltaSeconds;
+		int numFramesRendered = 0;
+		double numRenderCommands = 0.0;
+		const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+		ThreadHandle simulationThread = SysCreateThread( RunPipelinedSimulation, &pipeline );
+		const double renderSeconds = RenderPipelinedSnapshots( pipeline, numFramesRendered, numRenderCommands );
+		SysJoinThread( simulationThread );
+		const double wallSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+
+		// Serially, the same work would take simulation + render seconds; overlap is how much of that the threads hid
+		printf( "scenario=%s mode=%s actors=%u steps=%d pipeline=on wall_seconds=%.6f simulation_seconds=%.6f render_seconds=%.6f steps_per_sec=%.1f actor_updates_per_sec=%.1f\n",
+			scenario->m_name.c_str(), SIMULATION_UPDATE_MODE_NAMES[ options.m_updateMode ], scenario->m_actors.GetNumActors(), options.m_numSteps,
+			wallSeconds, pipeline.m_simulationSeconds, renderSeconds, (double) options.m_numSteps / wallSeconds, pipeline.m_numActorUpdates / wallSeconds );
+		printf( "render=%s frames_rendered=%d snapshots_skipped=%u render_ms_per_frame=%.3f render_commands_per_frame=%.1f overlap=%.2fx\n",
+			GetRenderBackend().GetName(), numFramesRendered, pipeline.m_snapshots.GetNumSnapshotsSkipped(),
+			numFramesRendered > 0 ? 1000.0 * renderSeconds / (double) numFramesRendered : 0.0, numFramesRendered > 0 ? numRenderCommands / (double) numFramesRendered : 0.0,
+			(pipeline.m_simulationSeconds + renderSeconds) / wallSeconds );
+		if( options.m_isProfiling )
+		{
+			PrintProfile( options );
+		}
+
+		if( !options.m_renderFilePath.empty() && !serializingRenderBackend.WriteLatestFrameToFile( options.m_renderFilePath ) )
+		{
+			fprintf( stderr, "Couldn't write '%s'\n", options.m_renderFilePath.c_str() );
+		}
+
+		SetRenderBackend( NULL );
+		rasterThreadPool.Shutdown();
+		theGame->Shutdown();
+		delete theGame;
+		return 0;
+	}
+
+	// Every actor gets exactly one Update (or UpdateAsPlayer) per step; render and capture time
+	//	spent on this thread are kept separate
+	const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	double renderSeconds = 0.0;
+	double captureSeconds = 0.0;
+	int numFramesCaptured = 0;
+	double numActorUpdates = 0.0;
+	double numRenderCommands = 0.0;
+	const bool isRecordingFrameStatistics = !options.m_frameStatisticsFilePath.empty();
+	FrameStatistics frameStatistics;
+	for( int stepIndex = 0; stepIndex < options.m_numSteps; ++ stepIndex )
+	{
+		const double timeAtStepStart = isRecordingFrameStatistics ? Clock::GetAbsoluteTimeSeconds() : 0.0;
+		scenario->Update( options.m_deltaSeconds );
+		const double timeAtUpdateEnd = isRecordingFrameStatistics ? Clock::GetAbsoluteTimeSeconds() : 0.0;
+		double renderSecondsThisStep = 0.0;
+		numActorUpdates += (double) scenario->m_actors.GetNumActors();
+		const bool isCaptureStep = isCapturing && stepIndex % options.m_captureEveryNSteps == 0;
+		if( isRendering || isCaptureStep )
+		{
+			const double timeAtRenderStart = Clock::GetAbsoluteTimeSeconds();
+			scenario->Render( 1.f );
+			if( isCaptureStep && frameWriter.SubmitFrame( GetRenderCommands(), stepIndex ) )
+			{
+				++ numFramesCaptured;
+			}
+
+			numRenderCommands += (double) GetRenderCommands().GetNumCommands();
+			FlushGraphicsBatch();
+			const double secondsThisStep = Clock::GetAbsoluteTimeSeconds() - timeAtRenderStart;
+			renderSecondsThisStep = secondsThisStep;
+			if( isRendering )
+				renderSeconds += secondsThisStep;
+			else
+				captureSeconds += secondsThisStep;
+		}
+
+		if( isRecordingFrameStatistics )
+		{
+			frameStatistics.RecordFrame( Clock::GetAbsoluteTimeSeconds() - timeAtStepStart, timeAtUpdateEnd - timeAtStepStart, renderSecondsThisStep );
+		}
+
+		if( options.m_isProfiling )
+		{
+			Profiler::EndFrame();
+		}
+	}
+	const double loopSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+	double elapsedSeconds = loopSeconds - renderSeconds - captureSeconds;
+	if( elapsedSeconds <= 0.0 )
+	{
+		elapsedSeconds = 1e-9;
+	}
+
+	printf( "scenario=%s mode=%s threads=%u actors=%u steps=%d dt=%f seconds=%.6f steps_per_sec=%.1f actor_updates_per_sec=%.1f\n",
+		scenario->m_name.c_str(), SIMULATION_UPDATE_MODE_NAMES[ options.m_updateMode ], options.m_updateMode == SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL ? options.m_numThreads : 1,
+		scenario->m_actors.GetNumActors(), options.m_numSteps, options.m_deltaSeconds, elapsedSeconds,
+		(double) options.m_numSteps / elapsedSeconds, numActorUpdates / elapsedSeconds );
+
+	if( isRendering )
+	{
+		if( renderSeconds <= 0.0 )
+		{
+			renderSeconds = 1e-9;
+		}
+
+		printf( "render=%s render_seconds=%.6f render_ms_per_frame=%.3f render_commands_per_frame=%.1f render_commands_per_sec=%.1f\n",
+			GetRenderBackend().GetName(), renderSeconds, 1000.0 * renderSeconds / (double) options.m_numSteps,
+			numRenderCommands / (double) options.m_numSteps, numRenderCommands / renderSeconds );
+	}
+
+	if( isCapturing )
+	{
+		const double timeAtFinishStart = Clock::GetAbsoluteTimeSeconds();
+		frameWriter.Finish();
+		const double drainSeconds = Clock::GetAbsoluteTimeSeconds() - timeAtFinishStart;
+
+		// The faster of runs from either side, so neither a cold start nor the caches the writer
+		//	trashed while draining count in capture's favor (this leaves the scenario in the same
+		//	final state as the capture run)
+		const double laterBaselineSeconds = TimeUncapturedBaseline( options, isRendering );
+		if( laterBaselineSeconds < captureBaselineSeconds )
+		{
+			captureBaselineSeconds = laterBaselineSeconds;
+		}
+		const double captureRecordSeconds = isRendering ? 0.0 : captureSeconds - frameWriter.GetSecondsBlockedInSubmit();
+
+		// Overhead is everything capture added to this thread's loop -- recording, handing off,
+		//	time blocked on a full queue, and any time the writer thread took the core -- against the
+		//	uncaptured baseline.  Blocking or dropping means the writer is the bottleneck (capture
+		//	less often, deepen the queue, or add cores); draining happens after the loop.
+		printf( "capture=%s format=%s frames=%d written=%u failed=%u dropped=%u queue=%u baseline_seconds=%.6f loop_seconds=%.6f capture_record_seconds=%.6f blocked_seconds=%.6f capture_overhead=%.2f%% drain_seconds=%.6f\n",
+			options.m_capturePathPrefix.c_str(), FRAME_IMAGE_FORMAT_EXTENSIONS[ options.m_captureFormat ], numFramesCaptured,
+			frameWriter.GetNumFramesWritten(), frameWriter.GetNumWriteFailures(), frameWriter.GetNumFramesDropped(), frameWriter.GetMaxPendingFrames(),
+			captureBaselineSeconds, loopSeconds, captureRecordSeconds, frameWriter.GetSecondsBlockedInSubmit(),
+			100.0 * (loopSeconds - captureBaselineSeconds) / captureBaselineSeconds, drainSeconds );
+	}
+
+	if( options.m_isProfiling )
+	{
+		PrintProfile( options );
+	}
+
+	if( isRecordingFrameStatistics )
+	{
+		for( int channelIndex = 0; channelIndex < NUM_FRAME_TIME_CHANNELS; ++ channelIndex )
+		{
+			const FrameTimeSummary summary = frameStatistics.CalcTotalSummary( (FrameTimeChannel) channelIndex );
+			printf( "frame_stats=%s frames=%u mean_ms=%.3f p50_ms=%.3f p95_ms=%.3f p99_ms=%.3f max_ms=%.3f\n", FRAME_TIME_CHANNEL_NAMES[ channelIndex ],
+				summary.m_numSamples, 1000.0 * summary.m_meanSeconds, 1000.0 * summary.m_p50Seconds, 1000.0 * summary.m_p95Seconds,
+				1000.0 * summary.m_p99Seconds, 1000.0 * summary.m_maxSeconds );
+		}
+
+		if( !frameStatistics.WriteJsonFile( options.m_frameStatisticsFilePath ) )
+		{
+			fprintf( stderr, "Couldn't write '%s'\n", options.m_frameStatisticsFilePath.c_str() );
+		}
+	}
+
+	if( !options.m_renderFilePath.empty() && !serializingRenderBackend.WriteLatestFrameToFile( options.m_renderFilePath ) )
+	{
+		fprintf( stderr, "Couldn't write '%s'\n", options.m_renderFilePath.c_str() );
+	}
+
+	SetRenderBackend( NULL );
+	rasterThreadPool.Shutdown();
+
+	theGame->Shutdown();
+	delete theGame;
+	return 0;
+}
@@ -97,6 +97,7 @@ int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR comman
 	theGame = new TheGame;
 	CreateOpenGLWindow( applicationInstanceHandle );
 	theGame->Startup( commandLineString );
+	theGame->SetSimulationThreaded( true ); // F3 toggles back to stepping on this thread
 
 	while( theGame->IsRunning() )
 	{
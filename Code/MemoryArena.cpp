@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------------------------
+// MemoryArena.cpp
+//-----------------------------------------------------------------------------------------------
+#include "MemoryArena.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+MemoryArena::MemoryArena( size_t blockSizeBytes )
+	: m_blockSizeBytes( blockSizeBytes )
+	, m_firstBlock( NULL )
+	, m_currentBlock( NULL )
+	, m_cursor( NULL )
+	, m_currentBlockEnd( NULL )
+	, m_numBytesUsedInPreviousBlocks( 0 )
+	, m_numBytesReserved( 0 )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+MemoryArena::~MemoryArena()
+{
+	FreeAllBlocks();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Rewinds to the first block; nothing is freed and no destructors are run.
+//
+void MemoryArena::Reset()
+{
+	m_currentBlock = m_firstBlock;
+	m_cursor = CalcBlockDataStart( m_firstBlock );
+	m_currentBlockEnd = m_firstBlock ? m_cursor + m_firstBlock->m_dataSizeBytes : NULL;
+	m_numBytesUsedInPreviousBlocks = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MemoryArena::FreeAllBlocks()
+{
+	Block* block = m_firstBlock;
+	while( block )
+	{
+		Block* nextBlock = block->m_nextBlock;
+		free( block );
+		block = nextBlock;
+	}
+
+	m_firstBlock = NULL;
+	m_numBytesReserved = 0;
+	Reset();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Slow path for Allocate(): moves on to the next block, reusing one kept from before the last
+//	Reset() if it is big enough, or else inserting a new one (oversized, for oversized requests).
+//
+void* MemoryArena::AllocateFromNextBlock( size_t numBytes )
+{
+	if( m_currentBlock )
+	{
+		m_numBytesUsedInPreviousBlocks += m_currentBlock->m_dataSizeBytes;
+	}
+
+	Block* nextBlock = m_currentBlock ? m_currentBlock->m_nextBlock : m_firstBlock;
+	if( !nextBlock || nextBlock->m_dataSizeBytes < numBytes )
+	{
+		const size_t dataSizeBytes = numBytes > m_blockSizeBytes ? numBytes : m_blockSizeBytes;
+		Block* newBlock = (Block*) malloc( CalcBlockHeaderSize() + dataSizeBytes );
+		newBlock->m_nextBlock = nextBlock;
+		newBlock->m_dataSizeBytes = dataSizeBytes;
+		m_numBytesReserved += dataSizeBytes;
+		if( m_currentBlock )
+		{
+			m_currentBlock->m_nextBlock = newBlock;
+		}
+		else
+		{
+			m_firstBlock = newBlock;
+		}
+
+		nextBlock = newBlock;
+	}
+
+	m_currentBlock = nextBlock;
+	m_cursor = CalcBlockDataStart( nextBlock ) + numBytes;
+	m_currentBlockEnd = CalcBlockDataStart( nextBlock ) + nextBlock->m_dataSizeBytes;
+	return CalcBlockDataStart( nextBlock );
+}
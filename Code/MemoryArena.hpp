@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------------------------
+// MemoryArena.hpp
+//
+// Monotonic ("bump pointer") allocator, plus an STL allocator adapter so containers can live in one.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_MemoryArena__
+#define __include_MemoryArena__
+#pragma once
+#include "Utilities.hpp"
+#include <new>
+
+
+//-----------------------------------------------------------------------------------------------
+// Definitions
+//
+const size_t DEFAULT_MEMORY_ARENA_BLOCK_SIZE_BYTES = 64 * 1024;
+const size_t MEMORY_ARENA_ALIGNMENT_BYTES = 16; // enough for any built-in or SSE type
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Hands out memory from large blocks, front to back; individual allocations are never freed.
+//	Reset() rewinds to the start of the first block in O(1), keeping every block for reuse, so a
+//	workload that is torn down and rebuilt repeatedly stops touching the heap after the first time.
+//
+// Reset() runs no destructors: anything placed in an arena must either be trivially destructible
+//	or own only memory that also came from the arena (see ArenaAllocator).
+//
+class MemoryArena
+{
+public:
+	explicit MemoryArena( size_t blockSizeBytes = DEFAULT_MEMORY_ARENA_BLOCK_SIZE_BYTES );
+	~MemoryArena();
+	void* Allocate( size_t numBytes );
+	void Reset();
+	void FreeAllBlocks();
+	size_t GetNumBytesUsed() const { return m_numBytesUsedInPreviousBlocks + (m_cursor - CalcBlockDataStart( m_currentBlock )); }
+	size_t GetNumBytesReserved() const { return m_numBytesReserved; }
+
+	template< typename T > T* New() { return new( Allocate( sizeof( T ) ) ) T(); }
+
+private:
+	struct Block
+	{
+		Block* m_nextBlock;
+		size_t m_dataSizeBytes;
+	};
+
+	MemoryArena( const MemoryArena& ); // not copyable
+	void operator = ( const MemoryArena& );
+	static size_t CalcBlockHeaderSize();
+	static unsigned char* CalcBlockDataStart( Block* block );
+	void* AllocateFromNextBlock( size_t numBytes );
+
+private:
+	size_t m_blockSizeBytes;
+	Block* m_firstBlock;
+	Block* m_currentBlock;
+	unsigned char* m_cursor;
+	unsigned char* m_currentBlockEnd;
+	size_t m_numBytesUsedInPreviousBlocks; // bytes consumed (including end-of-block waste) before m_currentBlock
+	size_t m_numBytesReserved;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Each block's data starts just past its header, rounded up to the arena alignment.
+//
+inline size_t MemoryArena::CalcBlockHeaderSize()
+{
+	return (sizeof( Block ) + MEMORY_ARENA_ALIGNMENT_BYTES - 1) & ~(MEMORY_ARENA_ALIGNMENT_BYTES - 1);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline unsigned char* MemoryArena::CalcBlockDataStart( Block* block )
+{
+	return block ? reinterpret_cast< unsigned char* >( block ) + CalcBlockHeaderSize() : NULL;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void* MemoryArena::Allocate( size_t numBytes )
+{
+	const size_t alignedNumBytes = (numBytes + MEMORY_ARENA_ALIGNMENT_BYTES - 1) & ~(MEMORY_ARENA_ALIGNMENT_BYTES - 1);
+	if( alignedNumBytes > (size_t)( m_currentBlockEnd - m_cursor ) )
+		return AllocateFromNextBlock( alignedNumBytes );
+
+	void* allocation = m_cursor;
+	m_cursor += alignedNumBytes;
+	return allocation;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard-library allocator that draws from a MemoryArena; deallocate() does nothing, since the
+//	arena reclaims everything at once.  Containers using it must be constructed with an instance.
+//
+template< typename T >
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	template< typename U > struct rebind { typedef ArenaAllocator< U > other; };
+
+	explicit ArenaAllocator( MemoryArena& arena ) : m_arena( &arena ) {}
+	template< typename U > ArenaAllocator( const ArenaAllocator< U >& copyFrom ) : m_arena( copyFrom.m_arena ) {}
+
+	pointer address( reference value ) const { return &value; }
+	const_pointer address( const_reference value ) const { return &value; }
+	pointer allocate( size_type numElements, const void* hint = NULL ) { UNUSED( hint ); return static_cast< pointer >( m_arena->Allocate( numElements * sizeof( T ) ) ); }
+	void deallocate( pointer elements, size_type numElements ) { UNUSED( elements ); UNUSED( numElements ); }
+	size_type max_size() const { return ((size_type) -1) / sizeof( T ); }
+	void construct( pointer element, const T& value ) { new( (void*) element ) T( value ); }
+	void destroy( pointer element ) { UNUSED( element ); element->~T(); }
+
+	bool operator == ( const ArenaAllocator& other ) const { return m_arena == other.m_arena; }
+	bool operator != ( const ArenaAllocator& other ) const { return m_arena != other.m_arena; }
+
+	MemoryArena* m_arena;
+};
+
+
+#endif // __include_MemoryArena__
@@ -0,0 +1,533 @@
+//-----------------------------------------------------------------------------------------------
+// ProfilingSection.cpp
+//-----------------------------------------------------------------------------------------------
+#include "ProfilingSection.hpp"
+#include "ProfilingTrace.hpp"
+#include "Clock.hpp"
+#include "Threading.hpp"
+#include <string.h>
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#define JAZZ_PROFILING_USE_RDTSC
+#elif defined( __i386__ ) || defined( __x86_64__ )
+#include <x86intrin.h>
+#define JAZZ_PROFILING_USE_RDTSC
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const unsigned int PROFILING_EVENTS_PER_THREAD = 65536; // must be a power of two
+const double PROFILING_CALIBRATION_SECONDS = 0.002; // spent once, the first time profiling is enabled
+const unsigned int PROFILING_TRACE_MAX_EVENTS = 524288; // the window gets shorter than asked for, rather than any bigger (16MB)
+bool g_isProfilingEnabled = false;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class ProfilingEvent
+{
+public:
+	const char* m_sectionName; // NULL for the end of a section
+	ProfilingTicks m_ticks;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// One place a section was entered from; the same section called from two parents is two nodes.
+//
+class ProfilingNode
+{
+public:
+	ProfilingNode( const char* name, int parentIndex, int depth );
+	void ResetFrame() { m_numCallsThisFrame = 0; m_inclusiveTicksThisFrame = 0; m_childTicksThisFrame = 0; }
+	void ResetTotals() { m_numCallsTotal = 0; m_inclusiveTicksTotal = 0; m_childTicksTotal = 0; }
+
+	const char* m_name;
+	int m_parentIndex;
+	int m_depth;
+	std::vector< int > m_childIndices;
+	unsigned int m_numCallsThisFrame;
+	ProfilingTicks m_inclusiveTicksThisFrame;
+	ProfilingTicks m_childTicksThisFrame;
+	unsigned int m_numCallsTotal;
+	ProfilingTicks m_inclusiveTicksTotal;
+	ProfilingTicks m_childTicksTotal;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class ProfilingOpenSection
+{
+public:
+	int m_nodeIndex;
+	ProfilingTicks m_beginTicks;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// A single-producer, single-consumer ring of events.  The recording thread only ever writes
+//	m_numEventsWritten and EndFrame only ever writes m_numEventsRead, so neither waits on the
+//	other; a begin is dropped (along with everything inside it) unless there's room for it and
+//	for the end of every section still open.
+//
+class ProfilingThreadBuffer
+{
+public:
+	explicit ProfilingThreadBuffer( unsigned int threadIndex );
+	void Record( const char* sectionName, ProfilingTicks ticks );
+	void Gather();
+	int FindOrAddChildNode( int parentIndex, const char* sectionName );
+	void AppendReportRows( int nodeIndex, bool isFrameReport, double numFramesAveraged, OUTPUT std::vector< ProfilingReportRow >& rows ) const;
+
+	// Shared
+	std::vector< ProfilingEvent > m_events;
+	volatile long m_isInUse; // by a thread that hasn't released it
+	volatile unsigned int m_numEventsWritten;
+	volatile unsigned int m_numEventsRead;
+	volatile unsigned int m_numEventsDropped;
+
+	// Recording thread only
+	unsigned int m_numOpenSectionsRecorded;
+	unsigned int m_numOpenSectionsDropped;
+
+	// EndFrame only
+	unsigned int m_threadIndex;
+	std::vector< ProfilingNode > m_nodes; // [0] is the root; its children are the top-level sections
+	std::vector< ProfilingOpenSection > m_openSections;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Static state
+//
+static CriticalSection s_threadBuffersLock; // taken when a thread records its first section, and by EndFrame; never while recording
+static std::vector< ProfilingThreadBuffer* > s_threadBuffers;
+static JAZZ_THREAD_LOCAL ProfilingThreadBuffer* s_threadBuffer = NULL;
+static double s_secondsPerTick = 0.0;
+static unsigned int s_numFramesAveraged = 0;
+static double s_traceWindowSeconds = 0.0;
+static ProfilingTraceEvents s_traceWindow; // oldest first; only touched by the thread calling EndFrame
+static ProfilingTraceWriter s_traceWriter;
+
+
+//-----------------------------------------------------------------------------------------------
+// The TSC on x86 (assumed invariant, as on anything recent); Clock's counter elsewhere.
+//
+static inline ProfilingTicks GetProfilingTicks()
+{
+#if defined( JAZZ_PROFILING_USE_RDTSC )
+	return (ProfilingTicks) __rdtsc();
+#else
+	return (ProfilingTicks)( Clock::GetAbsoluteTimeSeconds() * 1000000000.0 );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void CalibrateProfilingTicks()
+{
+#if defined( JAZZ_PROFILING_USE_RDTSC )
+	const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	const ProfilingTicks ticksAtStart = GetProfilingTicks();
+	double timeNow = timeAtStart;
+	while( timeNow - timeAtStart < PROFILING_CALIBRATION_SECONDS )
+	{
+		timeNow = Clock::GetAbsoluteTimeSeconds();
+	}
+
+	const ProfilingTicks ticksNow = GetProfilingTicks();
+	s_secondsPerTick = (timeNow - timeAtStart) / (double)( ticksNow - ticksAtStart );
+#else
+	s_secondsPerTick = 0.000000001;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Claims a released buffer if there is one, so threads that come and go don't each leave one behind.
+//
+static ProfilingThreadBuffer& GetThreadBuffer()
+{
+	if( s_threadBuffer )
+		return *s_threadBuffer;
+
+	ScopedCriticalSection lock( s_threadBuffersLock );
+	for( unsigned int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); ++ bufferIndex )
+	{
+		if( AtomicCompareAndSwap( s_threadBuffers[ bufferIndex ]->m_isInUse, 0, 1 ) == 0 )
+		{
+			s_threadBuffer = s_threadBuffers[ bufferIndex ];
+			return *s_threadBuffer;
+		}
+	}
+
+	s_threadBuffer = new ProfilingThreadBuffer( (unsigned int) s_threadBuffers.size() );
+	s_threadBuffers.push_back( s_threadBuffer );
+	return *s_threadBuffer;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Ends are timed on the way in and begins on the way out, to leave the bookkeeping out of the section.
+//
+void RecordProfilingEvent( const char* sectionName )
+{
+	if( sectionName )
+	{
+		ProfilingThreadBuffer& buffer = GetThreadBuffer();
+		buffer.Record( sectionName, GetProfilingTicks() );
+	}
+	else
+	{
+		const ProfilingTicks ticksAtEnd = GetProfilingTicks();
+		GetThreadBuffer().Record( NULL, ticksAtEnd );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ProfilingNode::ProfilingNode( const char* name, int parentIndex, int depth )
+	: m_name( name )
+	, m_parentIndex( parentIndex )
+	, m_depth( depth )
+{
+	ResetFrame();
+	ResetTotals();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ProfilingThreadBuffer::ProfilingThreadBuffer( unsigned int threadIndex )
+	: m_events( PROFILING_EVENTS_PER_THREAD )
+	, m_isInUse( 1 )
+	, m_numEventsWritten( 0 )
+	, m_numEventsRead( 0 )
+	, m_numEventsDropped( 0 )
+	, m_numOpenSectionsRecorded( 0 )
+	, m_numOpenSectionsDropped( 0 )
+	, m_threadIndex( threadIndex )
+{
+	m_nodes.push_back( ProfilingNode( "", -1, -1 ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ProfilingThreadBuffer::Record( const char* sectionName, ProfilingTicks ticks )
+{
+	const unsigned int numEventsWritten = m_numEventsWritten;
+	if( sectionName )
+	{
+		const unsigned int numEventsPending = numEventsWritten - m_numEventsRead;
+		if( m_numOpenSectionsDropped > 0 || numEventsPending + m_numOpenSectionsRecorded + 2 > PROFILING_EVENTS_PER_THREAD )
+		{
+			++ m_numOpenSectionsDropped;
+			m_numEventsDropped = m_numEventsDropped + 1;
+			return;
+		}
+
+		++ m_numOpenSectionsRecorded;
+	}
+	else if( m_numOpenSectionsDropped > 0 )
+	{
+		-- m_numOpenSectionsDropped;
+		return;
+	}
+	else if( m_numOpenSectionsRecorded > 0 )
+	{
+		-- m_numOpenSectionsRecorded;
+	}
+	else
+	{
+		return; // began on another thread (or before this buffer was claimed)
+	}
+
+	ProfilingEvent& event = m_events[ numEventsWritten & (PROFILING_EVENTS_PER_THREAD - 1) ];
+	event.m_sectionName = sectionName;
+	event.m_ticks = ticks;
+	MemoryBarrier_Full(); // the event must be visible before the count that covers it
+	m_numEventsWritten = numEventsWritten + 1;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Folds every event recorded since the last Gather into the call tree.
+//
+void ProfilingThreadBuffer::Gather()
+{
+	const unsigned int numEventsWritten = m_numEventsWritten;
+	MemoryBarrier_Full();
+	for( unsigned int eventNumber = m_numEventsRead; eventNumber != numEventsWritten; ++ eventNumber )
+	{
+		const ProfilingEvent& event = m_events[ eventNumber & (PROFILING_EVENTS_PER_THREAD - 1) ];
+		if( event.m_sectionName )
+		{
+			ProfilingOpenSection openSection;
+			openSection.m_nodeIndex = FindOrAddChildNode( m_openSections.empty() ? 0 : m_openSections.back().m_nodeIndex, event.m_sectionName );
+			openSection.m_beginTicks = event.m_ticks;
+			m_openSections.push_back( openSection );
+		}
+		else if( !m_openSections.empty() )
+		{
+			const ProfilingOpenSection& openSection = m_openSections.back();
+			const ProfilingTicks elapsedTicks = event.m_ticks - openSection.m_beginTicks;
+			ProfilingNode& node = m_nodes[ openSection.m_nodeIndex ];
+			++ node.m_numCallsThisFrame;
+			node.m_inclusiveTicksThisFrame += elapsedTicks;
+			++ node.m_numCallsTotal;
+			node.m_inclusiveTicksTotal += elapsedTicks;
+
+			ProfilingNode& parentNode = m_nodes[ node.m_parentIndex ];
+			parentNode.m_childTicksThisFrame += elapsedTicks;
+			parentNode.m_childTicksTotal += elapsedTicks;
+			if( s_traceWindowSeconds > 0.0 )
+			{
+				ProfilingTraceEvent traceEvent;
+				traceEvent.m_name = node.m_name;
+				traceEvent.m_threadIndex = m_threadIndex;
+				traceEvent.m_beginTicks = openSection.m_beginTicks;
+				traceEvent.m_endTicks = event.m_ticks;
+				s_traceWindow.push_back( traceEvent );
+			}
+
+			m_openSections.pop_back();
+		}
+	}
+
+	MemoryBarrier_Full(); // done reading the events before the writer may reuse their slots
+	m_numEventsRead = numEventsWritten;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Section names are usually literals from a single call site, so the pointer compare nearly
+//	always decides; the same name from two places still shares a node.
+//
+int ProfilingThreadBuffer::FindOrAddChildNode( int parentIndex, const char* sectionName )
+{
+	const std::vector< int >& childIndices = m_nodes[ parentIndex ].m_childIndices;
+	for( unsigned int childNumber = 0; childNumber < childIndices.size(); ++ childNumber )
+	{
+		const char* childName = m_nodes[ childIndices[ childNumber ] ].m_name;
+		if( childName == sectionName || strcmp( childName, sectionName ) == 0 )
+			return childIndices[ childNumber ];
+	}
+
+	const int childIndex = (int) m_nodes.size();
+	m_nodes.push_back( ProfilingNode( sectionName, parentIndex, m_nodes[ parentIndex ].m_depth + 1 ) );
+	m_nodes[ parentIndex ].m_childIndices.push_back( childIndex );
+	return childIndex;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Appends <nodeIndex>'s children, each followed by its own subtree, skipping any not called.
+//
+void ProfilingThreadBuffer::AppendReportRows( int nodeIndex, bool isFrameReport, double numFramesAveraged, OUTPUT std::vector< ProfilingReportRow >& rows ) const
+{
+	const std::vector< int >& childIndices = m_nodes[ nodeIndex ].m_childIndices;
+	for( unsigned int childNumber = 0; childNumber < childIndices.size(); ++ childNumber )
+	{
+		const ProfilingNode& child = m_nodes[ childIndices[ childNumber ] ];
+		const unsigned int numCalls = isFrameReport ? child.m_numCallsThisFrame : child.m_numCallsTotal;
+		if( numCalls == 0 )
+			continue;
+
+		const ProfilingTicks inclusiveTicks = isFrameReport ? child.m_inclusiveTicksThisFrame : child.m_inclusiveTicksTotal;
+		const ProfilingTicks childTicks = isFrameReport ? child.m_childTicksThisFrame : child.m_childTicksTotal;
+		ProfilingReportRow row;
+		row.m_name = child.m_name;
+		row.m_threadIndex = m_threadIndex;
+		row.m_depth = child.m_depth;
+		row.m_numCalls = (double) numCalls / numFramesAveraged;
+		row.m_inclusiveSeconds = s_secondsPerTick * (double) inclusiveTicks / numFramesAveraged;
+		row.m_exclusiveSeconds = s_secondsPerTick * (double)( inclusiveTicks > childTicks ? inclusiveTicks - childTicks : 0 ) / numFramesAveraged;
+		rows.push_back( row );
+		AppendReportRows( childIndices[ childNumber ], isFrameReport, numFramesAveraged, rows );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::SetEnabled( bool isEnabled )
+{
+	if( isEnabled && s_secondsPerTick == 0.0 )
+	{
+		CalibrateProfilingTicks();
+	}
+
+	g_isProfilingEnabled = isEnabled;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::EndFrame()
+{
+	ScopedCriticalSection lock( s_threadBuffersLock );
+	for( unsigned int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); ++ bufferIndex )
+	{
+		ProfilingThreadBuffer& buffer = *s_threadBuffers[ bufferIndex ];
+		for( unsigned int nodeIndex = 0; nodeIndex < buffer.m_nodes.size(); ++ nodeIndex )
+		{
+			buffer.m_nodes[ nodeIndex ].ResetFrame();
+		}
+
+		buffer.Gather();
+	}
+
+	++ s_numFramesAveraged;
+	if( s_traceWindowSeconds > 0.0 && s_secondsPerTick > 0.0 )
+	{
+		// Mark the frame, then drop whatever has fallen out of the window (sections end roughly in
+		//	order, so anything old left behind a newer one goes soon after)
+		ProfilingTraceEvent frameEvent;
+		frameEvent.m_name = NULL;
+		frameEvent.m_threadIndex = s_threadBuffer ? s_threadBuffer->m_threadIndex : 0;
+		frameEvent.m_beginTicks = GetProfilingTicks();
+		frameEvent.m_endTicks = frameEvent.m_beginTicks;
+		s_traceWindow.push_back( frameEvent );
+
+		const ProfilingTicks windowTicks = (ProfilingTicks)( s_traceWindowSeconds / s_secondsPerTick );
+		const ProfilingTicks oldestTicksKept = frameEvent.m_endTicks > windowTicks ? frameEvent.m_endTicks - windowTicks : 0;
+		while( !s_traceWindow.empty() && (s_traceWindow.front().m_endTicks < oldestTicksKept || s_traceWindow.size() > PROFILING_TRACE_MAX_EVENTS) )
+		{
+			s_traceWindow.pop_front();
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::GetFrameReport( OUTPUT std::vector< ProfilingReportRow >& rows )
+{
+	rows.clear();
+	ScopedCriticalSection lock( s_threadBuffersLock );
+	for( unsigned int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); ++ bufferIndex )
+	{
+		s_threadBuffers[ bufferIndex ]->AppendReportRows( 0, true, 1.0, rows );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::GetAverageReport( OUTPUT std::vector< ProfilingReportRow >& rows )
+{
+	rows.clear();
+	if( s_numFramesAveraged == 0 )
+		return;
+
+	ScopedCriticalSection lock( s_threadBuffersLock );
+	for( unsigned int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); ++ bufferIndex )
+	{
+		s_threadBuffers[ bufferIndex ]->AppendReportRows( 0, false, (double) s_numFramesAveraged, rows );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC unsigned int Profiler::GetNumFramesAveraged()
+{
+	return s_numFramesAveraged;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::ResetAverages()
+{
+	ScopedCriticalSection lock( s_threadBuffersLock );
+	for( unsigned int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); ++ bufferIndex )
+	{
+		ProfilingThreadBuffer& buffer = *s_threadBuffers[ bufferIndex ];
+		for( unsigned int nodeIndex = 0; nodeIndex < buffer.m_nodes.size(); ++ nodeIndex )
+		{
+			buffer.m_nodes[ nodeIndex ].ResetTotals();
+		}
+	}
+
+	s_numFramesAveraged = 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC unsigned int Profiler::GetNumEventsDropped()
+{
+	ScopedCriticalSection lock( s_threadBuffersLock );
+	unsigned int numEventsDropped = 0;
+	for( unsigned int bufferIndex = 0; bufferIndex < s_threadBuffers.size(); ++ bufferIndex )
+	{
+		numEventsDropped += s_threadBuffers[ bufferIndex ]->m_numEventsDropped;
+	}
+
+	return numEventsDropped;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// One line per row, indented by depth, under a heading for each thread.
+//
+STATIC std::string Profiler::FormatReport( const std::vector< ProfilingReportRow >& rows )
+{
+	std::string report;
+	for( unsigned int rowIndex = 0; rowIndex < rows.size(); ++ rowIndex )
+	{
+		const ProfilingReportRow& row = rows[ rowIndex ];
+		if( rowIndex == 0 || row.m_threadIndex != rows[ rowIndex - 1 ].m_threadIndex )
+		{
+			report += Stringf( "  thread %u:\n", row.m_threadIndex );
+		}
+
+		const int indent = 4 + (2 * row.m_depth);
+		report += Stringf( "%*s%-*s calls %9.1f  inclusive %9.3fms  exclusive %9.3fms\n", indent, "", MaxInt( 40 - indent, 1 ), row.m_name,
+			row.m_numCalls, 1000.0 * row.m_inclusiveSeconds, 1000.0 * row.m_exclusiveSeconds );
+	}
+
+	return report;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::ReleaseThread()
+{
+	if( !s_threadBuffer )
+		return;
+
+	AtomicExchange( s_threadBuffer->m_isInUse, 0 );
+	s_threadBuffer = NULL;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Sections are kept from the time they're gathered, so profiling must be enabled to fill the window.
+//
+STATIC void Profiler::SetTraceWindowSeconds( double windowSeconds )
+{
+	s_traceWindowSeconds = windowSeconds > 0.0 ? windowSeconds : 0.0;
+	if( s_traceWindowSeconds == 0.0 )
+	{
+		s_traceWindow.clear();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Call from the thread that calls EndFrame.
+//
+STATIC bool Profiler::ExportTrace( const std::string& filePath )
+{
+	return s_traceWriter.Start( filePath, s_traceWindow, s_secondsPerTick );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool Profiler::IsExportingTrace()
+{
+	return s_traceWriter.IsWriting();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::FinishTraceExport()
+{
+	s_traceWriter.Finish();
+}
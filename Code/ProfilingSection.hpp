@@ -2,7 +2,11 @@
 // ProfilingSection.hpp
 //
 // A class we can use to profile our code by simply instantiating a temp local instance in
-// the function to be timed (the object uses 
+// the function to be timed (the object uses its constructor and destructor to mark where the
+// section begins and ends).  Sections nest, and each thread records into its own lock-free
+// buffer; once per frame, Profiler::EndFrame gathers every thread's events into a call tree
+// with call counts and inclusive/exclusive times, and (if a trace window is set) keeps the last
+// few seconds of them for export as a Chrome trace.
 //-----------------------------------------------------------------------------------------------
 #ifndef __include_ProfilingSection__
 #define __include_ProfilingSection__
@@ -10,7 +14,78 @@
 #include "Utilities.hpp"
 
 
+//-----------------------------------------------------------------------------------------------
+// Definitions
+//
+#define PROFILE_SECTION_CONCATENATE_INNER( a, b ) a##b
+#define PROFILE_SECTION_CONCATENATE( a, b ) PROFILE_SECTION_CONCATENATE_INNER( a, b )
+#define PROFILE_SECTION( sectionName ) ProfilingSection PROFILE_SECTION_CONCATENATE( profilingSection_, __LINE__ )( sectionName )
+
+typedef unsigned long long ProfilingTicks;
+
+extern bool g_isProfilingEnabled;
+
+
+//-----------------------------------------------------------------------------------------------
+// Profiling utility functions
+//
+void RecordProfilingEvent( const char* sectionName ); // NULL ends the innermost open section
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// <sectionName> must outlive the profiler (a string literal, normally).  A section that began
+//	while profiling was enabled still ends if profiling is disabled in the meantime.
+//
+class ProfilingSection
+{
+public:
+	explicit ProfilingSection( const char* sectionName ) : m_isRecording( g_isProfilingEnabled ) { if( m_isRecording ) RecordProfilingEvent( sectionName ); }
+	~ProfilingSection() { if( m_isRecording ) RecordProfilingEvent( NULL ); }
+
+private:
+	bool m_isRecording;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// One section in a report; rows come in depth-first order, a thread's top-level sections first.
+//
+class ProfilingReportRow
+{
+public:
+	const char* m_name;
+	unsigned int m_threadIndex; // order in which threads first recorded a section
+	int m_depth; // 0 for a thread's top-level sections
+	double m_numCalls;
+	double m_inclusiveSeconds;
+	double m_exclusiveSeconds; // inclusive, less the inclusive time of its child sections
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// EndFrame, the reports and ResetAverages must all be called from the same thread; sections can
+//	be recorded on any thread.  A section is counted in the frame in which it ends.
+//
+class Profiler
+{
+public:
+	static void SetEnabled( bool isEnabled );
+	static bool IsEnabled() { return g_isProfilingEnabled; }
+	static void EndFrame();
+	static void GetFrameReport( OUTPUT std::vector< ProfilingReportRow >& rows ); // the last frame EndFrame gathered
+	static void GetAverageReport( OUTPUT std::vector< ProfilingReportRow >& rows ); // per frame, since ResetAverages
+	static unsigned int GetNumFramesAveraged();
+	static void ResetAverages();
+	static unsigned int GetNumEventsDropped(); // sections left out because a thread's buffer was full
+	static std::string FormatReport( const std::vector< ProfilingReportRow >& rows );
+	static void ReleaseThread(); // call before a thread that recorded sections exits, so its buffer can be reused
 
+	// Trace export; the window is taken by ExportTrace, so the next one starts empty
+	static void SetTraceWindowSeconds( double windowSeconds ); // zero (the default) keeps no window
+	static bool ExportTrace( const std::string& filePath ); // false if the last export is still being written
+	static bool IsExportingTrace();
+	static void FinishTraceExport(); // waits for the file; call before exiting
+};
 
 
 #endif // __include_ProfilingSection__
@@ -0,0 +1,151 @@
+//-----------------------------------------------------------------------------------------------
+// ProfilingTrace.cpp
+//-----------------------------------------------------------------------------------------------
+#include "ProfilingTrace.hpp"
+#include <stdio.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const int PROFILING_TRACE_FILE_BUFFER_BYTES = 1 << 20;
+
+
+//-----------------------------------------------------------------------------------------------
+// Section names are string literals, but nothing stops one from holding a quote or backslash.
+//
+static void WriteJsonString( FILE* file, const char* text )
+{
+	fputc( '"', file );
+	for( const char* character = text; *character; ++ character )
+	{
+		if( *character == '"' || *character == '\\' )
+		{
+			fputc( '\\', file );
+		}
+
+		fputc( *character, file );
+	}
+
+	fputc( '"', file );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ProfilingTraceWriter::ProfilingTraceWriter()
+	: m_writerThread( NULL )
+	, m_isFinished( 0 )
+	, m_numTracesWritten( 0 )
+	, m_numWriteFailures( 0 )
+	, m_secondsPerTick( 0.0 )
+	, m_wasWriteSuccessful( false )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ProfilingTraceWriter::~ProfilingTraceWriter()
+{
+	Finish();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool ProfilingTraceWriter::Start( const std::string& filePath, ProfilingTraceEvents& events, double secondsPerTick )
+{
+	if( IsWriting() )
+		return false;
+
+	Finish();
+	m_filePath = filePath;
+	m_events.swap( events );
+	m_secondsPerTick = secondsPerTick;
+	m_isFinished = 0;
+	m_writerThread = SysCreateThread( WriterThreadEntry, this );
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ProfilingTraceWriter::Finish()
+{
+	if( !m_writerThread )
+		return;
+
+	SysJoinThread( m_writerThread );
+	m_writerThread = NULL;
+	if( m_wasWriteSuccessful )
+		++ m_numTracesWritten;
+	else
+		++ m_numWriteFailures;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void ProfilingTraceWriter::WriterThreadEntry( void* profilingTraceWriter )
+{
+	ProfilingTraceWriter& writer = *(ProfilingTraceWriter*) profilingTraceWriter;
+	writer.m_wasWriteSuccessful = writer.WriteTrace();
+	ProfilingTraceEvents().swap( writer.m_events ); // free the window here, not on the frame thread
+	AtomicExchange( writer.m_isFinished, 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Sections become complete ("X") events and frame ends become global instant ("i") events, with
+//	timestamps in microseconds from the earliest event in the trace.  Each thread is named after
+//	its profiler thread index.
+//
+bool ProfilingTraceWriter::WriteTrace()
+{
+	FILE* file = fopen( m_filePath.c_str(), "wb" );
+	if( !file )
+		return false;
+
+	setvbuf( file, NULL, _IOFBF, PROFILING_TRACE_FILE_BUFFER_BYTES );
+	ProfilingTicks firstTicks = 0;
+	unsigned int numThreads = 0;
+	unsigned int eventIndex;
+	for( eventIndex = 0; eventIndex < m_events.size(); ++ eventIndex )
+	{
+		const ProfilingTraceEvent& event = m_events[ eventIndex ];
+		if( eventIndex == 0 || event.m_beginTicks < firstTicks )
+		{
+			firstTicks = event.m_beginTicks;
+		}
+
+		if( event.m_threadIndex >= numThreads )
+		{
+			numThreads = event.m_threadIndex + 1;
+		}
+	}
+
+	const double microsecondsPerTick = 1000000.0 * m_secondsPerTick;
+	fprintf( file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	for( unsigned int threadIndex = 0; threadIndex < numThreads; ++ threadIndex )
+	{
+		fprintf( file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}},\n", threadIndex, threadIndex );
+	}
+
+	for( eventIndex = 0; eventIndex < m_events.size(); ++ eventIndex )
+	{
+		const ProfilingTraceEvent& event = m_events[ eventIndex ];
+		const double beginMicroseconds = microsecondsPerTick * (double)( event.m_beginTicks - firstTicks );
+		if( event.m_name )
+		{
+			fprintf( file, "{\"name\":" );
+			WriteJsonString( file, event.m_name );
+			fprintf( file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n", event.m_threadIndex, beginMicroseconds,
+				microsecondsPerTick * (double)( event.m_endTicks - event.m_beginTicks ) );
+		}
+		else
+		{
+			fprintf( file, "{\"name\":\"EndFrame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%u,\"ts\":%.3f},\n", event.m_threadIndex, beginMicroseconds );
+		}
+	}
+
+	// A metadata event to end on, so every event above can be followed by a comma
+	fprintf( file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"PH2011\"}}\n]}\n" );
+	const bool wasWriteSuccessful = !ferror( file );
+	return fclose( file ) == 0 && wasWriteSuccessful;
+}
@@ -0,0 +1,65 @@
+//-----------------------------------------------------------------------------------------------
+// ProfilingTrace.hpp
+//
+// Writes profiled sections out as Chrome trace event JSON (chrome://tracing, Perfetto), on a
+//	thread of its own so the frame that asked for the trace doesn't wait on the file.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_ProfilingTrace__
+#define __include_ProfilingTrace__
+#pragma once
+#include "ProfilingSection.hpp"
+#include "Threading.hpp"
+#include <deque>
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// One completed section, or (with a NULL name) the end of a profiler frame.
+//
+class ProfilingTraceEvent
+{
+public:
+	const char* m_name;
+	unsigned int m_threadIndex;
+	ProfilingTicks m_beginTicks;
+	ProfilingTicks m_endTicks;
+};
+
+typedef std::deque< ProfilingTraceEvent > ProfilingTraceEvents;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Writes one trace at a time.  Start takes the events by swapping them out of the caller's
+//	container (leaving it empty), so handing them over costs nothing however many there are.
+//
+class ProfilingTraceWriter
+{
+public:
+	ProfilingTraceWriter();
+	~ProfilingTraceWriter();
+	bool Start( const std::string& filePath, ProfilingTraceEvents& events, double secondsPerTick ); // false (taking nothing) while the last trace is still being written
+	bool IsWriting() const { return m_writerThread != NULL && !m_isFinished; }
+	void Finish(); // waits for the file to be written
+	unsigned int GetNumTracesWritten() const { return m_numTracesWritten; }
+	unsigned int GetNumWriteFailures() const { return m_numWriteFailures; }
+
+private:
+	ProfilingTraceWriter( const ProfilingTraceWriter& ); // not copyable
+	void operator = ( const ProfilingTraceWriter& );
+	static void WriterThreadEntry( void* profilingTraceWriter );
+	bool WriteTrace();
+
+private:
+	ThreadHandle m_writerThread;
+	volatile long m_isFinished;
+	unsigned int m_numTracesWritten;
+	unsigned int m_numWriteFailures;
+
+	// Owned by the writer thread while it runs
+	std::string m_filePath;
+	ProfilingTraceEvents m_events;
+	double m_secondsPerTick;
+	bool m_wasWriteSuccessful;
+};
+
+
+#endif // __include_ProfilingTrace__
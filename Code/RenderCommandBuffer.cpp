@@ -0,0 +1,104 @@
+//-----------------------------------------------------------------------------------------------
+// RenderCommandBuffer.cpp
+//-----------------------------------------------------------------------------------------------
+#include "RenderCommandBuffer.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const char* RENDER_COMMAND_TYPE_NAMES[ NUM_RENDER_COMMAND_TYPES ] = { "circle", "circle_outline", "quad", "quad_outline", "circle_shadow", "quad_shadow", "layer" };
+unsigned int g_nextRenderLayerId = 1;
+
+
+//-----------------------------------------------------------------------------------------------
+RenderLayer::RenderLayer()
+	: m_version( 0 )
+	, m_id( g_nextRenderLayerId ++ )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// For consumers that outlive the layers' current contents, e.g. a capture thread.
+//
+void RenderCommandBuffer::AssignFlattened( const RenderCommandBuffer& source )
+{
+	Clear();
+	AppendFlattened( source );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void RenderCommandBuffer::AppendFlattened( const RenderCommandBuffer& source )
+{
+	for( unsigned int commandIndex = 0; commandIndex < source.GetNumCommands(); ++ commandIndex )
+	{
+		const RenderCommand& command = source.GetCommand( commandIndex );
+		if( command.GetType() == RENDER_COMMAND_LAYER )
+		{
+			AppendFlattened( source.GetLayer( command ).m_commands );
+		}
+		else
+		{
+			m_commands.push_back( command );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SerializingRenderBackend::Execute( const RenderCommandBuffer& commands )
+{
+	++ m_numFramesExecuted;
+	m_latestFrameText.clear();
+	for( unsigned int commandIndex = 0; commandIndex < commands.GetNumCommands(); ++ commandIndex )
+	{
+		const RenderCommand& command = commands.GetCommand( commandIndex );
+		if( command.GetType() != RENDER_COMMAND_LAYER )
+		{
+			AppendCommandText( command, "" );
+			continue;
+		}
+
+		// A layer's commands are listed under it, indented
+		const RenderLayer& layer = commands.GetLayer( command );
+		m_latestFrameText += Stringf( "%s %u version %u\n", RENDER_COMMAND_TYPE_NAMES[ command.m_type ], layer.GetId(), layer.GetVersion() );
+		for( unsigned int layerCommandIndex = 0; layerCommandIndex < layer.m_commands.GetNumCommands(); ++ layerCommandIndex )
+		{
+			AppendCommandText( layer.m_commands.GetCommand( layerCommandIndex ), "  " );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SerializingRenderBackend::AppendCommandText( const RenderCommand& command, const char* indent )
+{
+	m_latestFrameText += indent;
+	if( command.IsCircle() )
+	{
+		m_latestFrameText += Stringf( "%s %.2f %.2f %.2f", RENDER_COMMAND_TYPE_NAMES[ command.m_type ],
+			command.m_values[ 0 ], command.m_values[ 1 ], command.m_values[ 2 ] );
+	}
+	else
+	{
+		m_latestFrameText += Stringf( "%s %.2f %.2f %.2f %.2f", RENDER_COMMAND_TYPE_NAMES[ command.m_type ],
+			command.m_values[ 0 ], command.m_values[ 1 ], command.m_values[ 2 ], command.m_values[ 3 ] );
+	}
+
+	if( command.IsShadow() )
+	{
+		m_latestFrameText += Stringf( " falloff %.2f", command.GetShadowFalloffWidth() );
+	}
+
+	m_latestFrameText += Stringf( " rgba %d %d %d %d\n", command.m_r, command.m_g, command.m_b, command.m_a );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool SerializingRenderBackend::WriteLatestFrameToFile( const JazzPath& filePath ) const
+{
+	const int numBytesWritten = WriteBufferToBinaryFile( filePath, (const unsigned char*) m_latestFrameText.data(), (int) m_latestFrameText.size() );
+	return numBytesWritten == (int) m_latestFrameText.size();
+}
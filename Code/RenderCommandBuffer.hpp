@@ -0,0 +1,225 @@
+//-----------------------------------------------------------------------------------------------
+// RenderCommandBuffer.hpp
+//
+// Flat list of 2D draw commands recorded by the Draw* functions (see Graphics.hpp), and the
+//	backends that replay it.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_RenderCommandBuffer__
+#define __include_RenderCommandBuffer__
+#pragma once
+#include "AABB2.hpp"
+#include "Vector2.hpp"
+#include "Rgba.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const float RENDER_OUTLINE_WIDTH = 3.f; // outlines are centered on the shape's edge, in view units
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+enum RenderCommandType
+{
+	RENDER_COMMAND_FILLED_CIRCLE,
+	RENDER_COMMAND_OUTLINED_CIRCLE,
+	RENDER_COMMAND_FILLED_QUAD,
+	RENDER_COMMAND_OUTLINED_QUAD,
+	RENDER_COMMAND_SHADOW_CIRCLE, // full alpha inside the radius, fading to zero over the falloff width
+	RENDER_COMMAND_SHADOW_QUAD, // full alpha inside the bounds, fading to zero over the falloff width
+	RENDER_COMMAND_LAYER, // replays a RenderLayer's commands; m_values[ 0 ] is its index in the buffer's layer list
+	NUM_RENDER_COMMAND_TYPES
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// One shape, 28 bytes.  Colors are stored with the draw call's alpha already applied.
+//
+class RenderCommand
+{
+public:
+	float m_values[ 5 ]; // circles: centerX, centerY, radius; quads: minX, minY, maxX, maxY; shadows: falloff width last
+	unsigned char m_r;
+	unsigned char m_g;
+	unsigned char m_b;
+	unsigned char m_a;
+	unsigned char m_type; // RenderCommandType
+
+	RenderCommandType GetType() const { return (RenderCommandType) m_type; }
+	Vector2 GetCircleCenter() const { return Vector2( m_values[ 0 ], m_values[ 1 ] ); }
+	float GetCircleRadius() const { return m_values[ 2 ]; }
+	AABB2 GetQuadBounds() const { return AABB2( m_values[ 0 ], m_values[ 1 ], m_values[ 2 ], m_values[ 3 ] ); }
+	float GetShadowFalloffWidth() const { return m_values[ 4 ]; }
+	bool IsCircle() const { return m_type == RENDER_COMMAND_FILLED_CIRCLE || m_type == RENDER_COMMAND_OUTLINED_CIRCLE || m_type == RENDER_COMMAND_SHADOW_CIRCLE; }
+	bool IsShadow() const { return m_type == RENDER_COMMAND_SHADOW_CIRCLE || m_type == RENDER_COMMAND_SHADOW_QUAD; }
+};
+
+
+class RenderLayer;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Commands are kept in submission order, which is also blending order.
+//
+class RenderCommandBuffer
+{
+public:
+	void AddCircle( RenderCommandType type, const Vector2& center, float radius, const Rgba& colorWithAlpha );
+	void AddQuad( RenderCommandType type, const AABB2& bounds, const Rgba& colorWithAlpha );
+	void AddShadowCircle( const Vector2& center, float radius, float falloffWidth, const Rgba& colorWithAlpha );
+	void AddShadowQuad( const AABB2& bounds, float falloffWidth, const Rgba& colorWithAlpha );
+	void AddLayer( const RenderLayer& layer ); // by reference; the layer must outlive this buffer's next Clear
+	void AssignFlattened( const RenderCommandBuffer& source ); // copies <source> with its layers' commands inlined
+	void Clear() { m_commands.clear(); m_layers.clear(); }
+	unsigned int GetNumCommands() const { return (unsigned int) m_commands.size(); }
+	const RenderCommand& GetCommand( unsigned int commandIndex ) const { return m_commands[ commandIndex ]; }
+	const RenderLayer& GetLayer( const RenderCommand& layerCommand ) const { return *m_layers[ (unsigned int) layerCommand.m_values[ 0 ] ]; }
+
+private:
+	RenderCommand& AddCommand( RenderCommandType type, const Rgba& colorWithAlpha );
+	void AppendFlattened( const RenderCommandBuffer& source );
+
+private:
+	std::vector< RenderCommand > m_commands;
+	std::vector< const RenderLayer* > m_layers;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Commands recorded once (see BeginRecordingLayer in Graphics.hpp) and then drawn by reference
+//	each frame, so backends can keep a retained form of them -- a display list, a cached
+//	background -- until the version changes.  Layers don't nest.
+//
+class RenderLayer
+{
+public:
+	RenderLayer();
+	unsigned int GetId() const { return m_id; } // unique per layer, never reused
+	unsigned int GetVersion() const { return m_version; } // 0 until first recorded; bumped by each recording
+
+	RenderCommandBuffer m_commands;
+	unsigned int m_version;
+
+private:
+	RenderLayer( const RenderLayer& ); // not copyable; backends cache by id
+	void operator = ( const RenderLayer& );
+
+private:
+	unsigned int m_id;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Replays a frame's commands.  The OpenGL backend lives in Graphics.cpp.
+//
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() {}
+	virtual void Execute( const RenderCommandBuffer& commands ) = 0;
+	virtual const char* GetName() const = 0;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Draws nothing; for measuring command generation on its own.
+//
+class NullRenderBackend : public RenderBackend
+{
+public:
+	NullRenderBackend() : m_numCommandsExecuted( 0 ) {}
+	virtual void Execute( const RenderCommandBuffer& commands ) { m_numCommandsExecuted += commands.GetNumCommands(); } // a layer counts as one
+	virtual const char* GetName() const { return "null"; }
+
+	double m_numCommandsExecuted;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Keeps the most recently executed frame as text, one command per line with fixed precision,
+//	so frames can be diffed against golden files.
+//
+class SerializingRenderBackend : public RenderBackend
+{
+public:
+	SerializingRenderBackend() : m_numFramesExecuted( 0 ) {}
+	virtual void Execute( const RenderCommandBuffer& commands );
+	virtual const char* GetName() const { return "serialize"; }
+	const std::string& GetLatestFrameText() const { return m_latestFrameText; }
+	bool WriteLatestFrameToFile( const JazzPath& filePath ) const;
+
+	unsigned int m_numFramesExecuted;
+
+private:
+	void AppendCommandText( const RenderCommand& command, const char* indent );
+
+private:
+	std::string m_latestFrameText;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+inline RenderCommand& RenderCommandBuffer::AddCommand( RenderCommandType type, const Rgba& colorWithAlpha )
+{
+	m_commands.push_back( RenderCommand() );
+	RenderCommand& command = m_commands.back();
+	command.m_type = (unsigned char) type;
+	command.m_r = colorWithAlpha.r;
+	command.m_g = colorWithAlpha.g;
+	command.m_b = colorWithAlpha.b;
+	command.m_a = colorWithAlpha.a;
+	return command;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderCommandBuffer::AddCircle( RenderCommandType type, const Vector2& center, float radius, const Rgba& colorWithAlpha )
+{
+	RenderCommand& command = AddCommand( type, colorWithAlpha );
+	command.m_values[ 0 ] = center.x;
+	command.m_values[ 1 ] = center.y;
+	command.m_values[ 2 ] = radius;
+	command.m_values[ 3 ] = 0.f;
+	command.m_values[ 4 ] = 0.f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderCommandBuffer::AddQuad( RenderCommandType type, const AABB2& bounds, const Rgba& colorWithAlpha )
+{
+	RenderCommand& command = AddCommand( type, colorWithAlpha );
+	command.m_values[ 0 ] = bounds.mins.x;
+	command.m_values[ 1 ] = bounds.mins.y;
+	command.m_values[ 2 ] = bounds.maxs.x;
+	command.m_values[ 3 ] = bounds.maxs.y;
+	command.m_values[ 4 ] = 0.f;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderCommandBuffer::AddShadowCircle( const Vector2& center, float radius, float falloffWidth, const Rgba& colorWithAlpha )
+{
+	AddCircle( RENDER_COMMAND_SHADOW_CIRCLE, center, radius, colorWithAlpha );
+	m_commands.back().m_values[ 4 ] = falloffWidth;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderCommandBuffer::AddLayer( const RenderLayer& layer )
+{
+	RenderCommand& command = AddCommand( RENDER_COMMAND_LAYER, Rgba( 0, 0, 0, 0 ) );
+	command.m_values[ 0 ] = (float) m_layers.size();
+	command.m_values[ 1 ] = command.m_values[ 2 ] = command.m_values[ 3 ] = command.m_values[ 4 ] = 0.f;
+	m_layers.push_back( &layer );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderCommandBuffer::AddShadowQuad( const AABB2& bounds, float falloffWidth, const Rgba& colorWithAlpha )
+{
+	AddQuad( RENDER_COMMAND_SHADOW_QUAD, bounds, colorWithAlpha );
+	m_commands.back().m_values[ 4 ] = falloffWidth;
+}
+
+
+#endif // __include_RenderCommandBuffer__
@@ -300,9 +300,9 @@ inline Rgba& Rgba::SetFromDwordABGR( unsigned int abgr )
 //-----------------------------------------------------------------------------------------------
 inline Rgba& Rgba::RandomizeRGB()
 {
-	r = unsigned char( RandomIntLessThan( 256 ) );
-	g = unsigned char( RandomIntLessThan( 256 ) );
-	b = unsigned char( RandomIntLessThan( 256 ) );
+	r = (unsigned char) RandomIntLessThan( 256 );
+	g = (unsigned char) RandomIntLessThan( 256 );
+	b = (unsigned char) RandomIntLessThan( 256 );
 	return *this;
 }
 
@@ -310,10 +310,10 @@ inline Rgba& Rgba::RandomizeRGB()
 //-----------------------------------------------------------------------------------------------
 inline Rgba& Rgba::RandomizeRGBA()
 {
-	r = unsigned char( RandomIntLessThan( 256 ) );
-	g = unsigned char( RandomIntLessThan( 256 ) );
-	b = unsigned char( RandomIntLessThan( 256 ) );
-	a = unsigned char( RandomIntLessThan( 256 ) );
+	r = (unsigned char) RandomIntLessThan( 256 );
+	g = (unsigned char) RandomIntLessThan( 256 );
+	b = (unsigned char) RandomIntLessThan( 256 );
+	a = (unsigned char) RandomIntLessThan( 256 );
 	return *this;
 }
 
@@ -2,6 +2,35 @@
 // Scenario.cpp
 //-----------------------------------------------------------------------------------------------
 #include "TheGame.hpp" // for now, we've got a huge ass monolithic header
+#include "Graphics.hpp"
+#include "ProfilingSection.hpp"
+#include "SimulationStateHash.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+const unsigned int g_actorsPerUpdateBatch = 64;
+const float g_minSpatialQueryMarginDistance = 8.f;
+
+
+//-----------------------------------------------------------------------------------------------
+// Arguments for UpdateNPCBatch, handed to every ThreadPool participant
+//
+class NPCUpdateJob
+{
+public:
+	Scenario* m_scenario;
+	double m_deltaSeconds;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+static void UpdateNPCBatch( void* userData, unsigned int beginIndex, unsigned int endIndex, unsigned int participantIndex )
+{
+	NPCUpdateJob& job = *(NPCUpdateJob*) userData;
+	Scenario& scenario = *job.m_scenario;
+	scenario.UpdateNPCs( job.m_deltaSeconds, beginIndex, endIndex, scenario.m_updateScratchPerThread[ participantIndex ] );
+}
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -10,10 +39,18 @@
 //-----------------------------------------------------------------------------------------------
 Scenario::Scenario()
 	: m_name( "UNNAMED SCENARIO" )
+	, m_actors( m_simulationClock )
 	, m_state( SCENARIO_STATE_INACTIVE )
 	, m_timeEnteredState( 0.0 )
 	, m_startFunction( NULL )
 	, m_updateFunction( NULL )
+	, m_updateScratchPerThread( 1 )
+	, m_isDoubleBuffered( false )
+	, m_threadPool( NULL )
+	, m_numUpdates( 0 )
+	, m_spatialQueryMarginDistance( g_minSpatialQueryMarginDistance )
+	, m_numUpdatesOverSpatialQueryMargin( 0 )
+	, m_stateHashLog( NULL )
 {
 }
 
@@ -21,43 +58,215 @@ Scenario::Scenario()
 //-----------------------------------------------------------------------------------------------
 void Scenario::Start()
 {
+	PROFILE_SECTION( "Scenario::Start" );
+	m_simulationClock.SetCurrentTimeSeconds( 0.0 );
+	m_numUpdates = 0;
+	m_spatialQueryMarginDistance = g_minSpatialQueryMarginDistance;
+	m_numUpdatesOverSpatialQueryMargin = 0;
+	for( unsigned int scratchIndex = 0; scratchIndex < m_updateScratchPerThread.size(); ++ scratchIndex )
+	{
+		m_updateScratchPerThread[ scratchIndex ].m_numRelationshipsRun = 0.0;
+	}
+
 	ChangeState( SCENARIO_STATE_INTRO );
 	m_startFunction( *this );
+	m_areaIndex.Rebuild( m_areas );
+
+	// Actors start at rest (rather than having just moved from the origin), for rendering and mimicry
+	m_actors.m_previousPositions = m_actors.m_positions;
 }
 
 
 //-----------------------------------------------------------------------------------------------
 void Scenario::Update( double deltaSeconds )
 {
+	PROFILE_SECTION( "Scenario::Update" );
+	m_simulationClock.AdvanceTime( deltaSeconds );
+	++ m_numUpdates;
 	m_updateFunction( *this, deltaSeconds );
+	if( !m_areaIndex.IsUpToDate( m_areas ) )
+	{
+		m_areaIndex.Rebuild( m_areas );
+	}
 
 	// Update players
-	for( unsigned int actorIndex = 0; actorIndex < m_actors.size(); ++ actorIndex )
+	const unsigned int numActors = m_actors.GetNumActors();
+	for( unsigned int actorIndex = 0; actorIndex < numActors; ++ actorIndex )
 	{
-		Actor& actor = *m_actors[ actorIndex ];
-		if( actor.m_isPlayer )
+		if( m_actors.m_isPlayerFlags[ actorIndex ] )
 		{
-			actor.UpdateAsPlayer( deltaSeconds, *this );
+			m_actors.m_actors[ actorIndex ]->UpdateAsPlayer( deltaSeconds, *this, m_updateScratchPerThread[ 0 ] );
 		}
 	}
 
-	// Update all NPCs
-	for( unsigned int actorIndex = 0; actorIndex < m_actors.size(); ++ actorIndex )
+	// NPC relationships query the hash, so build it after the players have moved
+	UpdateActorSpatialHash();
+	UpdateAllNPCs( deltaSeconds );
+	UpdateSpatialQueryMargin();
+
+	if( m_stateHashLog )
 	{
-		Actor& actor = *m_actors[ actorIndex ];
-		if( !actor.m_isPlayer )
+		m_stateHashLog->RecordTick( *this );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// In-place updates see whichever NPCs already moved this step, so they must run serially in order.
+//
+void Scenario::UpdateAllNPCs( double deltaSeconds )
+{
+	const unsigned int numActors = m_actors.GetNumActors();
+	if( !m_isDoubleBuffered )
+	{
+		UpdateNPCs( deltaSeconds, 0, numActors, m_updateScratchPerThread[ 0 ] );
+		return;
+	}
+
+	m_actors.FreezeObservableState();
+	if( m_threadPool )
+	{
+		if( m_updateScratchPerThread.size() < m_threadPool->GetNumParticipants() )
 		{
-			actor.Update( deltaSeconds, *this );
+			m_updateScratchPerThread.resize( m_threadPool->GetNumParticipants() );
 		}
+
+		NPCUpdateJob job;
+		job.m_scenario = this;
+		job.m_deltaSeconds = deltaSeconds;
+		m_threadPool->ParallelFor( numActors, g_actorsPerUpdateBatch, UpdateNPCBatch, &job );
 	}
+	else
+	{
+		UpdateNPCs( deltaSeconds, 0, numActors, m_updateScratchPerThread[ 0 ] );
+	}
+	m_actors.UnfreezeObservableState();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// NPCs move after the spatial hash is built, so a neighborhood query can miss an actor that has
+//	drifted from its hashed position, or that the querying NPC has drifted toward since querying.
+//	Each drift is at most one step's move (the first only in-place; double-buffered NPCs observe
+//	hashed positions), so queries are exact while the margin covers twice the largest NPC move.
+//	NPC speed has no fixed bound (relationships move NPCs directly), so the margin is sized from
+//	the step just run, and steps that outran the margin they were given are counted and reported.
+//
+void Scenario::UpdateSpatialQueryMargin()
+{
+	float largestNPCMoveDistanceSquared = 0.f;
+	const unsigned int numActors = m_actors.GetNumActors();
+	for( unsigned int actorIndex = 0; actorIndex < numActors; ++ actorIndex )
+	{
+		if( !m_actors.m_isPlayerFlags[ actorIndex ] )
+		{
+			const Vector2 move = m_actors.m_positions[ actorIndex ] - m_actors.m_previousPositions[ actorIndex ];
+			largestNPCMoveDistanceSquared = MaxFloat( largestNPCMoveDistanceSquared, move.CalcLengthSquared() );
+		}
+	}
+
+	const float neededMarginDistance = 2.f * sqrt( largestNPCMoveDistanceSquared );
+	if( neededMarginDistance > m_spatialQueryMarginDistance )
+	{
+		if( m_numUpdatesOverSpatialQueryMargin == 0 )
+		{
+			DebuggerPrintf( "Scenario '%s' step %u: NPCs moved up to %.1f units, more than the %.1f-unit spatial query margin covers; neighborhood queries may have missed relationships\n",
+				m_name.c_str(), m_numUpdates, 0.5f * neededMarginDistance, 0.5f * m_spatialQueryMarginDistance );
+		}
+
+		++ m_numUpdatesOverSpatialQueryMargin;
+	}
+
+	m_spatialQueryMarginDistance = MaxFloat( g_minSpatialQueryMarginDistance, neededMarginDistance );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Updates the NPCs among actors [firstActorIndex,endActorIndex).  When double-buffered, an NPC
+//	writes only its own store slot and reads others' frozen state, so disjoint ranges can run on
+//	different threads.
+//
+void Scenario::UpdateNPCs( double deltaSeconds, unsigned int firstActorIndex, unsigned int endActorIndex, ActorUpdateScratch& scratch )
+{
+	for( unsigned int actorIndex = firstActorIndex; actorIndex < endActorIndex; ++ actorIndex )
+	{
+		if( !m_actors.m_isPlayerFlags[ actorIndex ] )
+		{
+			m_actors.m_actors[ actorIndex ]->Update( deltaSeconds, *this, scratch );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Cells are sized to the largest bounded-relationship reach (outer distance plus two radii), so
+//	a typical neighborhood query touches only the surrounding 3x3 cells.
+//
+void Scenario::UpdateActorSpatialHash()
+{
+	float largestRelationshipDistance = 0.f;
+	float largestActorRadius = 0.f;
+	for( unsigned int actorIndex = 0; actorIndex < m_actors.GetNumActors(); ++ actorIndex )
+	{
+		Actor& actor = *m_actors.m_actors[ actorIndex ];
+		actor.RebuildRelationshipIndexIfNeeded();
+		largestRelationshipDistance = MaxFloat( largestRelationshipDistance, actor.m_largestBoundedRelationshipDistance );
+		largestActorRadius = MaxFloat( largestActorRadius, m_actors.m_baseRadii[ actorIndex ] );
+	}
+
+	for( unsigned int ruleIndex = 0; ruleIndex < m_relationshipRules.size(); ++ ruleIndex )
+	{
+		const RelationshipToOtherActor& relationship = m_relationshipRules[ ruleIndex ].m_relationship;
+		if( !relationship.HasEffectBeyondOuterDistance() )
+		{
+			largestRelationshipDistance = MaxFloat( largestRelationshipDistance, relationship.m_outerDistance );
+		}
+	}
+
+	m_actorSpatialHash.Rebuild( m_actors, largestRelationshipDistance + (2.f * largestActorRadius) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Call after changing any area's bounds in place; adding or removing areas is noticed automatically.
+//
+void Scenario::OnAreasChanged()
+{
+	m_areaIndex.MarkDirty();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Actor* Scenario::CreateActor()
+{
+	return m_actors.CreateActor( m_arena );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Areas are drawn and collided in creation order.
+//
+Area* Scenario::CreateArea()
+{
+	Area* newArea = m_arena.New< Area >();
+	m_areas.push_back( newArea );
+	return newArea;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Scenario::AddRelationshipRule( const RelationshipRule& rule )
+{
+	m_relationshipRules.push_back( rule );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 bool Scenario::IsActorAtAllInsideArea( Actor& actor, Area& area )
 {
-	Vector2 closestPointInAreaToActorCenter = FindClosestPointInBoundsToTarget( area.m_bounds, actor.m_position, true );
-	Vector2 displacementToClosestPoint = closestPointInAreaToActorCenter - actor.m_position;
+	const Vector2& actorPosition = actor.GetPosition();
+	Vector2 closestPointInAreaToActorCenter = FindClosestPointInBoundsToTarget( area.m_bounds, actorPosition, true );
+	Vector2 displacementToClosestPoint = closestPointInAreaToActorCenter - actorPosition;
 	float distanceToClosestPoint = displacementToClosestPoint.CalcLength();
 	if( distanceToClosestPoint < actor.CalcRadius() )
 	{
@@ -73,69 +282,79 @@ bool Scenario::IsActorAtAllInsideArea( Actor& actor, Area& area )
 //-----------------------------------------------------------------------------------------------
 void Scenario::ForceActorOutsideOfArea( Actor& actor, Area& area )
 {
-	Vector2 closestPointInAreaToActorCenter = FindClosestPointInBoundsToTarget( area.m_bounds, actor.m_position, false );
-	Vector2 displacementToClosestPoint = closestPointInAreaToActorCenter - actor.m_position;
+	const Vector2& actorPosition = actor.GetPosition();
+	Vector2 closestPointInAreaToActorCenter = FindClosestPointInBoundsToTarget( area.m_bounds, actorPosition, false );
+	Vector2 displacementToClosestPoint = closestPointInAreaToActorCenter - actorPosition;
 	float distanceToClosestPoint = displacementToClosestPoint.CalcLength();
 	if( distanceToClosestPoint < actor.CalcRadius() )
 	{
 		Vector2 desiredDisplacementFromClosestPoint = -displacementToClosestPoint;
 		desiredDisplacementFromClosestPoint.SetLength( actor.CalcRadius() );
-		actor.m_position = closestPointInAreaToActorCenter + desiredDisplacementFromClosestPoint;
+		actor.SetPosition( closestPointInAreaToActorCenter + desiredDisplacementFromClosestPoint );
 	}
 }
 
 
 //-----------------------------------------------------------------------------------------------
-void Scenario::Render()
+// Copies out the draw state of every living actor and every area, so the snapshot can be drawn
+//	(on any thread) while this scenario keeps updating.
+//
+void Scenario::CaptureSnapshot( OUTPUT SimulationSnapshot& snapshot ) const
 {
-	// Render all areas (shadows first, then normal)
-	unsigned int areaIndex;
-	for( areaIndex = 0; areaIndex < m_areas.size(); ++ areaIndex )
+	snapshot.m_actors.clear();
+	const unsigned int numActors = m_actors.GetNumActors();
+	for( unsigned int actorIndex = 0; actorIndex < numActors; ++ actorIndex )
 	{
-		Area& area = *m_areas[ areaIndex ];
-		RenderArea( area, true );
-	}
-	for( areaIndex = 0; areaIndex < m_areas.size(); ++ areaIndex )
-	{
-		Area& area = *m_areas[ areaIndex ];
-		RenderArea( area, false );
+		if( m_actors.m_states[ actorIndex ] != ACTOR_STATE_DEAD )
+		{
+			snapshot.m_actors.push_back( m_actors.m_actors[ actorIndex ]->CaptureDrawState() );
+		}
 	}
 
-	// Render shadows on all Actors
-	unsigned int actorIndex;
-	for( actorIndex = 0; actorIndex < m_actors.size(); ++ actorIndex )
+	snapshot.m_areas.resize( m_areas.size() );
+	for( unsigned int areaIndex = 0; areaIndex < m_areas.size(); ++ areaIndex )
 	{
-		Actor& actor = *m_actors[ actorIndex ];
-		RenderActor( actor, true );
+		snapshot.m_areas[ areaIndex ] = m_areas[ areaIndex ]->CaptureDrawState();
 	}
 
-	// Render all NPCs
-	for( actorIndex = 0; actorIndex < m_actors.size(); ++ actorIndex )
-	{
-		Actor& actor = *m_actors[ actorIndex ];
-		if( !actor.m_isPlayer )
-		{
-			RenderActor( actor, false );
-		}
-	}
+	snapshot.m_tickNumber = m_numUpdates;
+}
+
 
-	// Render players (separated only so that players are drawn on top of NPCs
-	for( unsigned int actorIndex = 0; actorIndex < m_actors.size(); ++ actorIndex )
+//-----------------------------------------------------------------------------------------------
+// Relationships (and relationship rules) actually run, summed over every thread's scratch.
+//
+double Scenario::CalcNumRelationshipsRun() const
+{
+	double numRelationshipsRun = 0.0;
+	for( unsigned int scratchIndex = 0; scratchIndex < m_updateScratchPerThread.size(); ++ scratchIndex )
 	{
-		Actor& actor = *m_actors[ actorIndex ];
-		if( actor.m_isPlayer )
-		{
-			RenderActor( actor, false );
-		}
+		numRelationshipsRun += m_updateScratchPerThread[ scratchIndex ].m_numRelationshipsRun;
 	}
+
+	return numRelationshipsRun;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Scenario::Render( float interpolationFraction )
+{
+	PROFILE_SECTION( "Scenario::Render" );
+	CaptureSnapshot( m_renderSnapshot );
+	m_snapshotRenderer.Render( m_renderSnapshot, interpolationFraction );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 void Scenario::WipeClean()
 {
+	PROFILE_SECTION( "Scenario::WipeClean" );
 	m_areas.clear();
-	m_actors.clear();
+	m_actors.Clear();
+	m_relationshipRules.clear();
+	m_actorSpatialHash.Clear();
+	m_areaIndex.Clear();
+	m_arena.Reset();
 	ChangeState( SCENARIO_STATE_INACTIVE );
 }
 
@@ -143,7 +362,7 @@ void Scenario::WipeClean()
 //-----------------------------------------------------------------------------------------------
 double Scenario::GetSecondsInCurrentState() const
 {
-	double timeNow = Clock::GetAbsoluteTimeSeconds();
+	double timeNow = m_simulationClock.GetCurrentTimeSeconds();
 	return timeNow - m_timeEnteredState;
 }
 
@@ -161,22 +380,8 @@ ScenarioState Scenario::ChangeState( ScenarioState newState )
 {
 	ScenarioState previousState = m_state;
 	m_state = newState;
-	m_timeEnteredState = Clock::GetAbsoluteTimeSeconds();
+	m_timeEnteredState = m_simulationClock.GetCurrentTimeSeconds();
 	return previousState;
 }
 
 
-//-----------------------------------------------------------------------------------------------
-void Scenario::RenderArea( Area& area, bool isShadowPass )
-{
-	area.Draw( isShadowPass );
-}
-
-
-//-----------------------------------------------------------------------------------------------
-void Scenario::RenderActor( Actor& actor, bool isShadowPass )
-{
-	actor.Draw( isShadowPass );
-}
-
-
@@ -5,17 +5,15 @@
 #include "Vector2.hpp"
 
 #define AR(n, l, t, w, h) { \
-	Area *n = new Area();\
+	Area *n = scenario.CreateArea();\
 	n->m_bounds.SetFromMinXYMaxXY( l, t, l+w, t+h );\
-	scenario.m_areas.push_back(n);\
 	}
 
 #define AC(n, l, t) { \
-	Actor *n = new Actor();\
-	n->m_position = Vector2(l, t);\
+	Actor *n = scenario.CreateActor();\
+	n->SetPosition( Vector2(l, t) );\
 	n->m_relationships.push_back(followPlayer);\
 	n->m_baseColor = Rgba::WHITE;\
-	scenario.m_actors.push_back(n);\
 	}
 
 //-----------------------------------------------------------------------------------------------
@@ -24,11 +22,10 @@ void ScenarioStartFunction_Popularity( Scenario& scenario )
 	DebuggerPrintf( "Starting scenario '%s'...\n", scenario.m_name.c_str() );
 	
 	//1024x576
-	Actor *player=new Actor();
-	player->m_position = Vector2(118, 502);
-	player->m_isPlayer = true;
+	Actor *player=scenario.CreateActor();
+	player->SetPosition( Vector2(118, 502) );
+	player->SetIsPlayer( true );
 	player->m_baseColor = Rgba::BLUE;
-	scenario.m_actors.push_back( player );
 
 	RelationshipToOtherActor followPlayer;
 	followPlayer.m_innerDistance = 75;
@@ -57,20 +54,12 @@ void ScenarioStartFunction_Popularity( Scenario& scenario )
 	AC(a18, 790, 118);
 	AC(a19, 854, 118);
 
-	for(int i = 0; i < scenario.m_actors.size(); i++) {
-		Actor *a = scenario.m_actors[i];
-		RelationshipToOtherActor dontBumpA;
-		dontBumpA.m_innerDistance = 0;
-		dontBumpA.m_outerDistance = 32;
-		dontBumpA.m_attractionRepulsionAtOuterDistance = Vector2(0,0);
-		dontBumpA.m_attractionRepulsionAtInnerDistance = Vector2(-2,-2);
-		dontBumpA.m_otherActor = a;
-		for(int j = 0; j < scenario.m_actors.size(); j++) {
-			if(i == j) { continue; }
-			Actor *b = scenario.m_actors[j];
-			b->m_relationships.push_back(dontBumpA);
-		}
-	}
+	RelationshipRule dontBump;
+	dontBump.m_relationship.m_innerDistance = 0;
+	dontBump.m_relationship.m_outerDistance = 32;
+	dontBump.m_relationship.m_attractionRepulsionAtOuterDistance = Vector2(0,0);
+	dontBump.m_relationship.m_attractionRepulsionAtInnerDistance = Vector2(-2,-2);
+	scenario.AddRelationshipRule(dontBump);
 
 	AR(ar1, 64, 32, 128, 512);
 	AR(ar2, 64, 32, 512, 128);
@@ -79,11 +68,10 @@ void ScenarioStartFunction_Popularity( Scenario& scenario )
 	AR(ar5, 768, 64, 128, 352);
 	AR(ar6, 768, 32, 256, 96);
 
-	Area *pGoal=new Area();
+	Area *pGoal=scenario.CreateArea();
 	pGoal->m_bounds.SetFromMinXYMaxXY( 928, 32, 1024, 32+96 );
 	pGoal->m_color = Rgba::WHITE;
 	pGoal->m_alpha = 1.0f;
-	scenario.m_areas.push_back( pGoal );
 }
 
 
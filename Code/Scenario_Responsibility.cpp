@@ -5,17 +5,15 @@
 #include "Vector2.hpp"
 
 #define AR(n, l, t, w, h) { \
-	Area *n = new Area();\
+	Area *n = scenario.CreateArea();\
 	n->m_bounds.SetFromMinXYMaxXY( l, t, l+w, t+h );\
-	scenario.m_areas.push_back(n);\
 	}
 
 #define AC(n, l, t) { \
-	Actor *n = new Actor();\
-	n->m_position = Vector2(l, t);\
+	Actor *n = scenario.CreateActor();\
+	n->SetPosition( Vector2(l, t) );\
 	n->m_relationships.push_back(followPlayer);\
 	n->m_baseColor = Rgba::WHITE;\
-	scenario.m_actors.push_back(n);\
 	}
 
 //-----------------------------------------------------------------------------------------------
@@ -24,11 +22,10 @@ void ScenarioStartFunction_Responsibility( Scenario& scenario )
 	DebuggerPrintf( "Starting scenario '%s'...\n", scenario.m_name.c_str() );
 	
 	//1024x576
-	Actor *player=new Actor();
-	player->m_position = Vector2(352+144, 320+128);
-	player->m_isPlayer = true;
+	Actor *player=scenario.CreateActor();
+	player->SetPosition( Vector2(352+144, 320+128) );
+	player->SetIsPlayer( true );
 	player->m_baseColor = Rgba::BLUE;
-	scenario.m_actors.push_back( player );
 
 	RelationshipToOtherActor followPlayer;
 	followPlayer.m_attractionRepulsionAtOuterDistance = Vector2(0.75f, 0.75f);
@@ -40,24 +37,16 @@ void ScenarioStartFunction_Responsibility( Scenario& scenario )
 	for(int i = 0; i < 5; i++) {
 		for(int j = 0; j < 5; j++) {
 			if(i == 2 && j == 2) { continue; }
-			AC(a, player->m_position.x-(i-2)*30, player->m_position.y-(j-2)*30);
+			AC(a, player->GetPosition().x-(i-2)*30, player->GetPosition().y-(j-2)*30);
 		}
 	}
 
-	for(int i = 0; i < scenario.m_actors.size(); i++) {
-		Actor *a = scenario.m_actors[i];
-		RelationshipToOtherActor dontBumpA;
-		dontBumpA.m_innerDistance = 0;
-		dontBumpA.m_outerDistance = 64;
-		dontBumpA.m_attractionRepulsionAtOuterDistance = Vector2(0,0);
-		dontBumpA.m_attractionRepulsionAtInnerDistance = Vector2(-3,-3);
-		dontBumpA.m_otherActor = a;
-		for(int j = 0; j < scenario.m_actors.size(); j++) {
-			if(i == j) { continue; }
-			Actor *b = scenario.m_actors[j];
-			b->m_relationships.push_back(dontBumpA);
-		}
-	}
+	RelationshipRule dontBump;
+	dontBump.m_relationship.m_innerDistance = 0;
+	dontBump.m_relationship.m_outerDistance = 64;
+	dontBump.m_relationship.m_attractionRepulsionAtOuterDistance = Vector2(0,0);
+	dontBump.m_relationship.m_attractionRepulsionAtInnerDistance = Vector2(-3,-3);
+	scenario.AddRelationshipRule(dontBump);
 
 	AR(ar1, 352, 320, 288, 256);
 	AR(ar2, 96, 256, 288, 256);
@@ -66,11 +55,10 @@ void ScenarioStartFunction_Responsibility( Scenario& scenario )
 	AR(ar5, 512, 128, 288, 256);
 	AR(ar6, 800, 32, 288, 256);
 
-	Area *pGoal=new Area();
+	Area *pGoal=scenario.CreateArea();
 	pGoal->m_bounds.SetFromMinXYMaxXY( 928, 32, 1500, 32+256 );
 	pGoal->m_color = Rgba::WHITE;
 	pGoal->m_alpha = 1.0f;
-	scenario.m_areas.push_back( pGoal );
 }
 
 
@@ -11,43 +11,35 @@ void ScenarioStartFunction_SelfDoubt( Scenario& scenario )
 	
 	//1024x576
 
-	Actor *player=new Actor();
-	player->m_position = Vector2( 512.f, 566.f-100.f );
-	player->m_isPlayer = true;
+	Actor *player=scenario.CreateActor();
+	player->SetPosition( Vector2( 512.f, 566.f-100.f ) );
+	player->SetIsPlayer( true );
 	player->m_baseColor = Rgba::BLUE;
-	scenario.m_actors.push_back( player );
 
 	RelationshipToOtherActor followPlayer;
 	followPlayer.m_mimicMotionAtOuterDistance = Vector2(1,1);
 	followPlayer.m_otherActor = player;
 
-	Actor *left=new Actor();
-	left->m_position = Vector2( 462.f, 566.f-25.f );
+	Actor *left=scenario.CreateActor();
+	left->SetPosition( Vector2( 462.f, 566.f-25.f ) );
 	left->m_relationships.push_back(followPlayer);
 	left->m_baseColor = Rgba::WHITE;
-	scenario.m_actors.push_back( left );
 	
-	Actor *right=new Actor();
-	right->m_position = Vector2( 562.f, 566.f-25.f );
+	Actor *right=scenario.CreateActor();
+	right->SetPosition( Vector2( 562.f, 566.f-25.f ) );
 	right->m_relationships.push_back(followPlayer);
 	right->m_baseColor = Rgba::WHITE;
-	scenario.m_actors.push_back( right );
 
-	Area *zig1=new Area();
+	Area *zig1=scenario.CreateArea();
 	zig1->m_bounds.SetFromMinXYMaxXY( 0.f, 376.f, 1024.f, 576.f );
-	scenario.m_areas.push_back( zig1 );
-	Area *zig2=new Area();
+	Area *zig2=scenario.CreateArea();
 	zig2->m_bounds.SetFromMinXYMaxXY( 200.f, 176.f, 824.f, 376.f );
-	scenario.m_areas.push_back( zig2 );
-	Area *zig3=new Area();
+	Area *zig3=scenario.CreateArea();
 	zig3->m_bounds.SetFromMinXYMaxXY( 400.f, -176.f, 624.f, 176.f );
-	scenario.m_areas.push_back( zig3 );
-	Area *zig4=new Area();
+	Area *zig4=scenario.CreateArea();
 	zig4->m_bounds.SetFromMinXYMaxXY( 470.f, -576.f, 554.f,-376.f );
-	scenario.m_areas.push_back( zig4 );
-	Area *zig5=new Area();
+	Area *zig5=scenario.CreateArea();
 	zig5->m_bounds.SetFromMinXYMaxXY( 624.f, -76.f, 1512.f,76.f );
-	scenario.m_areas.push_back( zig5 );
 }
 
 
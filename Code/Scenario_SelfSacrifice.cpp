@@ -36,11 +36,10 @@ void ScenarioStartFunction_SelfSacrifice( Scenario& scenario )
 
 	const float aBaseY = aBottom-aHPerA/2.f-aOffsetY;
 
-	Actor *player=new Actor();
-	player->m_position = Vector2(pLeft+(pRight-pLeft)/2., aBaseY+(pTop-pGoalBottom));
-	player->m_isPlayer = true;
+	Actor *player=scenario.CreateActor();
+	player->SetPosition( Vector2(pLeft+(pRight-pLeft)/2., aBaseY+(pTop-pGoalBottom)) );
+	player->SetIsPlayer( true );
 	player->m_baseColor = Rgba::BLUE;
-	scenario.m_actors.push_back( player );
 
 	RelationshipToOtherActor followPlayer;
 	followPlayer.m_mimicMotionAtOuterDistance = Vector2(1,1);
@@ -48,30 +47,25 @@ void ScenarioStartFunction_SelfSacrifice( Scenario& scenario )
 	
 	for(int i = 0; i < aColumns; i++) {
 		for(int j = 0; j < aRows; j++) {
-			Actor *a = new Actor();
-			a->m_position = Vector2(aLeft+(aWPerA*i)+(aWPerA/2.f), aBaseY-(aHPerA*j));
+			Actor *a = scenario.CreateActor();
+			a->SetPosition( Vector2(aLeft+(aWPerA*i)+(aWPerA/2.f), aBaseY-(aHPerA*j)) );
 			a->m_relationships.push_back(followPlayer);
 			a->m_baseColor = Rgba::WHITE;
-			scenario.m_actors.push_back(a);
 		}
 	}
 
-	Area *pMain=new Area();
+	Area *pMain=scenario.CreateArea();
 	pMain->m_bounds.SetFromMinXYMaxXY( pLeft, pBottom, pRight, pTop );
-	scenario.m_areas.push_back( pMain );
-	Area *pGoal=new Area();
+	Area *pGoal=scenario.CreateArea();
 	pGoal->m_bounds.SetFromMinXYMaxXY( pLeft, pGoalBottom, pRight, pGoalTop );
 	pGoal->m_color = Rgba::WHITE;
 	pGoal->m_alpha = 1.0f;
-	scenario.m_areas.push_back( pGoal );
-	Area *aMain=new Area();
+	Area *aMain=scenario.CreateArea();
 	aMain->m_bounds.SetFromMinXYMaxXY( aLeft, aBottom, aRight, aTop );
-	scenario.m_areas.push_back( aMain );
-	Area *aGoal=new Area();
+	Area *aGoal=scenario.CreateArea();
 	aGoal->m_bounds.SetFromMinXYMaxXY( aLeft, aGoalBottom, aRight, aTop );
 	aGoal->m_color = Rgba::WHITE;
 	aGoal->m_alpha = 1.0f;
-	scenario.m_areas.push_back( aGoal );
 }
 
 
@@ -10,19 +10,51 @@
 //-----------------------------------------------------------------------------------------------
 // Definitions
 //
-#define JAZZ_PLATFORM_WIN32
+#if defined( _WIN32 )
+	#define JAZZ_PLATFORM_WIN32
+	#define JAZZ_USE_OPENGL
+#else
+	#define JAZZ_PLATFORM_POSIX // headless builds (no windowing, no OpenGL); see Main_Headless.cpp
+#endif
 #define STATIC // A do-nothing marker to denote static methods in .cpp files
 #define OUTPUT // A do-nothing marker to denote output arguments
 #define UNUSED( x ) (void)(x) // A warning-silencing macro denoting an intentionally unused argument
 
 
+#if defined( JAZZ_PLATFORM_WIN32 )
 //-----------------------------------------------------------------------------------------------
 // Windows includes
 //
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else
+//-----------------------------------------------------------------------------------------------
+// POSIX includes
+//
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Virtual-key codes used by the game, matching their Win32 values
+//
+#define VK_ESCAPE	0x1B
+#define VK_LEFT		0x25
+#define VK_UP		0x26
+#define VK_RIGHT	0x27
+#define VK_DOWN		0x28
+#define VK_F1		0x70
+#define VK_F2		0x71
+#define VK_F3		0x72
+#define VK_F4		0x73
+#define VK_F5		0x74
+#define VK_F6		0x75
+#define VK_F7		0x76
+#endif
 
 
+#if defined( JAZZ_USE_OPENGL )
 //-----------------------------------------------------------------------------------------------
 // OpenGL includes
 //
@@ -30,6 +62,7 @@
 #include <gl/glu.h>
 #pragma comment( lib, "opengl32" ) // Link in the OpenGL32.lib static library
 #pragma comment( lib, "Glu32" ) // Link in the Glu32.lib static library
+#endif
 
 
 //-----------------------------------------------------------------------------------------------
@@ -0,0 +1,268 @@
+//-----------------------------------------------------------------------------------------------
+// SimulationSnapshot.cpp
+//-----------------------------------------------------------------------------------------------
+#include "SimulationSnapshot.hpp"
+#include "Graphics.hpp"
+#include "ProfilingSection.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const float ACTOR_SHADOW_OFFSET = 3.f; // in x and y
+const float ACTOR_SHADOW_FALLOFF_PER_RADIUS = 0.2f;
+const long SNAPSHOT_INDEX_MASK = 0x3;
+const long SNAPSHOT_UNREAD_FLAG = 0x4;
+
+
+//-----------------------------------------------------------------------------------------------
+// FNV-1a over <numBytes> more bytes.
+//
+static unsigned int HashBytes( unsigned int hash, const void* bytes, size_t numBytes )
+{
+	const unsigned char* byte = (const unsigned char*) bytes;
+	for( size_t byteIndex = 0; byteIndex < numBytes; ++ byteIndex )
+	{
+		hash = (hash ^ byte[ byteIndex ]) * 16777619u;
+	}
+
+	return hash;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ActorDrawState::Draw( bool isShadowPass, float interpolationFraction ) const
+{
+	const Vector2 position = CalcInterpolatedPosition( interpolationFraction );
+	if( isShadowPass )
+	{
+		// One soft-edged circle standing in for three stacked 0.1-alpha circles at 1.0x-1.2x radius
+		const Vector2 actorShadowOffset( ACTOR_SHADOW_OFFSET, ACTOR_SHADOW_OFFSET );
+		const float coreAlpha = CalcAlphaOfStackedLayers( 0.1f * m_alpha, 3 );
+		DrawShadowCircle( position + actorShadowOffset, m_radius, ACTOR_SHADOW_FALLOFF_PER_RADIUS * m_radius, Rgba::BLACK, coreAlpha );
+	}
+	else
+	{
+		DrawFilledOutlinedCircle( position, m_radius, m_color, Rgba::BLACK, m_alpha );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Everything either pass of Draw can touch: the outline's outer edge and the shadow's falloff.
+//
+AABB2 ActorDrawState::CalcDrawBounds( float interpolationFraction ) const
+{
+	const Vector2 position = CalcInterpolatedPosition( interpolationFraction );
+	const float outlinedRadius = m_radius + (0.5f * RENDER_OUTLINE_WIDTH);
+	const float shadowRadius = m_radius * (1.f + ACTOR_SHADOW_FALLOFF_PER_RADIUS);
+	AABB2 drawBounds( position );
+	drawBounds.AddPadding( outlinedRadius, outlinedRadius );
+	AABB2 shadowBounds( position + Vector2( ACTOR_SHADOW_OFFSET, ACTOR_SHADOW_OFFSET ) );
+	shadowBounds.AddPadding( shadowRadius, shadowRadius );
+	drawBounds.StretchBoundsToIncludeBox( shadowBounds );
+	return drawBounds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void AreaDrawState::Draw( bool isShadowPass ) const
+{
+	if( isShadowPass )
+	{
+		float falloffWidth = 0.f;
+		const AABB2 shadowArea = CalcShadowArea( falloffWidth );
+		DrawShadowArea( shadowArea, falloffWidth, Rgba::BLACK, CalcAlphaOfStackedLayers( 0.1f * m_alpha, 3 ) );
+	}
+	else
+	{
+		DrawFilledArea( m_bounds, m_color, m_alpha );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// One soft-edged quad standing in for three stacked 0.1-alpha quads padded by 0, 1x and 2x the
+//	falloff step (4 units for deep shadows, 1 otherwise).
+//
+AABB2 AreaDrawState::CalcShadowArea( OUTPUT float& falloffWidth ) const
+{
+	const float paddingStep = m_deepShadow ? 4.f : 1.f;
+	const Vector2 areaShadowOffset = m_deepShadow ? Vector2( 10.f, 10.f ) : Vector2( 3.f, 3.f );
+	AABB2 shadowArea( m_bounds );
+	shadowArea.Translate( areaShadowOffset );
+	falloffWidth = 2.f * paddingStep;
+	return shadowArea;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Everything either pass of Draw can touch, including the shadow's falloff.
+//
+AABB2 AreaDrawState::CalcDrawBounds() const
+{
+	float falloffWidth = 0.f;
+	AABB2 drawBounds = CalcShadowArea( falloffWidth );
+	drawBounds.AddPadding( falloffWidth, falloffWidth );
+	drawBounds.StretchBoundsToIncludeBox( m_bounds );
+	return drawBounds;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Folds everything Draw reads into <hash>, so a cached drawing of this area can tell it's stale.
+//
+unsigned int AreaDrawState::CalcRenderSignature( unsigned int hash ) const
+{
+	hash = HashBytes( hash, &m_bounds.mins.x, sizeof( m_bounds.mins.x ) );
+	hash = HashBytes( hash, &m_bounds.mins.y, sizeof( m_bounds.mins.y ) );
+	hash = HashBytes( hash, &m_bounds.maxs.x, sizeof( m_bounds.maxs.x ) );
+	hash = HashBytes( hash, &m_bounds.maxs.y, sizeof( m_bounds.maxs.y ) );
+	hash = HashBytes( hash, &m_color.r, sizeof( m_color.r ) );
+	hash = HashBytes( hash, &m_color.g, sizeof( m_color.g ) );
+	hash = HashBytes( hash, &m_color.b, sizeof( m_color.b ) );
+	hash = HashBytes( hash, &m_color.a, sizeof( m_color.a ) );
+	hash = HashBytes( hash, &m_alpha, sizeof( m_alpha ) );
+	hash = HashBytes( hash, &m_deepShadow, sizeof( m_deepShadow ) );
+	return hash;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Cheap enough to take every frame (a few dozen bytes per area), so nothing that edits an area's
+//	bounds, color or alpha has to remember to invalidate the area layer.
+//
+unsigned int SimulationSnapshot::CalcAreaRenderSignature() const
+{
+	unsigned int hash = 2166136261u ^ (unsigned int) m_areas.size();
+	for( unsigned int areaIndex = 0; areaIndex < m_areas.size(); ++ areaIndex )
+	{
+		hash = m_areas[ areaIndex ].CalcRenderSignature( hash );
+	}
+
+	return hash;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SimulationSnapshotRenderer::Render( const SimulationSnapshot& snapshot, float interpolationFraction )
+{
+	PROFILE_SECTION( "SimulationSnapshotRenderer::Render" );
+	const AABB2& viewBounds = GetViewBounds();
+
+	// Render all areas (shadows first, then normal) into a retained layer, which backends keep
+	//	as-is from frame to frame until something an area draws with (or the view) actually changes
+	const unsigned int areaSignature = snapshot.CalcAreaRenderSignature();
+	if( m_areaLayer.GetVersion() == 0 || areaSignature != m_areaLayerSignature
+		|| viewBounds.mins != m_areaLayerViewBounds.mins || viewBounds.maxs != m_areaLayerViewBounds.maxs )
+	{
+		BeginRecordingLayer( m_areaLayer );
+		unsigned int areaIndex;
+		for( areaIndex = 0; areaIndex < snapshot.m_areas.size(); ++ areaIndex )
+		{
+			const AreaDrawState& area = snapshot.m_areas[ areaIndex ];
+			if( area.CalcDrawBounds().IsOverlapping( viewBounds ) )
+			{
+				area.Draw( true );
+			}
+		}
+		for( areaIndex = 0; areaIndex < snapshot.m_areas.size(); ++ areaIndex )
+		{
+			const AreaDrawState& area = snapshot.m_areas[ areaIndex ];
+			if( area.CalcDrawBounds().IsOverlapping( viewBounds ) )
+			{
+				area.Draw( false );
+			}
+		}
+
+		EndRecordingLayer( m_areaLayer );
+		m_areaLayerSignature = areaSignature;
+		m_areaLayerViewBounds = viewBounds;
+	}
+
+	DrawLayer( m_areaLayer );
+
+	// Find the actors whose shadow or outline reaches into the view; nothing else is drawn
+	//	(a linear pass, rather than a spatial hash query, keeps them in draw order)
+	const unsigned int numActors = (unsigned int) snapshot.m_actors.size();
+	m_visibleActorIndices.clear();
+	unsigned int actorIndex;
+	for( actorIndex = 0; actorIndex < numActors; ++ actorIndex )
+	{
+		if( snapshot.m_actors[ actorIndex ].CalcDrawBounds( interpolationFraction ).IsOverlapping( viewBounds ) )
+		{
+			m_visibleActorIndices.push_back( actorIndex );
+		}
+	}
+
+	// Render shadows on all visible Actors
+	const unsigned int numVisibleActors = (unsigned int) m_visibleActorIndices.size();
+	unsigned int visibleIndex;
+	for( visibleIndex = 0; visibleIndex < numVisibleActors; ++ visibleIndex )
+	{
+		snapshot.m_actors[ m_visibleActorIndices[ visibleIndex ] ].Draw( true, interpolationFraction );
+	}
+
+	// Render all visible NPCs
+	for( visibleIndex = 0; visibleIndex < numVisibleActors; ++ visibleIndex )
+	{
+		const ActorDrawState& actor = snapshot.m_actors[ m_visibleActorIndices[ visibleIndex ] ];
+		if( !actor.m_isPlayer )
+		{
+			actor.Draw( false, interpolationFraction );
+		}
+	}
+
+	// Render visible players (separated only so that players are drawn on top of NPCs
+	for( visibleIndex = 0; visibleIndex < numVisibleActors; ++ visibleIndex )
+	{
+		const ActorDrawState& actor = snapshot.m_actors[ m_visibleActorIndices[ visibleIndex ] ];
+		if( actor.m_isPlayer )
+		{
+			actor.Draw( false, interpolationFraction );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SimulationSnapshotTripleBuffer::SimulationSnapshotTripleBuffer()
+	: m_publishedIndexAndFlag( 1 )
+	, m_writeIndex( 0 )
+	, m_readIndex( 2 )
+	, m_hasAcquiredSnapshot( false )
+	, m_numSnapshotsSkipped( 0 )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Hands the write snapshot over and takes back whichever slot was published before it.  The
+//	exchange is a full barrier, so the reader sees the snapshot's contents once it sees its index.
+//
+void SimulationSnapshotTripleBuffer::PublishWriteSnapshot()
+{
+	const long previouslyPublished = AtomicExchange( m_publishedIndexAndFlag, (long) m_writeIndex | SNAPSHOT_UNREAD_FLAG );
+	if( previouslyPublished & SNAPSHOT_UNREAD_FLAG )
+	{
+		AtomicIncrement( m_numSnapshotsSkipped );
+	}
+
+	m_writeIndex = (unsigned int)( previouslyPublished & SNAPSHOT_INDEX_MASK );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Takes the published snapshot if it's newer than the one already held; otherwise keeps that one.
+//
+const SimulationSnapshot* SimulationSnapshotTripleBuffer::AcquireLatestSnapshot()
+{
+	if( m_publishedIndexAndFlag & SNAPSHOT_UNREAD_FLAG )
+	{
+		const long published = AtomicExchange( m_publishedIndexAndFlag, (long) m_readIndex );
+		m_readIndex = (unsigned int)( published & SNAPSHOT_INDEX_MASK );
+		m_hasAcquiredSnapshot = true;
+	}
+
+	return m_hasAcquiredSnapshot ? &m_snapshots[ m_readIndex ] : NULL;
+}
@@ -0,0 +1,117 @@
+//-----------------------------------------------------------------------------------------------
+// SimulationSnapshot.hpp
+//
+// Everything Scenario::Render needs from one simulation tick, copied out so the frame can be
+//	drawn on another thread while the simulation moves on.  Snapshots are handed from the
+//	simulation thread to the render thread through a lock-free triple buffer.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_SimulationSnapshot__
+#define __include_SimulationSnapshot__
+#pragma once
+#include "AABB2.hpp"
+#include "Vector2.hpp"
+#include "Rgba.hpp"
+#include "RenderCommandBuffer.hpp"
+#include "Threading.hpp"
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class ActorDrawState
+{
+public:
+	void Draw( bool isShadowPass, float interpolationFraction ) const;
+	AABB2 CalcDrawBounds( float interpolationFraction ) const;
+	Vector2 CalcInterpolatedPosition( float interpolationFraction ) const { return Interpolate( m_previousPosition, m_position, interpolationFraction ); }
+
+	Vector2 m_previousPosition;
+	Vector2 m_position;
+	float m_radius;
+	float m_alpha;
+	Rgba m_color;
+	bool m_isPlayer;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class AreaDrawState
+{
+public:
+	void Draw( bool isShadowPass ) const;
+	AABB2 CalcShadowArea( OUTPUT float& falloffWidth ) const;
+	AABB2 CalcDrawBounds() const;
+	unsigned int CalcRenderSignature( unsigned int hash ) const;
+
+	AABB2 m_bounds;
+	Rgba m_color;
+	float m_alpha;
+	bool m_deepShadow;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Living actors only, in store order; areas in creation order.
+//
+class SimulationSnapshot
+{
+public:
+	SimulationSnapshot() : m_tickNumber( 0 ), m_tickRealTimeSeconds( 0.0 ) {}
+	void Clear() { m_actors.clear(); m_areas.clear(); m_tickNumber = 0; m_tickRealTimeSeconds = 0.0; }
+	unsigned int CalcAreaRenderSignature() const;
+
+	std::vector< ActorDrawState > m_actors;
+	std::vector< AreaDrawState > m_areas;
+	unsigned int m_tickNumber; // simulation steps taken by the scenario when this was captured
+	double m_tickRealTimeSeconds; // absolute (Clock) time the current positions correspond to; renderers interpolate from here
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Draws snapshots in Scenario::Render's order: area shadows, areas, actor shadows, NPCs, then
+//	players.  Areas go through a retained layer that is only re-recorded when they (or the view)
+//	change, and nothing outside the view is recorded at all.  Use one renderer per thread.
+//
+class SimulationSnapshotRenderer
+{
+public:
+	SimulationSnapshotRenderer() : m_areaLayerSignature( 0 ), m_areaLayerViewBounds( 0.f, 0.f, 0.f, 0.f ) {}
+	void Render( const SimulationSnapshot& snapshot, float interpolationFraction );
+	const RenderLayer& GetAreaLayer() const { return m_areaLayer; }
+
+private:
+	RenderLayer m_areaLayer;
+	unsigned int m_areaLayerSignature;
+	AABB2 m_areaLayerViewBounds;
+	std::vector< unsigned int > m_visibleActorIndices; // kept to reuse its storage
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Three snapshots: one being written, one being read, and the most recently published one.
+//	Publishing and acquiring each swap a buffer with the published slot in a single atomic
+//	exchange, so neither side ever waits for the other; the reader just skips snapshots the
+//	writer published in between.  Exactly one writer thread and one reader thread.
+//
+class SimulationSnapshotTripleBuffer
+{
+public:
+	SimulationSnapshotTripleBuffer();
+	SimulationSnapshot& GetWriteSnapshot() { return m_snapshots[ m_writeIndex ]; }
+	void PublishWriteSnapshot();
+	const SimulationSnapshot* AcquireLatestSnapshot(); // NULL until something is published; otherwise stays valid until the next call
+	unsigned int GetNumSnapshotsSkipped() const { return (unsigned int) m_numSnapshotsSkipped; }
+
+private:
+	SimulationSnapshotTripleBuffer( const SimulationSnapshotTripleBuffer& ); // not copyable
+	void operator = ( const SimulationSnapshotTripleBuffer& );
+
+private:
+	SimulationSnapshot m_snapshots[ 3 ];
+	volatile long m_publishedIndexAndFlag; // index of the published slot, plus SNAPSHOT_UNREAD_FLAG until the reader takes it
+	unsigned int m_writeIndex; // owned by the writer
+	unsigned int m_readIndex; // owned by the reader
+	bool m_hasAcquiredSnapshot; // reader only
+	volatile long m_numSnapshotsSkipped; // published but replaced before the reader got to them
+};
+
+
+#endif // __include_SimulationSnapshot__
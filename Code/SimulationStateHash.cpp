@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------------------------
+// SimulationStateHash.cpp
+//-----------------------------------------------------------------------------------------------
+#include "SimulationStateHash.hpp"
+#include "TheGame.hpp"
+#include <string.h>
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const SimulationStateHash SIMULATION_STATE_HASH_PRIME = 1099511628211ULL; // FNV 64-bit prime
+
+
+//-----------------------------------------------------------------------------------------------
+// FNV-1a, a 32-bit word at a time rather than a byte at a time; multiplying by the (odd) prime
+//	can't map two different values to the same hash, so any one changed word changes the result.
+//
+static inline SimulationStateHash HashWord( SimulationStateHash hash, unsigned int word )
+{
+	return (hash ^ word) * SIMULATION_STATE_HASH_PRIME;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static inline SimulationStateHash HashFloat( SimulationStateHash hash, float value )
+{
+	unsigned int bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	return HashWord( hash, bits );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static inline SimulationStateHash HashLongWord( SimulationStateHash hash, SimulationStateHash longWord )
+{
+	return HashWord( HashWord( hash, (unsigned int) longWord ), (unsigned int)( longWord >> 32 ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The same fields HashScenarioState covers, for comparing one area at a time.
+//
+SimulationStateHash HashAreaState( const Area& area, SimulationStateHash hash )
+{
+	hash = HashFloat( hash, area.m_bounds.mins.x );
+	hash = HashFloat( hash, area.m_bounds.mins.y );
+	hash = HashFloat( hash, area.m_bounds.maxs.x );
+	hash = HashFloat( hash, area.m_bounds.maxs.y );
+	hash = HashFloat( hash, area.m_alpha );
+	hash = HashWord( hash, (area.m_impassableToPlayer ? 1u : 0u) | (area.m_impassableToNPC ? 2u : 0u) );
+	return hash;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Actors in store order, then areas in creation order; the counts go in first, so adding an
+//	actor or area can't go unnoticed.  Fields get hash chains of their own, folded together at the
+//	end, so the multiplies for one actor (or area) don't wait on each other.
+//
+SimulationStateHash HashScenarioState( const Scenario& scenario )
+{
+	const ActorStore& actors = scenario.m_actors;
+	const unsigned int numActors = actors.GetNumActors();
+	const unsigned int numAreas = (unsigned int) scenario.m_areas.size();
+	SimulationStateHash positionXHash = SIMULATION_STATE_HASH_SEED;
+	SimulationStateHash positionYHash = SIMULATION_STATE_HASH_SEED;
+	SimulationStateHash stateHash = SIMULATION_STATE_HASH_SEED;
+	SimulationStateHash radiusScaleHash = SIMULATION_STATE_HASH_SEED;
+	SimulationStateHash alphaScaleHash = SIMULATION_STATE_HASH_SEED;
+	for( unsigned int actorIndex = 0; actorIndex < numActors; ++ actorIndex )
+	{
+		positionXHash = HashFloat( positionXHash, actors.m_positions[ actorIndex ].x );
+		positionYHash = HashFloat( positionYHash, actors.m_positions[ actorIndex ].y );
+		stateHash = HashWord( stateHash, (unsigned int) actors.m_states[ actorIndex ] );
+		radiusScaleHash = HashFloat( radiusScaleHash, actors.m_radiusScales[ actorIndex ] );
+		alphaScaleHash = HashFloat( alphaScaleHash, actors.m_alphaScales[ actorIndex ] );
+	}
+
+	SimulationStateHash areaMinsHash = SIMULATION_STATE_HASH_SEED;
+	SimulationStateHash areaMaxsHash = SIMULATION_STATE_HASH_SEED;
+	SimulationStateHash areaAlphaHash = SIMULATION_STATE_HASH_SEED;
+	SimulationStateHash areaFlagsHash = SIMULATION_STATE_HASH_SEED;
+	for( unsigned int areaIndex = 0; areaIndex < numAreas; ++ areaIndex )
+	{
+		const Area& area = *scenario.m_areas[ areaIndex ];
+		areaMinsHash = HashFloat( HashFloat( areaMinsHash, area.m_bounds.mins.x ), area.m_bounds.mins.y );
+		areaMaxsHash = HashFloat( HashFloat( areaMaxsHash, area.m_bounds.maxs.x ), area.m_bounds.maxs.y );
+		areaAlphaHash = HashFloat( areaAlphaHash, area.m_alpha );
+		areaFlagsHash = HashWord( areaFlagsHash, (area.m_impassableToPlayer ? 1u : 0u) | (area.m_impassableToNPC ? 2u : 0u) );
+	}
+
+	SimulationStateHash hash = SIMULATION_STATE_HASH_SEED;
+	hash = HashWord( hash, numActors );
+	hash = HashWord( hash, numAreas );
+	hash = HashLongWord( hash, positionXHash );
+	hash = HashLongWord( hash, positionYHash );
+	hash = HashLongWord( hash, stateHash );
+	hash = HashLongWord( hash, radiusScaleHash );
+	hash = HashLongWord( hash, alphaScaleHash );
+	hash = HashLongWord( hash, areaMinsHash );
+	hash = HashLongWord( hash, areaMaxsHash );
+	hash = HashLongWord( hash, areaAlphaHash );
+	hash = HashLongWord( hash, areaFlagsHash );
+	return hash;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// SimulationStateHashLog
+
+//-----------------------------------------------------------------------------------------------
+void SimulationStateHashLog::Clear()
+{
+	m_tickHashes.clear();
+	m_combinedHash = SIMULATION_STATE_HASH_SEED;
+	m_secondsHashing = 0.0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SimulationStateHashLog::RecordTick( const Scenario& scenario )
+{
+	const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	const SimulationStateHash tickHash = HashScenarioState( scenario );
+	m_tickHashes.push_back( tickHash );
+	m_combinedHash = HashLongWord( m_combinedHash, tickHash );
+	m_secondsHashing += Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+}
@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------------------------
+// SimulationStateHash.hpp
+//
+// Checksums of a scenario's simulation state (actor positions, states, radius and alpha scales,
+//	and areas), taken after each Scenario::Update when a log is attached.  Values are hashed by
+//	their bits, so two update paths only match if they agree exactly, including rounding.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_SimulationStateHash__
+#define __include_SimulationStateHash__
+#pragma once
+#include "Utilities.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Definitions
+//
+typedef unsigned long long SimulationStateHash;
+
+const SimulationStateHash SIMULATION_STATE_HASH_SEED = 14695981039346656037ULL; // FNV-1a 64-bit offset basis
+
+class Scenario;
+class Area;
+
+
+//-----------------------------------------------------------------------------------------------
+// State hashing functions; each folds more state into <hash>
+//
+SimulationStateHash HashAreaState( const Area& area, SimulationStateHash hash );
+SimulationStateHash HashScenarioState( const Scenario& scenario );
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// One hash per tick since the last Clear, plus a running hash of them all, so a whole run can be
+//	checked against another with a single value.  Attach to Scenario::m_stateHashLog.
+//
+class SimulationStateHashLog
+{
+public:
+	SimulationStateHashLog() : m_combinedHash( SIMULATION_STATE_HASH_SEED ), m_secondsHashing( 0.0 ) {}
+	void Clear();
+	void RecordTick( const Scenario& scenario );
+	unsigned int GetNumTicks() const { return (unsigned int) m_tickHashes.size(); }
+	SimulationStateHash GetTickHash( unsigned int tickIndex ) const { return m_tickHashes[ tickIndex ]; }
+	SimulationStateHash GetLatestHash() const { return m_tickHashes.empty() ? SIMULATION_STATE_HASH_SEED : m_tickHashes.back(); }
+	SimulationStateHash GetCombinedHash() const { return m_combinedHash; }
+	double GetSecondsHashing() const { return m_secondsHashing; }
+
+private:
+	std::vector< SimulationStateHash > m_tickHashes;
+	SimulationStateHash m_combinedHash;
+	double m_secondsHashing;
+};
+
+
+#endif // __include_SimulationStateHash__
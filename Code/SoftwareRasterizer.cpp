@@ -0,0 +1,551 @@
+//-----------------------------------------------------------------------------------------------
+// SoftwareRasterizer.cpp
+//-----------------------------------------------------------------------------------------------
+#include "SoftwareRasterizer.hpp"
+
+// MSVC exposes SSE2 intrinsics regardless of /arch; GCC and Clang only when targeting SSE2
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _MSC_VER ) && defined( _M_IX86 ) )
+	#define JAZZ_USE_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// Index of the first pixel whose center (x + 0.5) is at or past <coordinate>.
+//
+static inline int CalcFirstPixelAtOrAfter( float coordinate )
+{
+	return (int) ceilf( coordinate - 0.5f );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// dst = (src * srcAlpha + dst * (255 - srcAlpha)) / 255, rounded, per channel (alpha included,
+//	as GL blends it with the same factors).  The SSE2 and scalar paths give identical results.
+//
+static inline unsigned char BlendChannel( int sourceTimesAlphaPlusHalf, int destination, int inverseAlpha )
+{
+	const int sum = sourceTimesAlphaPlusHalf + (destination * inverseAlpha);
+	return (unsigned char)( (sum + (sum >> 8)) >> 8 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+SoftwareRenderBackend::SoftwareRenderBackend( int width, int height, const AABB2& viewBounds )
+	: m_numPixelsBlended( 0 )
+	, m_width( width )
+	, m_height( height )
+	, m_viewMins( viewBounds.mins )
+	, m_pixelsPerViewUnit( (float) width / (viewBounds.maxs.x - viewBounds.mins.x), (float) height / (viewBounds.maxs.y - viewBounds.mins.y) )
+	, m_clearColor( 25, 76, 255, 255 ) // TheGame::SetUpView's glClearColor
+	, m_threadPool( NULL )
+	, m_pixels( 4 * width * height, 0 )
+	, m_shadowFalloffByDistanceSquared( SHADOW_FALLOFF_TABLE_SIZE + 1 )
+	, m_numPixelsBlendedPerTile( (height + SOFTWARE_RASTER_TILE_HEIGHT - 1) / SOFTWARE_RASTER_TILE_HEIGHT, 0 )
+	, m_commands( NULL )
+	, m_backgroundLayer( NULL )
+	, m_numBackgroundPixelsBlendedPerTile( m_numPixelsBlendedPerTile.size(), 0 )
+	, m_isCachedBackgroundValid( false )
+	, m_isBackgroundWorthCaching( false )
+	, m_cachedBackgroundLayerId( 0 )
+	, m_cachedBackgroundLayerVersion( 0 )
+{
+	for( int tableIndex = 0; tableIndex <= SHADOW_FALLOFF_TABLE_SIZE; ++ tableIndex )
+	{
+		m_shadowFalloffByDistanceSquared[ tableIndex ] = 1.f - sqrtf( (float) tableIndex / (float) SHADOW_FALLOFF_TABLE_SIZE );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Clears and redraws the whole framebuffer, one band of rows per ParallelFor item.
+//
+void SoftwareRenderBackend::Execute( const RenderCommandBuffer& commands )
+{
+	m_commands = &commands;
+	m_backgroundLayer = NULL;
+	if( commands.GetNumCommands() > 0 && commands.GetCommand( 0 ).GetType() == RENDER_COMMAND_LAYER )
+	{
+		const RenderLayer& layer = commands.GetLayer( commands.GetCommand( 0 ) );
+		m_isCachedBackgroundValid = layer.GetId() == m_cachedBackgroundLayerId
+			&& layer.GetVersion() == m_cachedBackgroundLayerVersion
+			&& m_clearColor == m_cachedBackgroundClearColor;
+
+		// Copying the cache in costs about as much as blending a full frame, so sparse layers are just redrawn
+		if( !m_isCachedBackgroundValid || m_isBackgroundWorthCaching )
+		{
+			m_backgroundLayer = &layer;
+			m_cachedBackground.resize( m_pixels.size() );
+		}
+	}
+
+	const int numTiles = (m_height + SOFTWARE_RASTER_TILE_HEIGHT - 1) / SOFTWARE_RASTER_TILE_HEIGHT;
+	if( m_threadPool && m_threadPool->GetNumWorkerThreads() > 0 )
+	{
+		m_threadPool->ParallelFor( numTiles, 1, RasterizeTileBatch, this );
+	}
+	else
+	{
+		for( int tileIndex = 0; tileIndex < numTiles; ++ tileIndex )
+		{
+			RasterizeTile( tileIndex );
+		}
+	}
+
+	if( m_backgroundLayer && !m_isCachedBackgroundValid )
+	{
+		int numBackgroundPixelsBlended = 0;
+		for( int tileIndex = 0; tileIndex < numTiles; ++ tileIndex )
+		{
+			numBackgroundPixelsBlended += m_numBackgroundPixelsBlendedPerTile[ tileIndex ];
+		}
+
+		m_cachedBackgroundLayerId = m_backgroundLayer->GetId();
+		m_cachedBackgroundLayerVersion = m_backgroundLayer->GetVersion();
+		m_cachedBackgroundClearColor = m_clearColor;
+		m_isBackgroundWorthCaching = numBackgroundPixelsBlended >= m_width * m_height;
+	}
+
+	m_commands = NULL;
+	m_backgroundLayer = NULL;
+	for( int tileIndex = 0; tileIndex < numTiles; ++ tileIndex )
+	{
+		m_numPixelsBlended += (double) m_numPixelsBlendedPerTile[ tileIndex ];
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void SoftwareRenderBackend::RasterizeTileBatch( void* userData, unsigned int beginIndex, unsigned int endIndex, unsigned int participantIndex )
+{
+	UNUSED( participantIndex );
+	SoftwareRenderBackend& backend = *(SoftwareRenderBackend*) userData;
+	for( unsigned int tileIndex = beginIndex; tileIndex < endIndex; ++ tileIndex )
+	{
+		backend.RasterizeTile( (int) tileIndex );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SoftwareRenderBackend::RasterizeTile( int tileIndex )
+{
+	const int minRow = tileIndex * SOFTWARE_RASTER_TILE_HEIGHT;
+	const int maxRow = MinInt( minRow + SOFTWARE_RASTER_TILE_HEIGHT, m_height );
+
+	const size_t tileFirstByte = 4 * minRow * m_width;
+	const size_t tileNumBytes = 4 * (maxRow - minRow) * m_width;
+	int numPixelsBlended = 0;
+	if( m_backgroundLayer && m_isCachedBackgroundValid )
+	{
+		memcpy( &m_pixels[ tileFirstByte ], &m_cachedBackground[ tileFirstByte ], tileNumBytes );
+	}
+	else
+	{
+		RenderCommand clearCommand;
+		clearCommand.m_r = m_clearColor.r;
+		clearCommand.m_g = m_clearColor.g;
+		clearCommand.m_b = m_clearColor.b;
+		clearCommand.m_a = 255;
+		for( int row = minRow; row < maxRow; ++ row )
+		{
+			FillSpan( row, 0, m_width, clearCommand );
+		}
+
+		if( m_backgroundLayer )
+		{
+			m_numBackgroundPixelsBlendedPerTile[ tileIndex ] = RasterizeCommands( m_backgroundLayer->m_commands, 0, minRow, maxRow );
+			numPixelsBlended += m_numBackgroundPixelsBlendedPerTile[ tileIndex ];
+			memcpy( &m_cachedBackground[ tileFirstByte ], &m_pixels[ tileFirstByte ], tileNumBytes );
+		}
+	}
+
+	numPixelsBlended += RasterizeCommands( *m_commands, m_backgroundLayer ? 1 : 0, minRow, maxRow );
+	m_numPixelsBlendedPerTile[ tileIndex ] = numPixelsBlended;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+int SoftwareRenderBackend::RasterizeCommands( const RenderCommandBuffer& commands, unsigned int firstCommandIndex, int minRow, int maxRow )
+{
+	int numPixelsBlended = 0;
+	for( unsigned int commandIndex = firstCommandIndex; commandIndex < commands.GetNumCommands(); ++ commandIndex )
+	{
+		const RenderCommand& command = commands.GetCommand( commandIndex );
+		switch( command.GetType() )
+		{
+			case RENDER_COMMAND_FILLED_CIRCLE:		numPixelsBlended += RasterizeCircle( command, minRow, maxRow, false );	break;
+			case RENDER_COMMAND_OUTLINED_CIRCLE:	numPixelsBlended += RasterizeCircle( command, minRow, maxRow, true );	break;
+			case RENDER_COMMAND_FILLED_QUAD:		numPixelsBlended += RasterizeQuad( command, minRow, maxRow, false );	break;
+			case RENDER_COMMAND_OUTLINED_QUAD:		numPixelsBlended += RasterizeQuad( command, minRow, maxRow, true );		break;
+			case RENDER_COMMAND_SHADOW_CIRCLE:		numPixelsBlended += RasterizeShadowCircle( command, minRow, maxRow );	break;
+			case RENDER_COMMAND_SHADOW_QUAD:		numPixelsBlended += RasterizeShadowQuad( command, minRow, maxRow );		break;
+			case RENDER_COMMAND_LAYER:				numPixelsBlended += RasterizeCommands( commands.GetLayer( command ).m_commands, 0, minRow, maxRow );	break;
+			default:								break;
+		}
+	}
+
+	return numPixelsBlended;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Outlines are a ring RENDER_OUTLINE_WIDTH wide centered on the radius; each row of the ring is
+//	the outer span minus the inner one, so no pixel is blended twice.
+//
+int SoftwareRenderBackend::RasterizeCircle( const RenderCommand& command, int minRow, int maxRow, bool isOutline )
+{
+	const Vector2 center = command.GetCircleCenter();
+	const float centerX = (center.x - m_viewMins.x) * m_pixelsPerViewUnit.x;
+	const float centerY = (center.y - m_viewMins.y) * m_pixelsPerViewUnit.y;
+	const float radius = command.GetCircleRadius();
+	const float outerRadius = isOutline ? radius + (0.5f * RENDER_OUTLINE_WIDTH) : radius;
+	const float innerRadius = isOutline ? MaxFloat( radius - (0.5f * RENDER_OUTLINE_WIDTH), 0.f ) : 0.f;
+	const float outerRadiusX = outerRadius * m_pixelsPerViewUnit.x;
+	const float outerRadiusY = outerRadius * m_pixelsPerViewUnit.y;
+	const float innerRadiusX = innerRadius * m_pixelsPerViewUnit.x;
+	const float innerRadiusY = innerRadius * m_pixelsPerViewUnit.y;
+
+	const int firstRow = MaxInt( minRow, CalcFirstPixelAtOrAfter( centerY - outerRadiusY ) );
+	const int lastRow = MinInt( maxRow, CalcFirstPixelAtOrAfter( centerY + outerRadiusY ) );
+	int numPixelsBlended = 0;
+	for( int row = firstRow; row < lastRow; ++ row )
+	{
+		const float offsetY = ((float) row + 0.5f) - centerY;
+		const float outerFraction = 1.f - ((offsetY * offsetY) / (outerRadiusY * outerRadiusY));
+		if( outerFraction <= 0.f )
+			continue;
+
+		const float outerHalfWidth = outerRadiusX * sqrtf( outerFraction );
+		const int outerMinX = CalcFirstPixelAtOrAfter( centerX - outerHalfWidth );
+		const int outerMaxX = CalcFirstPixelAtOrAfter( centerX + outerHalfWidth );
+		const float innerFraction = innerRadiusY > 0.f ? 1.f - ((offsetY * offsetY) / (innerRadiusY * innerRadiusY)) : 0.f;
+		if( innerFraction <= 0.f )
+		{
+			numPixelsBlended += FillSpan( row, outerMinX, outerMaxX, command );
+			continue;
+		}
+
+		const float innerHalfWidth = innerRadiusX * sqrtf( innerFraction );
+		numPixelsBlended += FillSpan( row, outerMinX, CalcFirstPixelAtOrAfter( centerX - innerHalfWidth ), command );
+		numPixelsBlended += FillSpan( row, CalcFirstPixelAtOrAfter( centerX + innerHalfWidth ), outerMaxX, command );
+	}
+
+	return numPixelsBlended;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Outlines are the band between the bounds grown and shrunk by half of RENDER_OUTLINE_WIDTH,
+//	filled as up to four non-overlapping rectangles.
+//
+int SoftwareRenderBackend::RasterizeQuad( const RenderCommand& command, int minRow, int maxRow, bool isOutline )
+{
+	const AABB2 bounds = command.GetQuadBounds();
+	const float halfOutlineWidth = isOutline ? 0.5f * RENDER_OUTLINE_WIDTH : 0.f;
+	const int outerMinX = CalcFirstPixelAtOrAfter( (bounds.mins.x - halfOutlineWidth - m_viewMins.x) * m_pixelsPerViewUnit.x );
+	const int outerMinY = CalcFirstPixelAtOrAfter( (bounds.mins.y - halfOutlineWidth - m_viewMins.y) * m_pixelsPerViewUnit.y );
+	const int outerMaxX = CalcFirstPixelAtOrAfter( (bounds.maxs.x + halfOutlineWidth - m_viewMins.x) * m_pixelsPerViewUnit.x );
+	const int outerMaxY = CalcFirstPixelAtOrAfter( (bounds.maxs.y + halfOutlineWidth - m_viewMins.y) * m_pixelsPerViewUnit.y );
+	if( outerMaxY <= minRow || outerMinY >= maxRow )
+		return 0;
+
+	const int innerMinX = CalcFirstPixelAtOrAfter( (bounds.mins.x + halfOutlineWidth - m_viewMins.x) * m_pixelsPerViewUnit.x );
+	const int innerMinY = CalcFirstPixelAtOrAfter( (bounds.mins.y + halfOutlineWidth - m_viewMins.y) * m_pixelsPerViewUnit.y );
+	const int innerMaxX = CalcFirstPixelAtOrAfter( (bounds.maxs.x - halfOutlineWidth - m_viewMins.x) * m_pixelsPerViewUnit.x );
+	const int innerMaxY = CalcFirstPixelAtOrAfter( (bounds.maxs.y - halfOutlineWidth - m_viewMins.y) * m_pixelsPerViewUnit.y );
+	if( !isOutline || innerMinX >= innerMaxX || innerMinY >= innerMaxY )
+	{
+		return FillRect( outerMinX, outerMinY, outerMaxX, outerMaxY, minRow, maxRow, command );
+	}
+
+	return FillRect( outerMinX, outerMinY, outerMaxX, innerMinY, minRow, maxRow, command )
+		+ FillRect( outerMinX, innerMinY, innerMinX, innerMaxY, minRow, maxRow, command )
+		+ FillRect( innerMaxX, innerMinY, outerMaxX, innerMaxY, minRow, maxRow, command )
+		+ FillRect( outerMinX, innerMaxY, outerMaxX, outerMaxY, minRow, maxRow, command );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Each row is one constant-alpha span inside the radius (as a filled circle) plus the falloff
+//	spans either side, whose alpha drops linearly with distance to zero at radius + falloff.
+//
+int SoftwareRenderBackend::RasterizeShadowCircle( const RenderCommand& command, int minRow, int maxRow )
+{
+	if( command.GetShadowFalloffWidth() <= 0.f )
+		return RasterizeCircle( command, minRow, maxRow, false );
+
+	const Vector2 center = command.GetCircleCenter();
+	const float centerX = (center.x - m_viewMins.x) * m_pixelsPerViewUnit.x;
+	const float centerY = (center.y - m_viewMins.y) * m_pixelsPerViewUnit.y;
+	const float innerRadius = command.GetCircleRadius();
+	const float outerRadius = innerRadius + command.GetShadowFalloffWidth();
+	const float outerRadiusX = outerRadius * m_pixelsPerViewUnit.x;
+	const float outerRadiusY = outerRadius * m_pixelsPerViewUnit.y;
+	const float innerRadiusX = innerRadius * m_pixelsPerViewUnit.x;
+	const float innerRadiusY = innerRadius * m_pixelsPerViewUnit.y;
+	const float alphaPerUnitDistance = (float) command.m_a / (1.f - (innerRadius / outerRadius)); // alpha at (1 - distance) along the falloff
+
+	const int firstRow = MaxInt( minRow, CalcFirstPixelAtOrAfter( centerY - outerRadiusY ) );
+	const int lastRow = MinInt( maxRow, CalcFirstPixelAtOrAfter( centerY + outerRadiusY ) );
+	int numPixelsBlended = 0;
+	for( int row = firstRow; row < lastRow; ++ row )
+	{
+		const float offsetY = ((float) row + 0.5f) - centerY;
+		const float outerFraction = 1.f - ((offsetY * offsetY) / (outerRadiusY * outerRadiusY));
+		if( outerFraction <= 0.f )
+			continue;
+
+		const float outerHalfWidth = outerRadiusX * sqrtf( outerFraction );
+		const int outerMinX = MaxInt( CalcFirstPixelAtOrAfter( centerX - outerHalfWidth ), 0 );
+		const int outerMaxX = MinInt( CalcFirstPixelAtOrAfter( centerX + outerHalfWidth ), m_width );
+		const float normalizedOffsetY = offsetY / outerRadiusY;
+		const float normalizedOffsetYSquared = normalizedOffsetY * normalizedOffsetY;
+		const float innerFraction = innerRadiusY > 0.f ? 1.f - ((offsetY * offsetY) / (innerRadiusY * innerRadiusY)) : 0.f;
+		if( innerFraction <= 0.f )
+		{
+			numPixelsBlended += BlendShadowCircleFalloffSpan( row, outerMinX, outerMaxX, centerX, 1.f / outerRadiusX, normalizedOffsetYSquared, alphaPerUnitDistance, command );
+			continue;
+		}
+
+		const float innerHalfWidth = innerRadiusX * sqrtf( innerFraction );
+		const int innerMinX = ClampInt( CalcFirstPixelAtOrAfter( centerX - innerHalfWidth ), outerMinX, outerMaxX );
+		const int innerMaxX = ClampInt( CalcFirstPixelAtOrAfter( centerX + innerHalfWidth ), innerMinX, outerMaxX );
+		numPixelsBlended += BlendShadowCircleFalloffSpan( row, outerMinX, innerMinX, centerX, 1.f / outerRadiusX, normalizedOffsetYSquared, alphaPerUnitDistance, command );
+		numPixelsBlended += FillSpan( row, innerMinX, innerMaxX, command );
+		numPixelsBlended += BlendShadowCircleFalloffSpan( row, innerMaxX, outerMaxX, centerX, 1.f / outerRadiusX, normalizedOffsetYSquared, alphaPerUnitDistance, command );
+	}
+
+	return numPixelsBlended;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Constant alpha inside the bounds; outside, alpha drops linearly with the larger of the x and y
+//	distances to the bounds (matching the GL backend's mitered falloff frame).  Above and below
+//	the bounds that distance is the same all along the middle of a row, so the middle is one
+//	constant-alpha span too.
+//
+int SoftwareRenderBackend::RasterizeShadowQuad( const RenderCommand& command, int minRow, int maxRow )
+{
+	const AABB2 bounds = command.GetQuadBounds();
+	const float falloffWidth = command.GetShadowFalloffWidth();
+	if( falloffWidth <= 0.f )
+		return RasterizeQuad( command, minRow, maxRow, false );
+
+	const int outerMinX = MaxInt( CalcFirstPixelAtOrAfter( (bounds.mins.x - falloffWidth - m_viewMins.x) * m_pixelsPerViewUnit.x ), 0 );
+	const int outerMinY = MaxInt( CalcFirstPixelAtOrAfter( (bounds.mins.y - falloffWidth - m_viewMins.y) * m_pixelsPerViewUnit.y ), minRow );
+	const int outerMaxX = MinInt( CalcFirstPixelAtOrAfter( (bounds.maxs.x + falloffWidth - m_viewMins.x) * m_pixelsPerViewUnit.x ), m_width );
+	const int outerMaxY = MinInt( CalcFirstPixelAtOrAfter( (bounds.maxs.y + falloffWidth - m_viewMins.y) * m_pixelsPerViewUnit.y ), maxRow );
+	const int innerMinX = ClampInt( CalcFirstPixelAtOrAfter( (bounds.mins.x - m_viewMins.x) * m_pixelsPerViewUnit.x ), outerMinX, outerMaxX );
+	const int innerMinY = CalcFirstPixelAtOrAfter( (bounds.mins.y - m_viewMins.y) * m_pixelsPerViewUnit.y );
+	const int innerMaxX = ClampInt( CalcFirstPixelAtOrAfter( (bounds.maxs.x - m_viewMins.x) * m_pixelsPerViewUnit.x ), innerMinX, outerMaxX );
+	const int innerMaxY = CalcFirstPixelAtOrAfter( (bounds.maxs.y - m_viewMins.y) * m_pixelsPerViewUnit.y );
+
+	int numPixelsBlended = 0;
+	for( int row = outerMinY; row < outerMaxY; ++ row )
+	{
+		const float y = m_viewMins.y + (((float) row + 0.5f) / m_pixelsPerViewUnit.y);
+		const float distanceY = MaxFloat( bounds.mins.y - y, y - bounds.maxs.y, 0.f );
+		numPixelsBlended += BlendShadowQuadFalloffSpan( row, outerMinX, innerMinX, bounds, distanceY, command );
+		if( row >= innerMinY && row < innerMaxY )
+		{
+			numPixelsBlended += FillSpan( row, innerMinX, innerMaxX, command );
+		}
+		else
+		{
+			RenderCommand fadedCommand = command;
+			fadedCommand.m_a = (unsigned char) ClampInt( (int)( ((1.f - (distanceY / falloffWidth)) * (float) command.m_a) + 0.5f ), 0, command.m_a );
+			numPixelsBlended += FillSpan( row, innerMinX, innerMaxX, fadedCommand );
+		}
+
+		numPixelsBlended += BlendShadowQuadFalloffSpan( row, innerMaxX, outerMaxX, bounds, distanceY, command );
+	}
+
+	return numPixelsBlended;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Fills pixels [minX,maxX) x [minY,maxY), limited to rows [minRow,maxRow).
+//
+int SoftwareRenderBackend::FillRect( int minX, int minY, int maxX, int maxY, int minRow, int maxRow, const RenderCommand& command )
+{
+	const int lastRow = MinInt( maxY, maxRow );
+	int numPixelsBlended = 0;
+	for( int row = MaxInt( minY, minRow ); row < lastRow; ++ row )
+	{
+		numPixelsBlended += FillSpan( row, minX, maxX, command );
+	}
+
+	return numPixelsBlended;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Blends the command's color over pixels [minX,maxX) of <row>, four pixels per SSE2 step.
+//	Returns the number of pixels written.
+//
+int SoftwareRenderBackend::FillSpan( int row, int minX, int maxX, const RenderCommand& command )
+{
+	minX = MaxInt( minX, 0 );
+	maxX = MinInt( maxX, m_width );
+	if( minX >= maxX || command.m_a == 0 )
+		return 0;
+
+	unsigned char* pixel = &m_pixels[ 4 * ((row * m_width) + minX) ];
+	const int numPixelsInSpan = maxX - minX;
+	int numPixels = numPixelsInSpan;
+	if( command.m_a == 255 )
+	{
+		const unsigned char color[ 4 ] = { command.m_r, command.m_g, command.m_b, command.m_a };
+#if defined( JAZZ_USE_SSE2 )
+		int packedColor;
+		memcpy( &packedColor, color, sizeof( packedColor ) );
+		const __m128i colorTimesFour = _mm_set1_epi32( packedColor );
+		for( ; numPixels >= 4; numPixels -= 4, pixel += 16 )
+		{
+			_mm_storeu_si128( (__m128i*) pixel, colorTimesFour );
+		}
+#endif
+		for( ; numPixels > 0; -- numPixels, pixel += 4 )
+		{
+			memcpy( pixel, color, 4 );
+		}
+
+		return numPixelsInSpan;
+	}
+
+	const int alpha = command.m_a;
+	const int inverseAlpha = 255 - alpha;
+	const int sourceR = (command.m_r * alpha) + 128;
+	const int sourceG = (command.m_g * alpha) + 128;
+	const int sourceB = (command.m_b * alpha) + 128;
+	const int sourceA = (command.m_a * alpha) + 128;
+#if defined( JAZZ_USE_SSE2 )
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i source = _mm_set_epi16( (short) sourceA, (short) sourceB, (short) sourceG, (short) sourceR, (short) sourceA, (short) sourceB, (short) sourceG, (short) sourceR );
+	const __m128i inverse = _mm_set1_epi16( (short) inverseAlpha );
+	for( ; numPixels >= 4; numPixels -= 4, pixel += 16 )
+	{
+		const __m128i destination = _mm_loadu_si128( (const __m128i*) pixel );
+		__m128i low = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( destination, zero ), inverse ), source );
+		__m128i high = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( destination, zero ), inverse ), source );
+		low = _mm_srli_epi16( _mm_add_epi16( low, _mm_srli_epi16( low, 8 ) ), 8 );
+		high = _mm_srli_epi16( _mm_add_epi16( high, _mm_srli_epi16( high, 8 ) ), 8 );
+		_mm_storeu_si128( (__m128i*) pixel, _mm_packus_epi16( low, high ) );
+	}
+#endif
+	for( ; numPixels > 0; -- numPixels, pixel += 4 )
+	{
+		pixel[ 0 ] = BlendChannel( sourceR, pixel[ 0 ], inverseAlpha );
+		pixel[ 1 ] = BlendChannel( sourceG, pixel[ 1 ], inverseAlpha );
+		pixel[ 2 ] = BlendChannel( sourceB, pixel[ 2 ], inverseAlpha );
+		pixel[ 3 ] = BlendChannel( sourceA, pixel[ 3 ], inverseAlpha );
+	}
+
+	return numPixelsInSpan;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Shadow circle falloff over pixels [minX,maxX) of <row>, a chunk of alphas at a time.  The
+//	squared distance from the center indexes the falloff table, so there's no square root per
+//	pixel.  Returns the number of pixels given a nonzero alpha.
+//
+int SoftwareRenderBackend::BlendShadowCircleFalloffSpan( int row, int minX, int maxX, float centerX, float inverseOuterRadiusX, float normalizedOffsetYSquared, float alphaPerUnitDistance, const RenderCommand& command )
+{
+	unsigned char alphas[ SHADOW_FALLOFF_CHUNK_PIXELS ];
+	const float* falloffByDistanceSquared = &m_shadowFalloffByDistanceSquared[ 0 ];
+	int numPixelsBlended = 0;
+	for( int chunkMinX = minX; chunkMinX < maxX; chunkMinX += SHADOW_FALLOFF_CHUNK_PIXELS )
+	{
+		const int chunkMaxX = MinInt( chunkMinX + SHADOW_FALLOFF_CHUNK_PIXELS, maxX );
+		for( int column = chunkMinX; column < chunkMaxX; ++ column )
+		{
+			const float normalizedOffsetX = (((float) column + 0.5f) - centerX) * inverseOuterRadiusX;
+			const float distanceSquared = (normalizedOffsetX * normalizedOffsetX) + normalizedOffsetYSquared;
+			const int tableIndex = MinInt( (int)( distanceSquared * (float) SHADOW_FALLOFF_TABLE_SIZE ), SHADOW_FALLOFF_TABLE_SIZE );
+			const int alpha = ClampInt( (int)( (falloffByDistanceSquared[ tableIndex ] * alphaPerUnitDistance) + 0.5f ), 0, command.m_a );
+			alphas[ column - chunkMinX ] = (unsigned char) alpha;
+			numPixelsBlended += alpha > 0 ? 1 : 0;
+		}
+
+		BlendSpanWithAlphas( row, chunkMinX, chunkMaxX, alphas, command );
+	}
+
+	return numPixelsBlended;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Shadow quad falloff over pixels [minX,maxX) of <row>, which lie left or right of the bounds.
+//	Returns the number of pixels given a nonzero alpha.
+//
+int SoftwareRenderBackend::BlendShadowQuadFalloffSpan( int row, int minX, int maxX, const AABB2& bounds, float distanceY, const RenderCommand& command )
+{
+	unsigned char alphas[ SHADOW_FALLOFF_CHUNK_PIXELS ];
+	const float alphaPerUnitDistance = (float) command.m_a / command.GetShadowFalloffWidth();
+	int numPixelsBlended = 0;
+	for( int chunkMinX = minX; chunkMinX < maxX; chunkMinX += SHADOW_FALLOFF_CHUNK_PIXELS )
+	{
+		const int chunkMaxX = MinInt( chunkMinX + SHADOW_FALLOFF_CHUNK_PIXELS, maxX );
+		for( int column = chunkMinX; column < chunkMaxX; ++ column )
+		{
+			const float x = m_viewMins.x + (((float) column + 0.5f) / m_pixelsPerViewUnit.x);
+			const float distance = MaxFloat( bounds.mins.x - x, x - bounds.maxs.x, distanceY );
+			const int alpha = ClampInt( (int)( (float) command.m_a - (distance * alphaPerUnitDistance) + 0.5f ), 0, command.m_a );
+			alphas[ column - chunkMinX ] = (unsigned char) alpha;
+			numPixelsBlended += alpha > 0 ? 1 : 0;
+		}
+
+		BlendSpanWithAlphas( row, chunkMinX, chunkMaxX, alphas, command );
+	}
+
+	return numPixelsBlended;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Blends the command's color over pixels [minX,maxX) of <row> (already clipped to the
+//	framebuffer), pixel i with alpha alphas[i], four pixels per SSE2 step.  Blending with alpha
+//	0 leaves a pixel exactly as it was.
+//
+void SoftwareRenderBackend::BlendSpanWithAlphas( int row, int minX, int maxX, const unsigned char* alphas, const RenderCommand& command )
+{
+	unsigned char* pixel = &m_pixels[ 4 * ((row * m_width) + minX) ];
+	int numPixels = maxX - minX;
+#if defined( JAZZ_USE_SSE2 )
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i half = _mm_set1_epi16( 128 );
+	const __m128i opaque = _mm_set1_epi16( 255 );
+	const __m128i color = _mm_set_epi16( 0, command.m_b, command.m_g, command.m_r, 0, command.m_b, command.m_g, command.m_r );
+	const __m128i alphaChannels = _mm_set_epi16( -1, 0, 0, 0, -1, 0, 0, 0 );
+	for( ; numPixels >= 4; numPixels -= 4, pixel += 16, alphas += 4 )
+	{
+		int packedAlphas;
+		memcpy( &packedAlphas, alphas, sizeof( packedAlphas ) );
+		const __m128i pixelAlphas = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( packedAlphas ), zero ), zero );
+		const __m128i pixelAlphasTwice = _mm_or_si128( pixelAlphas, _mm_slli_epi32( pixelAlphas, 16 ) ); // each pixel's alpha in both halves of its 32 bits
+		const __m128i lowAlpha = _mm_unpacklo_epi32( pixelAlphasTwice, pixelAlphasTwice ); // pixels 0 and 1, alpha in all four channels
+		const __m128i highAlpha = _mm_unpackhi_epi32( pixelAlphasTwice, pixelAlphasTwice );
+		const __m128i lowSource = _mm_or_si128( color, _mm_and_si128( lowAlpha, alphaChannels ) ); // GL blends alpha with the same factors
+		const __m128i highSource = _mm_or_si128( color, _mm_and_si128( highAlpha, alphaChannels ) );
+		const __m128i destination = _mm_loadu_si128( (const __m128i*) pixel );
+		__m128i low = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( destination, zero ), _mm_sub_epi16( opaque, lowAlpha ) ), _mm_add_epi16( _mm_mullo_epi16( lowSource, lowAlpha ), half ) );
+		__m128i high = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( destination, zero ), _mm_sub_epi16( opaque, highAlpha ) ), _mm_add_epi16( _mm_mullo_epi16( highSource, highAlpha ), half ) );
+		low = _mm_srli_epi16( _mm_add_epi16( low, _mm_srli_epi16( low, 8 ) ), 8 );
+		high = _mm_srli_epi16( _mm_add_epi16( high, _mm_srli_epi16( high, 8 ) ), 8 );
+		_mm_storeu_si128( (__m128i*) pixel, _mm_packus_epi16( low, high ) );
+	}
+#endif
+	for( ; numPixels > 0; -- numPixels, pixel += 4, ++ alphas )
+	{
+		const int alpha = *alphas;
+		const int inverseAlpha = 255 - alpha;
+		pixel[ 0 ] = BlendChannel( (command.m_r * alpha) + 128, pixel[ 0 ], inverseAlpha );
+		pixel[ 1 ] = BlendChannel( (command.m_g * alpha) + 128, pixel[ 1 ], inverseAlpha );
+		pixel[ 2 ] = BlendChannel( (command.m_b * alpha) + 128, pixel[ 2 ], inverseAlpha );
+		pixel[ 3 ] = BlendChannel( (alpha * alpha) + 128, pixel[ 3 ], inverseAlpha );
+	}
+}
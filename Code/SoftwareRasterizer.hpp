@@ -0,0 +1,81 @@
+//-----------------------------------------------------------------------------------------------
+// SoftwareRasterizer.hpp
+//
+// CPU render backend: rasterizes the render command buffer into an RGBA8 framebuffer with the
+//	same blending as the OpenGL path (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), so frames can be
+//	produced and checked on machines without a GPU.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_SoftwareRasterizer__
+#define __include_SoftwareRasterizer__
+#pragma once
+#include "RenderCommandBuffer.hpp"
+#include "ThreadPool.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Globals
+//
+const int SOFTWARE_RASTER_TILE_HEIGHT = 16; // rows per tile; tiles are full-width bands
+const int SHADOW_FALLOFF_TABLE_SIZE = 1024; // entries per unit of squared distance (normalized to the outer radius)
+const int SHADOW_FALLOFF_CHUNK_PIXELS = 64; // falloff alphas are worked out this many pixels at a time, then blended
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// A pixel's value is decided by whether its center lies inside the shape (no antialiasing).
+//	Each tile replays every command in order, so blending order matches submission order and the
+//	result is identical for any number of threads.  If a frame starts with a layer, the layer
+//	drawn over the clear color is cached and copied in, rather than redrawn, while it's unchanged
+//	(unless it covers so little that redrawing is cheaper).
+//
+class SoftwareRenderBackend : public RenderBackend
+{
+public:
+	SoftwareRenderBackend( int width, int height, const AABB2& viewBounds );
+	virtual void Execute( const RenderCommandBuffer& commands );
+	virtual const char* GetName() const { return "software"; }
+
+	void SetThreadPool( ThreadPool* threadPool ) { m_threadPool = threadPool; } // NULL renders on the calling thread
+	void SetClearColor( const Rgba& clearColor ) { m_clearColor = clearColor; }
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	const unsigned char* GetPixels() const { return &m_pixels[ 0 ]; } // RGBA8, top row first, no row padding
+
+	double m_numPixelsBlended; // by commands, over all frames (the clear isn't counted)
+
+private:
+	static void RasterizeTileBatch( void* userData, unsigned int beginIndex, unsigned int endIndex, unsigned int participantIndex );
+	void RasterizeTile( int tileIndex );
+	int RasterizeCommands( const RenderCommandBuffer& commands, unsigned int firstCommandIndex, int minRow, int maxRow );
+	int RasterizeCircle( const RenderCommand& command, int minRow, int maxRow, bool isOutline );
+	int RasterizeQuad( const RenderCommand& command, int minRow, int maxRow, bool isOutline );
+	int RasterizeShadowCircle( const RenderCommand& command, int minRow, int maxRow );
+	int RasterizeShadowQuad( const RenderCommand& command, int minRow, int maxRow );
+	int FillRect( int minX, int minY, int maxX, int maxY, int minRow, int maxRow, const RenderCommand& command );
+	int FillSpan( int row, int minX, int maxX, const RenderCommand& command );
+	int BlendShadowCircleFalloffSpan( int row, int minX, int maxX, float centerX, float inverseOuterRadiusX, float normalizedOffsetYSquared, float alphaPerUnitDistance, const RenderCommand& command );
+	int BlendShadowQuadFalloffSpan( int row, int minX, int maxX, const AABB2& bounds, float distanceY, const RenderCommand& command );
+	void BlendSpanWithAlphas( int row, int minX, int maxX, const unsigned char* alphas, const RenderCommand& command );
+
+private:
+	int m_width;
+	int m_height;
+	Vector2 m_viewMins;
+	Vector2 m_pixelsPerViewUnit;
+	Rgba m_clearColor;
+	ThreadPool* m_threadPool;
+	std::vector< unsigned char > m_pixels;
+	std::vector< float > m_shadowFalloffByDistanceSquared; // 1 - distance, indexed by squared distance * SHADOW_FALLOFF_TABLE_SIZE
+	std::vector< int > m_numPixelsBlendedPerTile; // this frame
+	const RenderCommandBuffer* m_commands; // only set during Execute
+	const RenderLayer* m_backgroundLayer; // this frame's first command, if it's a layer being cached; only set during Execute
+	std::vector< int > m_numBackgroundPixelsBlendedPerTile; // by the background layer, when it was last drawn
+	bool m_isCachedBackgroundValid; // for this frame's background layer
+	bool m_isBackgroundWorthCaching; // whether the cached layer blends more pixels than copying the cache in costs
+	std::vector< unsigned char > m_cachedBackground; // the clear color with the background layer drawn over it
+	unsigned int m_cachedBackgroundLayerId; // 0 if nothing is cached
+	unsigned int m_cachedBackgroundLayerVersion;
+	Rgba m_cachedBackgroundClearColor;
+};
+
+
+#endif // __include_SoftwareRasterizer__
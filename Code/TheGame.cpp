@@ -2,8 +2,11 @@
 // TheGame.cpp
 //-----------------------------------------------------------------------------------------------
 #include "TheGame.hpp"
+#if defined( JAZZ_PLATFORM_WIN32 )
 #include "Main_Win32.hpp"
+#endif
 #include "Graphics.hpp"
+#include "ProfilingSection.hpp"
 #include "Scenario_Generic.hpp"
 #include "Scenario_SelfDoubt.hpp"
 #include "Scenario_SelfSacrifice.hpp"
@@ -18,12 +21,61 @@
 TheGame* theGame = NULL;
 const Rgba DEFAULT_NPC_COLOR = Rgba::GREEN;
 const float DEFAULT_NPC_RADIUS = 10.f;
+const char* SIMULATION_UPDATE_MODE_NAMES[ NUM_SIMULATION_UPDATE_MODES ] = { "in-place", "double-buffered", "parallel" };
+const char* OLD_PARALLEL_SIMULATION_UPDATE_MODE_NAME = "double-buffered parallel"; // what "parallel" was called before the headless runner
+const double DEFAULT_SIMULATION_TICKS_PER_SECOND = 60.0;
+const int DEFAULT_MAX_SIMULATION_STEPS_PER_FRAME = 5;
+const double DEFAULT_TARGET_FRAMES_PER_SECOND = 60.0;
+const double FRAME_STATISTICS_REPORT_INTERVAL_SECONDS = 5.0;
+const double PROFILING_TRACE_WINDOW_SECONDS = 2.0;
+const double OVER_BUDGET_FRAME_TARGET_MULTIPLE = 1.5; // while profiling, a frame this much longer than the target exports a trace
+const double OVER_BUDGET_TRACE_COOLDOWN_SECONDS = 10.0; // so a run of slow frames exports one trace, not dozens
+const char* FRAME_STATISTICS_FILE_PATH = "FrameStatistics.json";
+const AABB2 FRAME_STATISTICS_OVERLAY_BOUNDS( 8.f, 464.f, 264.f, 568.f ); // bottom-left corner of the view
+
+
+//-----------------------------------------------------------------------------------------------
+// Case-insensitive; also accepts the parallel mode's old name, so existing command lines still work.
+//
+bool FindSimulationUpdateModeByName( const std::string& modeName, OUTPUT SimulationUpdateMode& updateMode )
+{
+	for( int modeIndex = 0; modeIndex < NUM_SIMULATION_UPDATE_MODES; ++ modeIndex )
+	{
+		if( !Stricmp( modeName, SIMULATION_UPDATE_MODE_NAMES[ modeIndex ] ) )
+		{
+			updateMode = (SimulationUpdateMode) modeIndex;
+			return true;
+		}
+	}
+
+	if( !Stricmp( modeName, OLD_PARALLEL_SIMULATION_UPDATE_MODE_NAME ) )
+	{
+		updateMode = SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL;
+		return true;
+	}
+
+	return false;
+}
 
 
 //-----------------------------------------------------------------------------------------------
 TheGame::TheGame()
 	: m_isRunning( true )
 	, m_currentScenario( NULL )
+	, m_simulationUpdateMode( SIMULATION_UPDATE_IN_PLACE )
+	, m_simulationTickSeconds( 1.0 / DEFAULT_SIMULATION_TICKS_PER_SECOND )
+	, m_unsimulatedSeconds( 0.0 )
+	, m_maxSimulationStepsPerFrame( DEFAULT_MAX_SIMULATION_STEPS_PER_FRAME )
+	, m_simulationThread( NULL )
+	, m_isSimulationThreadStopping( 0 )
+	, m_isSnapshotStale( false )
+	, m_numProfilingTracesExported( 0 )
+	, m_timeLastProfilingTraceExported( -OVER_BUDGET_TRACE_COOLDOWN_SECONDS )
+	, m_isFrameStatisticsOverlayVisible( false )
+	, m_hasFrameToRecord( false )
+	, m_simulationSecondsThisFrame( 0.0 )
+	, m_renderSecondsThisFrame( 0.0 )
+	, m_simulationMicrosecondsSinceFrame( 0 )
 {
 }
 
@@ -47,7 +99,12 @@ void TheGame::Startup( const std::string& appCommandLine )
 		m_keyDownStates[ i ] = false;
 	}
 
+	SetNumSimulationThreads( SysGetNumberOfHardwareThreads() );
+	m_framePacer.SetTargetFrameRate( DEFAULT_TARGET_FRAMES_PER_SECOND );
+	Profiler::SetTraceWindowSeconds( PROFILING_TRACE_WINDOW_SECONDS );
+
 	CreateScenarios();
+	SetSimulationUpdateMode( m_simulationUpdateMode );
 	StartScenarioByName( "Claustrophobia" );
 }
 
@@ -66,6 +123,21 @@ void TheGame::CreateScenarios()
 void TheGame::Shutdown()
 {
 	DebuggerPrintf( "TheGame::Shutdown...\n" );
+	if( m_framePacer.GetFrameSeconds().GetNumSamples() > 0 )
+	{
+		ReportFrameStatistics();
+	}
+
+	SetSimulationThreaded( false );
+	m_simulationThreadPool.Shutdown();
+	Profiler::FinishTraceExport();
+
+	// Every run leaves its numbers behind, to compare against the next
+	if( m_frameStatistics.GetNumFramesRecorded() > 0 )
+	{
+		const bool wasWritten = m_frameStatistics.WriteJsonFile( FRAME_STATISTICS_FILE_PATH );
+		DebuggerPrintf( "Frame statistics (%u frames) %s %s\n", m_frameStatistics.GetNumFramesRecorded(), wasWritten ? "written to" : "couldn't be written to", FRAME_STATISTICS_FILE_PATH );
+	}
 }
 
 
@@ -74,6 +146,7 @@ void TheGame::Shutdown()
 //
 void TheGame::RunFrame()
 {
+	m_framePacer.BeginFrame();
 	SetUpView();
 	DrawDebugGraphics();
 
@@ -81,22 +154,95 @@ void TheGame::RunFrame()
 	double timeNow = Clock::GetAbsoluteTimeSeconds();
 	double deltaSeconds = timeNow - timeLastFrameBegan;
 	timeLastFrameBegan = timeNow;
+	if( m_hasFrameToRecord )
+	{
+		m_frameStatistics.RecordFrame( deltaSeconds, m_simulationSecondsThisFrame, m_renderSecondsThisFrame );
+	}
 
 	Update( deltaSeconds );
+	if( m_isFrameStatisticsOverlayVisible )
+	{
+		m_frameStatistics.DrawOverlay( FRAME_STATISTICS_OVERLAY_BOUNDS, m_framePacer.GetTargetFrameSeconds() );
+	}
 
-	Sleep( 1 );
+	const double timeAtFlushStart = Clock::GetAbsoluteTimeSeconds();
+	FlushGraphicsBatch();
+	m_renderSecondsThisFrame += Clock::GetAbsoluteTimeSeconds() - timeAtFlushStart;
+	m_hasFrameToRecord = true;
+
+	m_framePacer.WaitForPresent();
+#if defined( JAZZ_PLATFORM_WIN32 )
 	SwapBuffers( g_displayDeviceContext );
+#endif
+	m_framePacer.EndPresent();
+	if( Profiler::IsEnabled() )
+	{
+		Profiler::EndFrame();
+		const double frameBudgetSeconds = OVER_BUDGET_FRAME_TARGET_MULTIPLE * m_framePacer.GetTargetFrameSeconds();
+		if( frameBudgetSeconds > 0.0 && m_framePacer.GetLastFrameSeconds() > frameBudgetSeconds
+			&& Clock::GetAbsoluteTimeSeconds() - m_timeLastProfilingTraceExported >= OVER_BUDGET_TRACE_COOLDOWN_SECONDS )
+		{
+			ExportProfilingTrace( Stringf( "%.2fms frame", 1000.0 * m_framePacer.GetLastFrameSeconds() ).c_str() );
+		}
+	}
+
+	if( m_framePacer.GetSecondsSinceStatisticsReset() >= FRAME_STATISTICS_REPORT_INTERVAL_SECONDS )
+	{
+		ReportFrameStatistics();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Prints frame time, jitter and present latency since the last report (and, while profiling,
+//	the per-frame average of each profiled section), then starts over.
+//
+void TheGame::ReportFrameStatistics()
+{
+	DebuggerPrintf( "Frame pacing: %s\n", m_framePacer.GetStatisticsAsString().c_str() );
+	DebuggerPrintf( "Frame times over the last %s\n", m_frameStatistics.GetRecentSummaryAsString().c_str() );
+	m_framePacer.ResetStatistics();
+	if( Profiler::IsEnabled() && Profiler::GetNumFramesAveraged() > 0 )
+	{
+		std::vector< ProfilingReportRow > rows;
+		Profiler::GetAverageReport( rows );
+		DebuggerPrintf( "Profile (per frame, over %u frames):\n%s", Profiler::GetNumFramesAveraged(), Profiler::FormatReport( rows ).c_str() );
+		Profiler::ResetAverages();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Hands the last few seconds of profiled sections to the trace writer, as ProfileTrace_<n>.json.
+//
+void TheGame::ExportProfilingTrace( const char* reason )
+{
+	const std::string filePath = Stringf( "ProfileTrace_%03u.json", m_numProfilingTracesExported + 1 );
+	if( !Profiler::ExportTrace( filePath ) )
+	{
+		DebuggerPrintf( "Profile trace (%s) skipped: the last one is still being written\n", reason );
+		return;
+	}
+
+	++ m_numProfilingTracesExported;
+	m_timeLastProfilingTraceExported = Clock::GetAbsoluteTimeSeconds();
+	DebuggerPrintf( "Profile trace (%s) exporting to %s\n", reason, filePath.c_str() );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 void TheGame::SetUpView()
 {
+	const AABB2 viewBounds( 0.f, 0.f, 1024.f, 576.f );
+	SetViewBounds( viewBounds );
+
+#if defined( JAZZ_USE_OPENGL )
 	glLoadIdentity();
-	glOrtho( 0.f, 1024.f, 576.f, 0.f, -1.f, 1.f );
+	glOrtho( viewBounds.mins.x, viewBounds.maxs.x, viewBounds.maxs.y, viewBounds.mins.y, -1.f, 1.f );
 	//	glClearColor( 1.f, 1.f, 1.f, 1.f );
 	glClearColor( 0.1f, 0.3f, 1.f, 1.f );
 	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+#endif
 }
 
 
@@ -126,16 +272,148 @@ void TheGame::DrawDebugGraphics()
 
 
 //-----------------------------------------------------------------------------------------------
+// Advances the scenario in fixed ticks covering the real time elapsed, then draws actors part-way
+//	between their last two ticks.  A long frame simulates at most m_maxSimulationStepsPerFrame
+//	ticks; the rest of that time is dropped (the game slows down instead of spiraling).  With a
+//	simulation thread running, the stepping happens there and this only draws its latest snapshot.
+//
 void TheGame::Update( double deltaSeconds )
 {
+	const double timeAtStart = Clock::GetAbsoluteTimeSeconds();
+	if( m_simulationThread )
+	{
+		RenderLatestSnapshot();
+		m_simulationSecondsThisFrame = 0.000001 * (double) AtomicExchange( m_simulationMicrosecondsSinceFrame, 0 );
+		m_renderSecondsThisFrame = Clock::GetAbsoluteTimeSeconds() - timeAtStart;
+		return;
+	}
+
+	StepSimulation( deltaSeconds );
+	const double timeAtRenderStart = Clock::GetAbsoluteTimeSeconds();
 	if( m_currentScenario )
 	{
-		m_currentScenario->Update( deltaSeconds );
-		m_currentScenario->Render();
+		const float interpolationFraction = (float)( m_unsimulatedSeconds / m_simulationTickSeconds );
+		m_currentScenario->Render( interpolationFraction );
+	}
+
+	m_simulationSecondsThisFrame = timeAtRenderStart - timeAtStart;
+	m_renderSecondsThisFrame = Clock::GetAbsoluteTimeSeconds() - timeAtRenderStart;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Runs as many fixed ticks as <deltaSeconds> (plus what was left over last time) pays for.
+//
+int TheGame::StepSimulation( double deltaSeconds )
+{
+	m_unsimulatedSeconds += deltaSeconds;
+
+	int numStepsThisFrame = 0;
+	while( m_unsimulatedSeconds >= m_simulationTickSeconds )
+	{
+		if( numStepsThisFrame == m_maxSimulationStepsPerFrame )
+		{
+			m_unsimulatedSeconds = fmod( m_unsimulatedSeconds, m_simulationTickSeconds );
+			break;
+		}
+
+		if( m_currentScenario )
+		{
+			m_currentScenario->Update( m_simulationTickSeconds );
+		}
+
+		m_unsimulatedSeconds -= m_simulationTickSeconds;
+		++ numStepsThisFrame;
+	}
+
+	return numStepsThisFrame;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Interpolates from the snapshot's tick by however much real time has passed since it, which
+//	matches what the single-threaded path draws for the same moment.
+//
+void TheGame::RenderLatestSnapshot()
+{
+	const SimulationSnapshot* snapshot = m_snapshots.AcquireLatestSnapshot();
+	if( !snapshot )
+		return;
+
+	const double secondsSinceTick = Clock::GetAbsoluteTimeSeconds() - snapshot->m_tickRealTimeSeconds;
+	const float interpolationFraction = ClampFloat( (float)( secondsSinceTick / m_simulationTickSeconds ), 0.f, 1.f );
+	m_snapshotRenderer.Render( *snapshot, interpolationFraction );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Moves the simulation onto (or back off) its own thread.  Call from the main thread only.
+//
+void TheGame::SetSimulationThreaded( bool isThreaded )
+{
+	if( isThreaded == (m_simulationThread != NULL) )
+		return;
+
+	if( isThreaded )
+	{
+		m_isSimulationThreadStopping = 0;
+		m_isSnapshotStale = true;
+		m_simulationThread = SysCreateThread( SimulationThreadEntry, this );
+	}
+	else
+	{
+		AtomicExchange( m_isSimulationThreadStopping, 1 );
+		SysJoinThread( m_simulationThread );
+		m_simulationThread = NULL;
+	}
+
+	DebuggerPrintf( "Simulation thread: %s\n", isThreaded ? "on" : "off" );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void TheGame::SimulationThreadEntry( void* game )
+{
+	( (TheGame*) game )->RunSimulationLoop();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Steps in real time, publishing a snapshot after each batch of ticks, then sleeps until the
+//	next tick is due.  The render thread never waits on this loop to get a frame, or vice versa.
+//
+void TheGame::RunSimulationLoop()
+{
+	double timeLastStepped = Clock::GetAbsoluteTimeSeconds();
+	while( !m_isSimulationThreadStopping )
+	{
+		double secondsUntilNextTick = 0.0;
+		{
+			ScopedCriticalSection lock( m_simulationLock );
+			const double timeNow = Clock::GetAbsoluteTimeSeconds();
+			const int numSteps = StepSimulation( timeNow - timeLastStepped );
+			timeLastStepped = timeNow;
+			AtomicAdd( m_simulationMicrosecondsSinceFrame, (long)( 1000000.0 * (Clock::GetAbsoluteTimeSeconds() - timeNow) ) );
+			if( (numSteps > 0 || m_isSnapshotStale) && m_currentScenario )
+			{
+				SimulationSnapshot& snapshot = m_snapshots.GetWriteSnapshot();
+				m_currentScenario->CaptureSnapshot( snapshot );
+				snapshot.m_tickRealTimeSeconds = timeNow - m_unsimulatedSeconds;
+				m_snapshots.PublishWriteSnapshot();
+				m_isSnapshotStale = false;
+			}
+
+			secondsUntilNextTick = m_simulationTickSeconds - m_unsimulatedSeconds;
+		}
+
+		SysSleepSeconds( secondsUntilNextTick );
 	}
+
+	Profiler::ReleaseThread();
 }
 
 
+#if defined( JAZZ_PLATFORM_WIN32 )
 //-----------------------------------------------------------------------------------------------
 bool TheGame::HandleWin32Message( UINT wmMessageCode, WPARAM wParam, LPARAM lParam )
 {
@@ -160,12 +438,16 @@ bool TheGame::HandleWin32Message( UINT wmMessageCode, WPARAM wParam, LPARAM lPar
 			return false;
 	};
 }
+#endif // JAZZ_PLATFORM_WIN32
 
 
 //-----------------------------------------------------------------------------------------------
 bool TheGame::ProcessKeyDownEvent( unsigned char keyCode )
 {
-	m_keyDownStates[ keyCode ] = true;
+	{
+		ScopedCriticalSection lock( m_simulationLock ); // the simulation thread reads key states while it steps
+		SetSimulationKeyDown( keyCode, true );
+	}
 
 	if( keyCode == VK_ESCAPE )
 	{
@@ -173,6 +455,50 @@ bool TheGame::ProcessKeyDownEvent( unsigned char keyCode )
 		return true;
 	}
 
+	if( keyCode == VK_F2 )
+	{
+		SetSimulationUpdateMode( (SimulationUpdateMode)( (m_simulationUpdateMode + 1) % NUM_SIMULATION_UPDATE_MODES ) );
+		return true;
+	}
+
+	if( keyCode == VK_F3 )
+	{
+		SetSimulationThreaded( !IsSimulationThreaded() );
+		return true;
+	}
+
+	if( keyCode == VK_F4 )
+	{
+		ReportFrameStatistics();
+		m_framePacer.SetUncapped( !m_framePacer.IsUncapped() );
+		DebuggerPrintf( "Frame rate: %s\n", m_framePacer.IsUncapped() ? "uncapped" : "capped" );
+		return true;
+	}
+
+	if( keyCode == VK_F5 )
+	{
+		Profiler::SetEnabled( !Profiler::IsEnabled() );
+		Profiler::ResetAverages();
+		DebuggerPrintf( "Profiling: %s\n", Profiler::IsEnabled() ? "on" : "off" );
+		return true;
+	}
+
+	if( keyCode == VK_F6 )
+	{
+		if( Profiler::IsEnabled() )
+			ExportProfilingTrace( "requested" );
+		else
+			DebuggerPrintf( "Profile trace needs profiling on (F5)\n" );
+
+		return true;
+	}
+
+	if( keyCode == VK_F7 )
+	{
+		m_isFrameStatisticsOverlayVisible = !m_isFrameStatisticsOverlayVisible;
+		return true;
+	}
+
 	DebuggerPrintf( "KeyDown for #%d\n", keyCode );
 
 	return false;
@@ -182,11 +508,23 @@ bool TheGame::ProcessKeyDownEvent( unsigned char keyCode )
 //-----------------------------------------------------------------------------------------------
 bool TheGame::ProcessKeyUpEvent( unsigned char keyCode )
 {
-	m_keyDownStates[ keyCode ] = false;
+	ScopedCriticalSection lock( m_simulationLock );
+	SetSimulationKeyDown( keyCode, false );
 	return false;
 }
 
 
+//-----------------------------------------------------------------------------------------------
+// Presses or releases a key as the simulation sees it, without the key's other actions (or the
+//	logging).  Call on the thread stepping the simulation, e.g. from a scenario update function;
+//	any other thread must hold m_simulationLock, as the input events do.
+//
+void TheGame::SetSimulationKeyDown( unsigned char keyCode, bool isDown )
+{
+	m_keyDownStates[ keyCode ] = isDown;
+}
+
+
 //-----------------------------------------------------------------------------------------------
 bool TheGame::IsKeyDown( unsigned char keyCode )
 {
@@ -225,12 +563,16 @@ void TheGame::StartScenarioByName( const std::string& scenarioName )
 //-----------------------------------------------------------------------------------------------
 void TheGame::StartScenario( Scenario* scenarioToStart )
 {
+	PROFILE_SECTION( "TheGame::StartScenario" );
+	ScopedCriticalSection lock( m_simulationLock );
+	m_isSnapshotStale = true;
 	if( m_currentScenario )
 	{
 		m_currentScenario->WipeClean();
 	}
 
 	m_currentScenario = scenarioToStart;
+	m_unsimulatedSeconds = 0.0;
 
 	if( m_currentScenario )
 	{
@@ -239,6 +581,56 @@ void TheGame::StartScenario( Scenario* scenarioToStart )
 }
 
 
+//-----------------------------------------------------------------------------------------------
+// Applies to every scenario; double-buffered modes make NPC updates independent of actor order.
+//
+void TheGame::SetSimulationUpdateMode( SimulationUpdateMode newMode )
+{
+	ScopedCriticalSection lock( m_simulationLock );
+	m_simulationUpdateMode = newMode;
+	const bool isDoubleBuffered = (newMode != SIMULATION_UPDATE_IN_PLACE);
+	ThreadPool* threadPool = (newMode == SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL) ? &m_simulationThreadPool : NULL;
+	for( unsigned int scenarioIndex = 0; scenarioIndex < m_scenarios.size(); ++ scenarioIndex )
+	{
+		Scenario& scenario = *m_scenarios[ scenarioIndex ];
+		scenario.m_isDoubleBuffered = isDoubleBuffered;
+		scenario.m_threadPool = threadPool;
+	}
+
+	DebuggerPrintf( "Simulation update mode: %s (%u threads)\n", SIMULATION_UPDATE_MODE_NAMES[ newMode ], threadPool ? threadPool->GetNumParticipants() : 1 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Total threads used by the parallel update mode, counting the calling (main) thread.
+//
+void TheGame::SetNumSimulationThreads( unsigned int numThreads )
+{
+	m_simulationThreadPool.Startup( numThreads > 1 ? numThreads - 1 : 0 );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void TheGame::SetSimulationTickRate( double ticksPerSecond )
+{
+	if( ticksPerSecond <= 0.0 )
+		return;
+
+	ScopedCriticalSection lock( m_simulationLock );
+	m_simulationTickSeconds = 1.0 / ticksPerSecond;
+	m_unsimulatedSeconds = 0.0;
+	DebuggerPrintf( "Simulation tick rate: %.1f Hz\n", ticksPerSecond );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void TheGame::SetMaxSimulationStepsPerFrame( int maxStepsPerFrame )
+{
+	ScopedCriticalSection lock( m_simulationLock );
+	m_maxSimulationStepsPerFrame = maxStepsPerFrame > 1 ? maxStepsPerFrame : 1;
+}
+
+
 //-----------------------------------------------------------------------------------------------
 void TheGame::LoadScenarioDataFiles()
 {
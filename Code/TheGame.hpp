@@ -8,15 +8,25 @@
 #include "Vector2.hpp"
 #include "Rgba.hpp"
 #include "Clock.hpp"
+#include "ActorSpatialHash.hpp"
+#include "AreaGridIndex.hpp"
+#include "ThreadPool.hpp"
+#include "MemoryArena.hpp"
+#include "SimulationSnapshot.hpp"
+#include "FramePacer.hpp"
+#include "FrameStatistics.hpp"
 
 class Actor;
+class ActorStore;
 class RelationshipToOtherActor;
 class Scenario;
+class SimulationStateHashLog;
 
 //-----------------------------------------------------------------------------------------------
 // Global variables
 extern const Rgba DEFAULT_NPC_COLOR;
 extern const float DEFAULT_NPC_RADIUS;
+extern const char* SIMULATION_UPDATE_MODE_NAMES[];
 
 
 //-----------------------------------------------------------------------------------------------
@@ -83,6 +93,7 @@ class Area
 public:
 	Area();
 	void Draw( bool isShadowPass );
+	AreaDrawState CaptureDrawState() const;
 
 	AABB2 m_bounds;
 	Rgba m_color;
@@ -115,6 +126,7 @@ class RelationshipToOtherActor
 public:
 	RelationshipToOtherActor();
 //	RelationshipToOtherActor( const RelationshipToOtherActor& copyFrom );
+	bool HasEffectBeyondOuterDistance() const;
 
 	Actor* m_otherActor;
 	float m_innerDistance;
@@ -135,24 +147,114 @@ public:
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
+// Actor tags; any combination may be set on an actor, and relationship rules select actors by tag.
+//	Scenarios are free to define their own tags starting at ACTOR_TAG_FIRST_SCENARIO_TAG.
+//
+enum ActorTag
+{
+	ACTOR_TAG_PLAYER				= BIT( 0 ),
+	ACTOR_TAG_NPC					= BIT( 1 ),
+	ACTOR_TAG_FIRST_SCENARIO_TAG	= BIT( 2 ),
+	ACTOR_TAGS_ALL					= 0xffffffff
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// A relationship shared by every (subject, object) pair of actors whose tags match, in place of a
+//	RelationshipToOtherActor copy on every subject for every object.  The relationship's
+//	m_otherActor is ignored.  Rules are run after an actor's own per-pair relationships.
+//
+class RelationshipRule
+{
+public:
+	RelationshipRule();
+	bool AppliesToSubject( unsigned int subjectTags ) const { return (subjectTags & m_subjectTags) != 0; }
+	bool AppliesToObject( unsigned int objectTags ) const { return (objectTags & m_objectTags) != 0; }
+
+	unsigned int m_subjectTags; // actors with any of these tags feel the relationship...
+	unsigned int m_objectTags; // ...toward every other actor with any of these tags
+	RelationshipToOtherActor m_relationship;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Reusable working memory for actor updates, so the per-actor hot loop never allocates
+class ActorUpdateScratch
+{
+public:
+	ActorUpdateScratch() : m_numRelationshipsRun( 0.0 ) {}
+
+	std::vector< Actor* > m_nearbyActors;
+	std::vector< unsigned int > m_relationshipIndices;
+	std::vector< unsigned int > m_areaIndices;
+	double m_numRelationshipsRun; // by actors updated with this scratch, since the scenario started
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Structure-of-arrays storage for the per-actor fields touched every frame by update, physics and
+//	render.  Index i of every array belongs to m_actors[ i ]; everything else lives on the Actor.
+//
+// For double-buffered updates, FreezeObservableState() copies the fields one actor may read from
+//	another; until UnfreezeObservableState(), the Actor::GetObserved* accessors read those copies,
+//	so every actor sees the same start-of-step world regardless of update order or thread.
+//
+class ActorStore
+{
+public:
+	std::vector< Actor* > m_actors;
+	std::vector< Vector2 > m_positions;
+	std::vector< Vector2 > m_previousPositions;
+	std::vector< float > m_baseRadii;
+	std::vector< float > m_radiusScales;
+	std::vector< float > m_alphaScales;
+	std::vector< ActorState > m_states;
+	std::vector< unsigned char > m_isPlayerFlags; // not vector< bool >, which is bit-packed
+	std::vector< unsigned int > m_tags; // ActorTag bits
+
+	std::vector< Vector2 > m_frozenPositions;
+	std::vector< Vector2 > m_frozenPreviousPositions;
+	std::vector< float > m_frozenRadiusScales;
+	bool m_isObservableStateFrozen;
+	const Clock& m_simulationClock; // the owning Scenario's; actor state timers use its (simulated) time
+
+	explicit ActorStore( const Clock& simulationClock );
+	~ActorStore();
+	Actor* CreateActor( MemoryArena& arena );
+	void Clear();
+	void FreezeObservableState();
+	void UnfreezeObservableState();
+	unsigned int GetNumActors() const { return (unsigned int) m_actors.size(); }
+	Actor* GetActor( unsigned int actorIndex ) const { return m_actors[ actorIndex ]; }
+	double GetSimulationTimeSeconds() const { return m_simulationClock.GetCurrentTimeSeconds(); }
+
+private:
+	void operator = ( const ActorStore& ); // not assignable
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// Per-actor arrays live in the owning Scenario's arena, like the actors themselves
+typedef std::vector< RelationshipToOtherActor, ArenaAllocator< RelationshipToOtherActor > > RelationshipArray;
+typedef std::vector< unsigned int, ArenaAllocator< unsigned int > > RelationshipIndexArray;
+typedef std::vector< std::pair< Actor*, unsigned int >, ArenaAllocator< std::pair< Actor*, unsigned int > > > RelationshipIndexByActorArray;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// A lightweight handle onto one slot of an ActorStore, plus the actor's colder data.  Actors are
+//	created through Scenario::CreateActor (which forwards to ActorStore::CreateActor), in the
+//	scenario's arena, and are never individually destroyed.
+//
 class Actor
 {
 public:
-	Vector2 m_position;
-	Vector2 m_previousPosition;
-	float m_movementSpeed;
-	float m_movementHeadingDegrees;
+	Vector2 m_velocity; // units per second; speed and heading are derived on demand (see CalcMovementSpeed)
 	float m_viewHeadingDegrees;
-	std::vector< RelationshipToOtherActor > m_relationships;
-	bool m_isPlayer;
+	RelationshipArray m_relationships;
 	Rgba m_baseColor;
 	float m_baseAlpha;
-	float m_alphaScaleFromRelationships;
-	float m_baseRadius;
-	float m_radiusScaleFromRelationships;
 	float m_meanderFactor;
 	float m_confusionFactor;
-	ActorState m_state;
 	double m_timeEnteredState;
 
 	ActorResponse m_responseIfTouchedByNPC;
@@ -160,25 +262,185 @@ public:
 	ActorResponse m_responseIfWithinRadiusOfNPC;
 	ActorResponse m_responseIfWithinRadiusOfPlayer;
 
-	Actor();
-	void Draw( bool isShadowPass ) const;
+	// Relationship lookup (rebuilt whenever m_relationships changes size); see RebuildRelationshipIndex()
+	RelationshipIndexArray m_unboundedRelationshipIndices;
+	RelationshipIndexByActorArray m_boundedRelationshipIndicesByActor;
+	float m_largestBoundedRelationshipDistance;
+	unsigned int m_numRelationshipsIndexed;
+
+	Actor( ActorStore& store, unsigned int storeIndex, MemoryArena& arena );
+	unsigned int GetStoreIndex() const { return m_storeIndex; }
+	float CalcMovementSpeed() const { return m_velocity.CalcLength(); }
+	double CalcMovementHeadingDegrees() const { return m_velocity.CalcYawDegrees(); }
+	const Vector2& GetPosition() const;
+	void SetPosition( const Vector2& newPosition );
+	const Vector2& GetPreviousPosition() const;
+	Vector2 CalcInterpolatedPosition( float interpolationFraction ) const;
+	bool IsPlayer() const;
+	void SetIsPlayer( bool isPlayer );
+	unsigned int GetTags() const;
+	void AddTags( unsigned int tagsToAdd );
+	void RemoveTags( unsigned int tagsToRemove );
+	ActorState GetState() const;
+	float GetBaseRadius() const;
+	void SetBaseRadius( float newBaseRadius );
+	float GetRadiusScaleFromRelationships() const;
+	float GetAlphaScaleFromRelationships() const;
+	const Vector2& GetObservedPosition() const;
+	const Vector2& GetObservedPreviousPosition() const;
+	float CalcObservedRadius() const;
+	void Draw( bool isShadowPass, float interpolationFraction ) const;
+	ActorDrawState CaptureDrawState() const;
 	float CalcRadius() const;
 	float CalcAlpha() const;
 	Rgba CalcColor() const;
 	double GetSecondsInCurrentState() const;
 	float GetFractionOfSecondsInCurrentState( double benchmarkSeconds ) const;
 	ActorState ChangeState( ActorState newState );
-	void Update( double deltaSeconds, Scenario& scenario );
-	void UpdateAsPlayer( double deltaSeconds, Scenario& scenario );
+	void Update( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch );
+	void UpdateAsPlayer( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch );
 	void ContinueFalling( double deltaSeconds, Scenario& scenario );
 	bool DoesStateRunPhysics( ActorState state );
-	void RunPhysics( double deltaSeconds, Scenario& scenario );
-	void RunEmotions( double deltaSeconds );
-	void RunRelationship( RelationshipToOtherActor& relationship, Actor& otherActor, double deltaSeconds );
+	void RunPhysics( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch );
+	void RebuildRelationshipIndex();
+	void RebuildRelationshipIndexIfNeeded();
+	void RunEmotions( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch );
+	void RunRelationshipRules( double deltaSeconds, Scenario& scenario, ActorUpdateScratch& scratch );
+	void RunRelationship( const RelationshipToOtherActor& relationship, Actor& otherActor, double deltaSeconds );
 	void StartFalling();
+
+private:
+	ActorStore& m_store;
+	unsigned int m_storeIndex;
 };
 
 
+//-----------------------------------------------------------------------------------------------
+inline const Vector2& Actor::GetPosition() const
+{
+	return m_store.m_positions[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void Actor::SetPosition( const Vector2& newPosition )
+{
+	m_store.m_positions[ m_storeIndex ] = newPosition;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline const Vector2& Actor::GetPreviousPosition() const
+{
+	return m_store.m_previousPositions[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Where to draw the actor between its last two simulated positions (0 = previous tick, 1 = current).
+//
+inline Vector2 Actor::CalcInterpolatedPosition( float interpolationFraction ) const
+{
+	return Interpolate( GetPreviousPosition(), GetPosition(), interpolationFraction );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline bool Actor::IsPlayer() const
+{
+	return m_store.m_isPlayerFlags[ m_storeIndex ] != 0;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void Actor::SetIsPlayer( bool isPlayer )
+{
+	m_store.m_isPlayerFlags[ m_storeIndex ] = isPlayer ? 1 : 0;
+	RemoveTags( ACTOR_TAG_PLAYER | ACTOR_TAG_NPC );
+	AddTags( isPlayer ? ACTOR_TAG_PLAYER : ACTOR_TAG_NPC );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline unsigned int Actor::GetTags() const
+{
+	return m_store.m_tags[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void Actor::AddTags( unsigned int tagsToAdd )
+{
+	m_store.m_tags[ m_storeIndex ] |= tagsToAdd;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void Actor::RemoveTags( unsigned int tagsToRemove )
+{
+	m_store.m_tags[ m_storeIndex ] &= ~tagsToRemove;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline ActorState Actor::GetState() const
+{
+	return m_store.m_states[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline float Actor::GetBaseRadius() const
+{
+	return m_store.m_baseRadii[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline void Actor::SetBaseRadius( float newBaseRadius )
+{
+	m_store.m_baseRadii[ m_storeIndex ] = newBaseRadius;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline float Actor::GetRadiusScaleFromRelationships() const
+{
+	return m_store.m_radiusScales[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline float Actor::GetAlphaScaleFromRelationships() const
+{
+	return m_store.m_alphaScales[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Position as seen by other actors (the frozen copy, during a double-buffered update)
+//
+inline const Vector2& Actor::GetObservedPosition() const
+{
+	return m_store.m_isObservableStateFrozen ? m_store.m_frozenPositions[ m_storeIndex ] : m_store.m_positions[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline const Vector2& Actor::GetObservedPreviousPosition() const
+{
+	return m_store.m_isObservableStateFrozen ? m_store.m_frozenPreviousPositions[ m_storeIndex ] : m_store.m_previousPositions[ m_storeIndex ];
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline float Actor::CalcObservedRadius() const
+{
+	const float radiusScale = m_store.m_isObservableStateFrozen ? m_store.m_frozenRadiusScales[ m_storeIndex ] : m_store.m_radiusScales[ m_storeIndex ];
+	return m_store.m_baseRadii[ m_storeIndex ] * radiusScale;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 enum ScenarioState
 {
@@ -195,21 +457,43 @@ class Scenario
 {
 public:
 	std::string m_name;	
+	Clock m_simulationClock; // advanced by each Update's deltaSeconds; all state timers read it
 	std::vector< Area* > m_areas;
-	std::vector< Actor* > m_actors;
+	ActorStore m_actors;
+	std::vector< RelationshipRule > m_relationshipRules;
 	ScenarioState m_state;
 	double m_timeEnteredState;
 	ScenarioStartFunctionPointer m_startFunction;
 	ScenarioUpdateFunctionPointer m_updateFunction;
+	ActorSpatialHash m_actorSpatialHash;
+	AreaGridIndex m_areaIndex;
+	std::vector< ActorUpdateScratch > m_updateScratchPerThread; // one per ThreadPool participant
+	bool m_isDoubleBuffered; // NPCs see each other's start-of-step state, so update order doesn't matter
+	ThreadPool* m_threadPool; // if non-NULL (and double-buffered), NPC updates are spread across its threads
+	MemoryArena m_arena; // Actors, Areas and their arrays; reset (not freed) by WipeClean
+	unsigned int m_numUpdates; // since Start
+	float m_spatialQueryMarginDistance; // slack added to neighborhood queries for NPCs that move after the hash was built
+	unsigned int m_numUpdatesOverSpatialQueryMargin; // since Start; steps whose NPCs moved further than the margin covered
+	SimulationStateHashLog* m_stateHashLog; // if non-NULL, each Update records a hash of the state it leaves behind
+	SimulationSnapshot m_renderSnapshot; // Render's copy of this tick's draw state
+	SimulationSnapshotRenderer m_snapshotRenderer;
 
 	Scenario();
 	void Start();
 	void Update( double deltaSeconds );
+	void UpdateActorSpatialHash();
+	void UpdateAllNPCs( double deltaSeconds );
+	void UpdateSpatialQueryMargin();
+	void OnAreasChanged();
+	void UpdateNPCs( double deltaSeconds, unsigned int firstActorIndex, unsigned int endActorIndex, ActorUpdateScratch& scratch );
+	Actor* CreateActor();
+	Area* CreateArea();
+	void AddRelationshipRule( const RelationshipRule& rule );
 	bool IsActorAtAllInsideArea( Actor& actor, Area& area );
 	void ForceActorOutsideOfArea( Actor& actor, Area& area );
-	void Render();
-	void RenderArea( Area& area, bool isShadowPass );
-	void RenderActor( Actor& actor, bool isShadowPass );
+	void CaptureSnapshot( OUTPUT SimulationSnapshot& snapshot ) const;
+	double CalcNumRelationshipsRun() const;
+	void Render( float interpolationFraction );
 	void WipeClean();
 	double GetSecondsInCurrentState() const;
 	float GetFractionOfSecondsInCurrentState( double benchmarkSeconds ) const;
@@ -217,6 +501,18 @@ public:
 };
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+enum SimulationUpdateMode
+{
+	SIMULATION_UPDATE_IN_PLACE,
+	SIMULATION_UPDATE_DOUBLE_BUFFERED,
+	SIMULATION_UPDATE_DOUBLE_BUFFERED_PARALLEL,
+	NUM_SIMULATION_UPDATE_MODES
+};
+
+bool FindSimulationUpdateModeByName( const std::string& modeName, OUTPUT SimulationUpdateMode& updateMode );
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 class TheGame
 {
@@ -231,22 +527,69 @@ public:
 	void DrawDebugGraphics();
 	void Update( double deltaSeconds );
 	bool IsRunning() const { return m_isRunning; }
+#if defined( JAZZ_PLATFORM_WIN32 )
 	bool HandleWin32Message( UINT wmMessageCode, WPARAM wParam, LPARAM lParam );
+#endif
 	bool ProcessKeyDownEvent( unsigned char keyCode );
 	bool ProcessKeyUpEvent( unsigned char keyCode );
-	bool IsKeyDown( unsigned char keyCode );
+	void SetSimulationKeyDown( unsigned char keyCode, bool isDown );
+	bool IsKeyDown( unsigned char keyCode ); // as the simulation sees it
 
 	void CreateScenarios();
 	void CreateScenario( const std::string& scenarioName, ScenarioStartFunctionPointer startFunction, ScenarioUpdateFunctionPointer updateFunction );
 	void LoadScenarioDataFiles();
 	void StartScenarioByName( const std::string& scenarioName );
 	void StartScenario( Scenario* scenarioToStart );
+	void SetSimulationUpdateMode( SimulationUpdateMode newMode );
+	void SetNumSimulationThreads( unsigned int numThreads );
+	void SetSimulationTickRate( double ticksPerSecond );
+	void SetMaxSimulationStepsPerFrame( int maxStepsPerFrame );
+	void SetSimulationThreaded( bool isThreaded );
+	bool IsSimulationThreaded() const { return m_simulationThread != NULL; }
+	double GetSimulationTickSeconds() const { return m_simulationTickSeconds; }
+	Scenario* GetCurrentScenario() const { return m_currentScenario; }
+	FramePacer& GetFramePacer() { return m_framePacer; }
+	const FrameStatistics& GetFrameStatistics() const { return m_frameStatistics; }
+
+private:
+	int StepSimulation( double deltaSeconds );
+	void RenderLatestSnapshot();
+	static void SimulationThreadEntry( void* game );
+	void RunSimulationLoop();
+	void ReportFrameStatistics();
+	void ExportProfilingTrace( const char* reason );
 
 private:
 	bool m_isRunning;
-	bool m_keyDownStates[ 256 ];
 	std::vector< Scenario* > m_scenarios;
 	Scenario* m_currentScenario;
+	SimulationUpdateMode m_simulationUpdateMode;
+	ThreadPool m_simulationThreadPool;
+	double m_simulationTickSeconds; // every Scenario::Update advances by exactly this much
+	double m_unsimulatedSeconds; // real time accumulated but not yet simulated (less than one tick after Update)
+	int m_maxSimulationStepsPerFrame; // after a hitch, time beyond this many ticks is dropped rather than caught up
+	bool m_keyDownStates[ 256 ]; // read by player actors as they update; input events change them under the lock
+
+	// Threaded simulation: the simulation thread steps the scenario and publishes snapshots, which
+	//	RunFrame draws.  Everything above is the simulation thread's while it runs, except under the lock.
+	ThreadHandle m_simulationThread;
+	volatile long m_isSimulationThreadStopping;
+	CriticalSection m_simulationLock; // held by the simulation thread while it steps; taken by main-thread changes to the simulation
+	bool m_isSnapshotStale; // set under the lock when the scenario restarts, so the next snapshot doesn't wait for a tick
+	SimulationSnapshotTripleBuffer m_snapshots;
+	SimulationSnapshotRenderer m_snapshotRenderer; // render thread only
+
+	FramePacer m_framePacer; // holds RunFrame's present to the target frame rate (F4 uncaps it)
+	unsigned int m_numProfilingTracesExported;
+	double m_timeLastProfilingTraceExported;
+
+	// Frame statistics: each frame's times are recorded at the start of the next (F7 shows the graph)
+	FrameStatistics m_frameStatistics;
+	bool m_isFrameStatisticsOverlayVisible;
+	bool m_hasFrameToRecord; // false until a whole frame has run
+	double m_simulationSecondsThisFrame;
+	double m_renderSecondsThisFrame;
+	volatile long m_simulationMicrosecondsSinceFrame; // added to by the simulation thread, taken by each threaded frame
 };
 
 
@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------------------------
+// ThreadPool.cpp
+//-----------------------------------------------------------------------------------------------
+#include "ThreadPool.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+class ThreadPoolWorkerInfo
+{
+public:
+	ThreadPool* m_threadPool;
+	unsigned int m_participantIndex;
+};
+
+
+//-----------------------------------------------------------------------------------------------
+ThreadPool::ThreadPool()
+	: m_isShuttingDown( 0 )
+	, m_jobFunction( NULL )
+	, m_jobUserData( NULL )
+	, m_jobNumItems( 0 )
+	, m_jobItemsPerBatch( 1 )
+	, m_jobNumBatches( 0 )
+	, m_jobNextBatchIndex( 0 )
+{
+}
+
+
+//-----------------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+	Shutdown();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ThreadPool::Startup( unsigned int numWorkerThreads )
+{
+	Shutdown();
+	m_isShuttingDown = 0;
+
+	for( unsigned int workerIndex = 0; workerIndex < numWorkerThreads; ++ workerIndex )
+	{
+		ThreadPoolWorkerInfo* workerInfo = new ThreadPoolWorkerInfo;
+		workerInfo->m_threadPool = this;
+		workerInfo->m_participantIndex = workerIndex + 1;
+		m_workerInfos.push_back( workerInfo );
+		m_workerThreads.push_back( SysCreateThread( WorkerThreadEntry, workerInfo ) );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ThreadPool::Shutdown()
+{
+	if( m_workerThreads.empty() )
+		return;
+
+	AtomicExchange( m_isShuttingDown, 1 );
+	m_jobAvailable.Release( GetNumWorkerThreads() );
+	for( unsigned int workerIndex = 0; workerIndex < m_workerThreads.size(); ++ workerIndex )
+	{
+		SysJoinThread( m_workerThreads[ workerIndex ] );
+		delete (ThreadPoolWorkerInfo*) m_workerInfos[ workerIndex ];
+	}
+
+	m_workerThreads.clear();
+	m_workerInfos.clear();
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Small jobs (a single batch, or no workers) run inline on the calling thread.
+//
+void ThreadPool::ParallelFor( unsigned int numItems, unsigned int itemsPerBatch, ParallelForFunction function, void* userData )
+{
+	if( numItems == 0 )
+		return;
+
+	if( itemsPerBatch == 0 )
+		itemsPerBatch = 1;
+
+	const unsigned int numBatches = (numItems + itemsPerBatch - 1) / itemsPerBatch;
+	if( numBatches == 1 || m_workerThreads.empty() )
+	{
+		function( userData, 0, numItems, 0 );
+		return;
+	}
+
+	m_jobFunction = function;
+	m_jobUserData = userData;
+	m_jobNumItems = numItems;
+	m_jobItemsPerBatch = itemsPerBatch;
+	m_jobNumBatches = (long) numBatches;
+	m_jobNextBatchIndex = 0;
+
+	// Releasing the semaphore publishes the job fields above to the workers
+	const unsigned int numWorkers = GetNumWorkerThreads();
+	m_jobAvailable.Release( numWorkers );
+	RunBatches( 0 );
+
+	for( unsigned int workerIndex = 0; workerIndex < numWorkers; ++ workerIndex )
+	{
+		m_jobFinished.Wait();
+	}
+
+	m_jobFunction = NULL;
+	m_jobUserData = NULL;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+STATIC void ThreadPool::WorkerThreadEntry( void* workerInfo )
+{
+	ThreadPoolWorkerInfo* info = (ThreadPoolWorkerInfo*) workerInfo;
+	info->m_threadPool->RunWorkerLoop( info->m_participantIndex );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void ThreadPool::RunWorkerLoop( unsigned int participantIndex )
+{
+	for( ;; )
+	{
+		m_jobAvailable.Wait();
+		if( m_isShuttingDown )
+			return;
+
+		RunBatches( participantIndex );
+		m_jobFinished.Release();
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Participants claim batches one at a time until none remain, so faster threads take more.
+//
+void ThreadPool::RunBatches( unsigned int participantIndex )
+{
+	for( ;; )
+	{
+		const long batchIndex = AtomicIncrement( m_jobNextBatchIndex ) - 1;
+		if( batchIndex >= m_jobNumBatches )
+			return;
+
+		const unsigned int beginIndex = (unsigned int) batchIndex * m_jobItemsPerBatch;
+		unsigned int endIndex = beginIndex + m_jobItemsPerBatch;
+		if( endIndex > m_jobNumItems )
+			endIndex = m_jobNumItems;
+
+		m_jobFunction( m_jobUserData, beginIndex, endIndex, participantIndex );
+	}
+}
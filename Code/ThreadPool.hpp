@@ -0,0 +1,58 @@
+//-----------------------------------------------------------------------------------------------
+// ThreadPool.hpp
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_ThreadPool__
+#define __include_ThreadPool__
+#pragma once
+#include "Threading.hpp"
+
+
+//-----------------------------------------------------------------------------------------------
+// Typedefs
+//
+// Runs items [beginIndex,endIndex); participantIndex is 0 for the calling thread and 1..N for
+//	worker threads, so callers can keep one set of scratch memory per participant.
+typedef void (*ParallelForFunction)( void* userData, unsigned int beginIndex, unsigned int endIndex, unsigned int participantIndex );
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// A fixed set of worker threads that split ParallelFor jobs into batches.  The calling thread
+//	joins in, and ParallelFor does not return until every batch has finished.  Only one job runs
+//	at a time, and only one thread may call ParallelFor.
+//
+class ThreadPool
+{
+public:
+	ThreadPool();
+	~ThreadPool();
+	void Startup( unsigned int numWorkerThreads );
+	void Shutdown();
+	unsigned int GetNumWorkerThreads() const { return (unsigned int) m_workerThreads.size(); }
+	unsigned int GetNumParticipants() const { return GetNumWorkerThreads() + 1; }
+	void ParallelFor( unsigned int numItems, unsigned int itemsPerBatch, ParallelForFunction function, void* userData );
+
+private:
+	ThreadPool( const ThreadPool& ); // not copyable
+	void operator = ( const ThreadPool& );
+	static void WorkerThreadEntry( void* workerInfo );
+	void RunWorkerLoop( unsigned int participantIndex );
+	void RunBatches( unsigned int participantIndex );
+
+private:
+	std::vector< ThreadHandle > m_workerThreads;
+	std::vector< void* > m_workerInfos;
+	Semaphore m_jobAvailable;
+	Semaphore m_jobFinished;
+	volatile long m_isShuttingDown;
+
+	// Current job; written only by the ParallelFor caller while the workers are idle
+	ParallelForFunction m_jobFunction;
+	void* m_jobUserData;
+	unsigned int m_jobNumItems;
+	unsigned int m_jobItemsPerBatch;
+	long m_jobNumBatches;
+	volatile long m_jobNextBatchIndex;
+};
+
+
+#endif // __include_ThreadPool__
@@ -0,0 +1,304 @@
+//-----------------------------------------------------------------------------------------------
+// Threading.cpp
+//-----------------------------------------------------------------------------------------------
+#include "Threading.hpp"
+
+#if !defined( JAZZ_PLATFORM_WIN32 )
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <errno.h>
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// Platform thread entry trampoline; carries the caller's function and argument to the new thread
+//
+class ThreadStartInfo
+{
+public:
+	ThreadEntryFunction m_entryFunction;
+	void* m_userData;
+};
+
+
+#if defined( JAZZ_PLATFORM_WIN32 )
+//-----------------------------------------------------------------------------------------------
+static DWORD WINAPI PlatformThreadEntry( LPVOID parameter )
+{
+	ThreadStartInfo* startInfo = (ThreadStartInfo*) parameter;
+	ThreadStartInfo localStartInfo = *startInfo;
+	delete startInfo;
+	localStartInfo.m_entryFunction( localStartInfo.m_userData );
+	return 0;
+}
+#else
+//-----------------------------------------------------------------------------------------------
+static void* PlatformThreadEntry( void* parameter )
+{
+	ThreadStartInfo* startInfo = (ThreadStartInfo*) parameter;
+	ThreadStartInfo localStartInfo = *startInfo;
+	delete startInfo;
+	localStartInfo.m_entryFunction( localStartInfo.m_userData );
+	return NULL;
+}
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+ThreadHandle SysCreateThread( ThreadEntryFunction entryFunction, void* userData )
+{
+	ThreadStartInfo* startInfo = new ThreadStartInfo;
+	startInfo->m_entryFunction = entryFunction;
+	startInfo->m_userData = userData;
+
+#if defined( JAZZ_PLATFORM_WIN32 )
+	HANDLE threadHandle = CreateThread( NULL, 0, PlatformThreadEntry, startInfo, 0, NULL );
+	return (ThreadHandle) threadHandle;
+#else
+	pthread_t* thread = new pthread_t;
+	pthread_create( thread, NULL, PlatformThreadEntry, startInfo );
+	return (ThreadHandle) thread;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SysJoinThread( ThreadHandle threadHandle )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	WaitForSingleObject( (HANDLE) threadHandle, INFINITE );
+	CloseHandle( (HANDLE) threadHandle );
+#else
+	pthread_t* thread = (pthread_t*) threadHandle;
+	pthread_join( *thread, NULL );
+	delete thread;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void SysSleepSeconds( double secondsToSleep )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	Sleep( (DWORD)( secondsToSleep * 1000.0 ) );
+#else
+	timespec sleepTime;
+	sleepTime.tv_sec = (time_t) secondsToSleep;
+	sleepTime.tv_nsec = (long)( (secondsToSleep - (double) sleepTime.tv_sec) * 1000000000.0 );
+	nanosleep( &sleepTime, NULL );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+unsigned int SysGetNumberOfHardwareThreads()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo( &systemInfo );
+	return (unsigned int) systemInfo.dwNumberOfProcessors;
+#else
+	long numProcessors = sysconf( _SC_NPROCESSORS_ONLN );
+	return numProcessors > 0 ? (unsigned int) numProcessors : 1;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Where SCHED_IDLE exists (Linux), the thread only runs when nothing else wants the core.
+//
+void SysLowerCurrentThreadPriority()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	SetThreadPriority( GetCurrentThread(), THREAD_PRIORITY_LOWEST );
+#elif defined( SCHED_IDLE )
+	sched_param schedulingParameters;
+	schedulingParameters.sched_priority = 0;
+	pthread_setschedparam( pthread_self(), SCHED_IDLE, &schedulingParameters );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+long AtomicIncrement( volatile long& value )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	return InterlockedIncrement( &value );
+#else
+	return __sync_add_and_fetch( &value, 1 );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+long AtomicDecrement( volatile long& value )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	return InterlockedDecrement( &value );
+#else
+	return __sync_sub_and_fetch( &value, 1 );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+long AtomicAdd( volatile long& value, long amountToAdd )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	return InterlockedExchangeAdd( &value, amountToAdd );
+#else
+	return __sync_fetch_and_add( &value, amountToAdd );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+long AtomicExchange( volatile long& value, long newValue )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	return InterlockedExchange( &value, newValue );
+#else
+	__sync_synchronize(); // __sync_lock_test_and_set is only an acquire barrier; InterlockedExchange is a full one
+	return __sync_lock_test_and_set( &value, newValue );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+long AtomicCompareAndSwap( volatile long& value, long comparand, long newValue )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	return InterlockedCompareExchange( &value, newValue, comparand );
+#else
+	return __sync_val_compare_and_swap( &value, comparand, newValue );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void MemoryBarrier_Full()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CriticalSection
+
+//-----------------------------------------------------------------------------------------------
+CriticalSection::CriticalSection()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	InitializeCriticalSection( &m_criticalSection );
+#else
+	pthread_mutex_init( &m_mutex, NULL );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+CriticalSection::~CriticalSection()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	DeleteCriticalSection( &m_criticalSection );
+#else
+	pthread_mutex_destroy( &m_mutex );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void CriticalSection::Enter()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	EnterCriticalSection( &m_criticalSection );
+#else
+	pthread_mutex_lock( &m_mutex );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void CriticalSection::Leave()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	LeaveCriticalSection( &m_criticalSection );
+#else
+	pthread_mutex_unlock( &m_mutex );
+#endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Semaphore
+
+//-----------------------------------------------------------------------------------------------
+Semaphore::Semaphore( unsigned int initialCount )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	m_semaphore = CreateSemaphore( NULL, (LONG) initialCount, 0x7fffffff, NULL );
+#else
+	sem_init( &m_semaphore, 0, initialCount );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+Semaphore::~Semaphore()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	CloseHandle( m_semaphore );
+#else
+	sem_destroy( &m_semaphore );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Semaphore::Release( unsigned int count )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	ReleaseSemaphore( m_semaphore, (LONG) count, NULL );
+#else
+	for( unsigned int i = 0; i < count; ++ i )
+	{
+		sem_post( &m_semaphore );
+	}
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Semaphore::Wait()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	WaitForSingleObject( m_semaphore, INFINITE );
+#else
+	while( sem_wait( &m_semaphore ) != 0 )
+	{
+		// Retry if interrupted by a signal
+	}
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+bool Semaphore::TryWait()
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	return WaitForSingleObject( m_semaphore, 0 ) == WAIT_OBJECT_0;
+#else
+	while( sem_trywait( &m_semaphore ) != 0 )
+	{
+		if( errno != EINTR )
+			return false;
+	}
+
+	return true;
+#endif
+}
@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------------------------
+// Threading.hpp
+//
+// Thin platform wrappers for threads, atomics and the two synchronization primitives we need.
+//-----------------------------------------------------------------------------------------------
+#ifndef __include_Threading__
+#define __include_Threading__
+#pragma once
+#include "Utilities.hpp"
+
+#if !defined( JAZZ_PLATFORM_WIN32 )
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// Definitions
+//
+#if defined( JAZZ_PLATFORM_WIN32 )
+	#define JAZZ_THREAD_LOCAL __declspec( thread )
+#else
+	#define JAZZ_THREAD_LOCAL __thread
+#endif
+
+typedef void (*ThreadEntryFunction)( void* userData );
+typedef void* ThreadHandle;
+
+
+//-----------------------------------------------------------------------------------------------
+// Thread and atomic utility functions
+//
+ThreadHandle SysCreateThread( ThreadEntryFunction entryFunction, void* userData );
+void SysJoinThread( ThreadHandle threadHandle );
+void SysSleepSeconds( double secondsToSleep );
+unsigned int SysGetNumberOfHardwareThreads();
+void SysLowerCurrentThreadPriority(); // for background work that should only use otherwise-idle cores
+long AtomicIncrement( volatile long& value );
+long AtomicDecrement( volatile long& value );
+long AtomicAdd( volatile long& value, long amountToAdd ); // returns the value from before the add
+long AtomicExchange( volatile long& value, long newValue ); // returns the value from before the exchange; a full barrier
+long AtomicCompareAndSwap( volatile long& value, long comparand, long newValue ); // returns the value from before the swap (if any)
+void MemoryBarrier_Full();
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	CriticalSection
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class CriticalSection
+{
+public:
+	CriticalSection();
+	~CriticalSection();
+	void Enter();
+	void Leave();
+
+private:
+	CriticalSection( const CriticalSection& ); // not copyable
+	void operator = ( const CriticalSection& );
+
+private:
+#if defined( JAZZ_PLATFORM_WIN32 )
+	CRITICAL_SECTION m_criticalSection;
+#else
+	pthread_mutex_t m_mutex;
+#endif
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Enters the critical section for the lifetime of this (stack) object
+//
+class ScopedCriticalSection
+{
+public:
+	ScopedCriticalSection( CriticalSection& criticalSection ) : m_criticalSection( criticalSection ) { m_criticalSection.Enter(); }
+	~ScopedCriticalSection() { m_criticalSection.Leave(); }
+
+private:
+	void operator = ( const ScopedCriticalSection& );
+	CriticalSection& m_criticalSection;
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//	Semaphore
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////
+class Semaphore
+{
+public:
+	explicit Semaphore( unsigned int initialCount = 0 );
+	~Semaphore();
+	void Release( unsigned int count = 1 );
+	void Wait();
+	bool TryWait(); // takes a count if one is available, without blocking
+
+private:
+	Semaphore( const Semaphore& ); // not copyable
+	void operator = ( const Semaphore& );
+
+private:
+#if defined( JAZZ_PLATFORM_WIN32 )
+	HANDLE m_semaphore;
+#else
+	sem_t m_semaphore;
+#endif
+};
+
+
+#endif // __include_Threading__
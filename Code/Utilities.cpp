@@ -10,6 +10,11 @@
 #include <sys/types.h>
 #include <errno.h>
 
+#if !defined( JAZZ_PLATFORM_WIN32 )
+	#include <stdio.h>
+	#define vsnprintf_s( buffer, bufferSize, maxCount, format, variableArgumentList ) vsnprintf( buffer, bufferSize, format, variableArgumentList )
+#endif
+
 
 //-----------------------------------------------------------------------------------------------
 void Sprintf( std::string& destination, const char* format, ... )
@@ -152,7 +157,11 @@ void DebuggerPrintf( const char* messageFormat, ... )
 	vsnprintf_s( messageLiteral, MESSAGE_MAX_LENGTH, _TRUNCATE, messageFormat, variableArgumentList );
 	va_end( variableArgumentList );
 	messageLiteral[ MESSAGE_MAX_LENGTH - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
+#if defined( JAZZ_PLATFORM_WIN32 )
 	OutputDebugStringA( messageLiteral );
+#else
+	fputs( messageLiteral, stderr );
+#endif
 }
 
 
@@ -162,7 +171,7 @@ void SysCreateFolder( const JazzPath& filePath )
 	const std::string newFolderPath = filePath;
 #if defined( JAZZ_PLATFORM_WIN32 )
 	CreateDirectoryA( newFolderPath.c_str(), NULL );
-#elif defined( JAZZ_PLATFORM_IOS )
+#elif defined( JAZZ_PLATFORM_IOS ) || defined( JAZZ_PLATFORM_POSIX )
 	errno = 0 ;
 	int returnCode = mkdir( newFolderPath.c_str(), 0777 );
 	if ( returnCode != 0 )
@@ -185,6 +194,9 @@ void SysDeleteFile( const JazzPath& filePath )
 #if defined( JAZZ_PLATFORM_WIN32 )
 	const std::string folderPathToDelete = filePath;
 	DeleteFileA( folderPathToDelete.c_str() );
+#elif defined( JAZZ_PLATFORM_POSIX )
+	const std::string folderPathToDelete = filePath;
+	remove( folderPathToDelete.c_str() );
 #else
 //	JAZZ_ERROR( "SysDeleteFile", Stringf( "This method is not yet implemented for the current platform (%s)", JAZZ_PLATFORM_NAME ) );
 #endif
@@ -235,6 +247,14 @@ int LoadBinaryFileToNewBuffer( const JazzPath& filePath, OUTPUT unsigned char*&
 		buffer = NULL ;
 		return -1 ;
 	}
+#elif defined( JAZZ_PLATFORM_POSIX )
+	const std::string filePathString = filePath;
+	file = fopen( filePathString.c_str(), "rb" );
+	if( !file )
+	{
+		buffer = NULL;
+		return -1;
+	}
 #else
 	const std::string filePathString = filePath;
 	const errno_t errorCode = fopen_s( &file, filePathString.c_str(), "rb" );
@@ -272,7 +292,7 @@ int WriteBufferToBinaryFile( const JazzPath& filePath, const unsigned char* sour
 
 	//	filePath.CreateFolder();
 
-#ifdef __APPLE__
+#if defined( __APPLE__ ) || defined( JAZZ_PLATFORM_POSIX )
 	file = fopen( filePathString.c_str(), "wb" );
 	if ( !file )
 	{
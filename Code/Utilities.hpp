@@ -93,14 +93,14 @@ inline int RandomIntInRangeInclusive( int lowestPossibleResult, int highestPossi
 //-----------------------------------------------------------------------------------------------
 inline float RandomNonNegativeFloatLessThanOne()
 {
-	return (float)rand() / (float)(RAND_MAX + 1);
+	return (float)rand() / ((float) RAND_MAX + 1.f);
 }
 
 
 //-----------------------------------------------------------------------------------------------
 inline float RandomFloatBetweenZeroAndOneInclusive()
 {
-	return (float)rand() / (float)(RAND_MAX + 1);
+	return (float)rand() / ((float) RAND_MAX + 1.f);
 }
 
 
@@ -112,31 +112,42 @@ inline float RandomFloatInRangeInclusive( float lowestPossibleResult, float high
 }
 
 
+//-----------------------------------------------------------------------------------------------
+inline int SysStricmp( const char* one, const char* two )
+{
+#if defined( JAZZ_PLATFORM_WIN32 )
+	return _stricmp( one, two );
+#else
+	return strcasecmp( one, two );
+#endif
+}
+
+
 //-----------------------------------------------------------------------------------------------
 inline int Stricmp( const std::string& one, const std::string& two )
 {
-	return _stricmp( one.c_str(), two.c_str() );
+	return SysStricmp( one.c_str(), two.c_str() );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 inline int Stricmp( const char* one, const std::string& two )
 {
-	return _stricmp( one, two.c_str() );
+	return SysStricmp( one, two.c_str() );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 inline int Stricmp( const std::string& one, const char* two )
 {
-	return _stricmp( one.c_str(), two );
+	return SysStricmp( one.c_str(), two );
 }
 
 
 //-----------------------------------------------------------------------------------------------
 inline int Stricmp( const char* one, const char* two )
 {
-	return _stricmp( one, two );
+	return SysStricmp( one, two );
 }
 
 
@@ -242,11 +253,13 @@ template<> inline void SetTypeFromString< unsigned int >( unsigned int& destinat
 }
 
 
+#if defined( JAZZ_PLATFORM_WIN32 ) // elsewhere, time_t is a typedef of long
 //-----------------------------------------------------------------------------------------------
 template<> inline void SetTypeFromString< time_t >( time_t& destination_out, const std::string& asString )
 {
 	destination_out = atol( asString.c_str() );
 }
+#endif
 
 
 //-----------------------------------------------------------------------------------------------